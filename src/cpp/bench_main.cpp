@@ -0,0 +1,25 @@
+#include "core/zobrist.hpp"
+#include "core/bitboard.hpp"
+#include "uci/bench.hpp"
+
+#include <iostream>
+#include <sstream>
+
+// HyperionBench [nodes] [leafeval]: the UCI "bench" command on its own
+int main(int argc, char* argv[]) {
+    hyperion::core::Zobrist::initialize_keys();
+    hyperion::core::initialize_attack_tables();
+
+    std::stringstream args;
+    for (int i = 1; i < argc; i++) args << argv[i] << ' ';
+
+    hyperion::uci::BenchConfig config;
+    std::string error;
+    if (!hyperion::uci::parse_bench_args(args, config, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    hyperion::uci::run_bench(config, [](const std::string& line) { std::cout << line << std::endl; });
+
+    return 0;
+}
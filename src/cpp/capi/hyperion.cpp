@@ -0,0 +1,273 @@
+#include "hyperion.h"
+
+#include "core/bitboard.hpp"
+#include "core/movegen.hpp"
+#include "core/zobrist.hpp"
+#include "search/search.hpp"
+#include "uci/engine.hpp"
+#include "uci/uci.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hyperion;
+
+//--
+/* struct hyperion_engine */
+//--
+// The C handle is a uci::Engine plus what the C side needs around it. The engine is declared last, so its search
+// job is done before the output callback it writes to goes away
+struct hyperion_engine {
+    std::mutex output_mutex;
+    hyperion_output_fn output_fn = nullptr;
+    void* user_data = nullptr;
+    mutable std::string last_error; // the const calls can fail too
+    uci::Engine engine;
+
+    hyperion_engine() : engine([this](const std::string& line) { write(line); }) {}
+
+    void write(const std::string& line) {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        if (output_fn) output_fn(line.c_str(), user_data);
+    }
+
+    int fail(int status, const std::string& error) const noexcept {
+        try {
+            last_error = error;
+        } catch (...) {
+            last_error.clear(); // out of memory: the status has to do
+        }
+        return status;
+    }
+};
+
+// Runs the body of an entry point. No exception may cross the C ABI: one from the engine (std::bad_alloc, a
+// std::length_error from a broken weight file, ...) becomes HYPERION_ERROR_INTERNAL
+template <typename Body>
+static int guarded(const hyperion_engine* engine, Body body) {
+    try {
+        return body();
+    } catch (const std::exception& e) {
+        return engine->fail(HYPERION_ERROR_INTERNAL, e.what());
+    } catch (...) {
+        return engine->fail(HYPERION_ERROR_INTERNAL, "unknown error");
+    }
+}
+
+// Copies a string into a fixed size C buffer, always NUL terminated
+static void copy_string(const std::string& text, char* buffer, size_t size) {
+    if (size == 0) return;
+    const size_t length = std::min(text.size(), size - 1);
+    std::memcpy(buffer, text.data(), length);
+    buffer[length] = '\0';
+}
+
+static hyperion_move to_c_move(const core::Move& move) {
+    hyperion_move c_move{};
+    if (move.from_sq != core::square_e::NO_SQ) copy_string(core::move_to_uci_string(move), c_move.uci, sizeof(c_move.uci));
+    return c_move;
+}
+
+static int mate_moves(const engine::RootMove& move) {
+    if (move.proof == engine::Proof::Win) return (move.mate_plies + 1) / 2;
+    if (move.proof == engine::Proof::Loss) return -(move.mate_plies + 1) / 2;
+    return 0;
+}
+
+// Position::set_from_fen trusts its input, so the board part and the side to move are checked first: eight ranks
+// of eight squares, known pieces, one king each
+static bool valid_fen(const std::string& fen) {
+    std::istringstream stream(fen);
+    std::string board, side;
+    if (!(stream >> board >> side) || (side != "w" && side != "b")) return false;
+
+    int ranks = 1, files = 0, white_kings = 0, black_kings = 0;
+    for (char c : board) {
+        if (c == '/') {
+            if (files != 8) return false;
+            ranks++;
+            files = 0;
+        } else if (c >= '1' && c <= '8') {
+            files += c - '0';
+        } else if (std::strchr("pnbrqkPNBRQK", c)) {
+            files++;
+            white_kings += c == 'K';
+            black_kings += c == 'k';
+        } else {
+            return false;
+        }
+        if (files > 8) return false;
+    }
+    return ranks == 8 && files == 8 && white_kings == 1 && black_kings == 1;
+}
+
+extern "C" {
+
+int hyperion_api_version(void) {
+    return HYPERION_API_VERSION;
+}
+
+//--
+/* hyperion_create / hyperion_destroy */
+//--
+// The attack tables and Zobrist keys are global, they are set up by the first engine. In-process there is no GUI
+// or connection to lose time to, so the Move Overhead starts at 0
+hyperion_engine* hyperion_create(void) {
+    try {
+        static std::once_flag tables_ready;
+        std::call_once(tables_ready, [] {
+            core::Zobrist::initialize_keys();
+            core::initialize_attack_tables();
+        });
+        hyperion_engine* handle = new hyperion_engine();
+        handle->engine.set_option("Move Overhead", "0");
+        return handle;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void hyperion_destroy(hyperion_engine* engine) {
+    delete engine;
+}
+
+const char* hyperion_last_error(const hyperion_engine* engine) {
+    return engine ? engine->last_error.c_str() : "no engine";
+}
+
+//--
+/* hyperion_set_option / hyperion_set_output */
+//--
+int hyperion_set_option(hyperion_engine* engine, const char* name, const char* value) {
+    if (!engine || !name || !value) return HYPERION_ERROR_INVALID_ARGUMENT;
+    return guarded(engine, [&] {
+        if (!engine->engine.set_option(name, value)) {
+            return engine->fail(HYPERION_ERROR_INVALID_OPTION, std::string("invalid option ") + name + " = " + value);
+        }
+        engine->last_error.clear();
+        return HYPERION_OK;
+    });
+}
+
+void hyperion_set_output(hyperion_engine* engine, hyperion_output_fn fn, void* user_data) {
+    if (!engine) return;
+    std::lock_guard<std::mutex> lock(engine->output_mutex);
+    engine->output_fn = fn;
+    engine->user_data = user_data;
+}
+
+//--
+/* hyperion_set_position / hyperion_get_fen */
+//--
+int hyperion_set_position(hyperion_engine* engine, const char* fen, const char* moves) {
+    if (!engine) return HYPERION_ERROR_INVALID_ARGUMENT;
+    return guarded(engine, [&] {
+        core::Position pos;
+        if (fen && std::strcmp(fen, "startpos") != 0) {
+            if (!valid_fen(fen)) return engine->fail(HYPERION_ERROR_INVALID_FEN, std::string("invalid FEN ") + fen);
+            pos.set_from_fen(fen);
+        }
+
+        std::istringstream move_stream(moves ? moves : "");
+        std::string token;
+        while (move_stream >> token) {
+            core::Move move;
+            if (!uci::parse_uci_move(pos, token, move)) {
+                return engine->fail(HYPERION_ERROR_ILLEGAL_MOVE, "illegal move " + token + " in " + pos.to_fen());
+            }
+            pos.make_move(move);
+        }
+        engine->engine.set_position(pos);
+        engine->last_error.clear();
+        return HYPERION_OK;
+    });
+}
+
+int hyperion_get_fen(const hyperion_engine* engine, char* buffer, size_t size) {
+    if (!engine || !buffer) return HYPERION_ERROR_INVALID_ARGUMENT;
+    return guarded(engine, [&] {
+        copy_string(engine->engine.get_position().to_fen(), buffer, size);
+        return HYPERION_OK;
+    });
+}
+
+//--
+/* hyperion_search / hyperion_stop */
+//--
+int hyperion_search(hyperion_engine* engine, const hyperion_limits* limits, hyperion_result* result) {
+    if (!engine || !limits) return HYPERION_ERROR_INVALID_ARGUMENT;
+    if (limits->nodes <= 0 && limits->movetime_ms <= 0 && limits->depth <= 0 && limits->mate <= 0) {
+        return engine->fail(HYPERION_ERROR_INVALID_ARGUMENT, "a search needs at least one limit");
+    }
+    return guarded(engine, [&] {
+        uci::SearchRequest request;
+        request.limits.nodes = limits->nodes > 0 ? limits->nodes : 0;
+        request.limits.depth = limits->depth > 0 ? limits->depth : 0;
+        request.limits.mate = limits->mate > 0 ? limits->mate : 0;
+        if (limits->movetime_ms > 0) request.clock.move_time_ms = limits->movetime_ms;
+        engine->engine.go(request);
+        engine->engine.wait();
+
+        if (result) {
+            const engine::Search& search = engine->engine.get_search();
+            const std::vector<engine::RootMove> moves = search.get_root_moves(1);
+            *result = hyperion_result{};
+            result->nodes = search.get_iterations();
+            result->max_depth = search.get_max_depth();
+            if (!moves.empty()) {
+                result->best_move = to_c_move(moves[0].move);
+                result->ponder_move = to_c_move(search.get_ponder_move(moves[0].move));
+                result->score_cp = engine::q_to_centipawns(moves[0].q);
+                result->mate = mate_moves(moves[0]);
+            }
+        }
+        engine->last_error.clear();
+        return HYPERION_OK;
+    });
+}
+
+void hyperion_stop(hyperion_engine* engine) {
+    if (!engine) return;
+    guarded(engine, [&] {
+        engine->engine.stop();
+        return HYPERION_OK;
+    });
+}
+
+//--
+/* hyperion_root_moves / hyperion_legal_moves */
+//--
+int hyperion_root_moves(const hyperion_engine* engine, hyperion_root_move* moves, int capacity) {
+    if (!engine || (!moves && capacity > 0)) return HYPERION_ERROR_INVALID_ARGUMENT;
+    return guarded(engine, [&] {
+        const std::vector<engine::RootMove> root_moves = engine->engine.get_search().get_root_moves();
+        for (int i = 0; i < capacity && i < static_cast<int>(root_moves.size()); ++i) {
+            const engine::RootMove& move = root_moves[i];
+            moves[i].move = to_c_move(move.move);
+            moves[i].visits = move.visits;
+            moves[i].q = move.q;
+            moves[i].prior = move.prior;
+            moves[i].score_cp = engine::q_to_centipawns(move.q);
+            moves[i].mate = mate_moves(move);
+        }
+        return static_cast<int>(root_moves.size());
+    });
+}
+
+int hyperion_legal_moves(const hyperion_engine* engine, hyperion_move* moves, int capacity) {
+    if (!engine || (!moves && capacity > 0)) return HYPERION_ERROR_INVALID_ARGUMENT;
+    return guarded(engine, [&] {
+        core::MoveGenerator move_gen;
+        std::vector<core::Move> legal_moves;
+        move_gen.generate_legal_moves(engine->engine.get_position(), legal_moves);
+        for (int i = 0; i < capacity && i < static_cast<int>(legal_moves.size()); ++i) moves[i] = to_c_move(legal_moves[i]);
+        return static_cast<int>(legal_moves.size());
+    });
+}
+
+} // extern "C"
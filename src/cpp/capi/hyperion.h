@@ -0,0 +1,120 @@
+#ifndef HYPERION_CAPI_HYPERION_H
+#define HYPERION_CAPI_HYPERION_H
+
+/*
+---
+* libhyperion: the engine in-process, behind a C ABI that stays the same between releases
+* Only plain C types cross it: opaque handles, fixed size structs, NUL terminated strings. New functions may be
+  added, existing ones and the structs keep their layout (HYPERION_API_VERSION changes if they ever have to)
+
+* Build target: hyperion (libhyperion.so / hyperion.dll)
+* From Python:
+    *lib = ctypes.CDLL("./lib/libhyperion.so")*
+    *lib.hyperion_create.restype = ctypes.c_void_p*
+    *engine = lib.hyperion_create()*
+---
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(HYPERION_BUILDING_LIBRARY)
+#    define HYPERION_API __declspec(dllexport)
+#  else
+#    define HYPERION_API __declspec(dllimport)
+#  endif
+#else
+#  define HYPERION_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HYPERION_API_VERSION 1
+
+/* Status codes, every function that can fail returns one. hyperion_last_error says more */
+#define HYPERION_OK 0
+#define HYPERION_ERROR_INVALID_ARGUMENT (-1)
+#define HYPERION_ERROR_INVALID_FEN (-2)
+#define HYPERION_ERROR_ILLEGAL_MOVE (-3)
+#define HYPERION_ERROR_INVALID_OPTION (-4)
+#define HYPERION_ERROR_INTERNAL (-5) /* the engine failed (out of memory, ...), the engine may be destroyed */
+
+/* A move in UCI notation ("e2e4", "e7e8q"), NUL terminated */
+typedef struct hyperion_move {
+    char uci[8];
+} hyperion_move;
+
+/* When a search ends, 0 = no limit. Without any limit the search would never end, so at least one is needed
+   A mate search ends once the mate is found, on its own it gets 2 seconds per move of the mate */
+typedef struct hyperion_limits {
+    int64_t nodes;    /* simulations */
+    int32_t movetime_ms;
+    int32_t depth;    /* tree depth */
+    int32_t mate;     /* mate in this many moves */
+} hyperion_limits;
+
+/* One root move after a search, the best first */
+typedef struct hyperion_root_move {
+    hyperion_move move;
+    int32_t visits;
+    double q;         /* average result for the side to move, in [-1, 1] */
+    float prior;      /* the policy's probability (PUCT only, else 0) */
+    int32_t score_cp; /* q in centipawns */
+    int32_t mate;     /* > 0: mates in this many moves, < 0: gets mated, 0: not proven */
+} hyperion_root_move;
+
+/* What a search returns */
+typedef struct hyperion_result {
+    hyperion_move best_move;   /* empty when the position has no legal moves */
+    hyperion_move ponder_move; /* the expected reply, may be empty */
+    int64_t nodes;
+    int32_t max_depth;
+    int32_t score_cp;
+    int32_t mate;              /* like hyperion_root_move::mate */
+} hyperion_result;
+
+typedef struct hyperion_engine hyperion_engine;
+
+/* Called with every info line of a search (without the newline), from the search's thread */
+typedef void (*hyperion_output_fn)(const char* line, void* user_data);
+
+HYPERION_API int hyperion_api_version(void);
+
+/* An engine at the start position with the default options. Each one has its own search tree and thread */
+HYPERION_API hyperion_engine* hyperion_create(void);
+HYPERION_API void hyperion_destroy(hyperion_engine* engine);
+
+/* The reason for the last error of this engine, "" if there was none. Valid until the next call */
+HYPERION_API const char* hyperion_last_error(const hyperion_engine* engine);
+
+/* The UCI options (LeafEval, Threads, Hash, Seed, ...), see HyperionEngine's "uci" reply */
+HYPERION_API int hyperion_set_option(hyperion_engine* engine, const char* name, const char* value);
+/* Info lines are dropped unless a callback is set, NULL drops them again */
+HYPERION_API void hyperion_set_output(hyperion_engine* engine, hyperion_output_fn fn, void* user_data);
+
+/* fen: NULL or "startpos" for the start position. moves: NULL or UCI moves separated by spaces
+   On an error the position is left as it was */
+HYPERION_API int hyperion_set_position(hyperion_engine* engine, const char* fen, const char* moves);
+/* The current position as a FEN, written to buffer (NUL terminated, cut to size) */
+HYPERION_API int hyperion_get_fen(const hyperion_engine* engine, char* buffer, size_t size);
+
+/* Searches the current position, blocking until a limit is reached. result may be NULL */
+HYPERION_API int hyperion_search(hyperion_engine* engine, const hyperion_limits* limits, hyperion_result* result);
+/* Ends a running hyperion_search early, from another thread */
+HYPERION_API void hyperion_stop(hyperion_engine* engine);
+
+/* The last search's root moves, best first. Writes up to capacity of them, returns how many there are (or an
+   error status) */
+HYPERION_API int hyperion_root_moves(const hyperion_engine* engine, hyperion_root_move* moves, int capacity);
+/* The legal moves of the current position. Writes up to capacity of them, returns how many there are (or an
+   error status) */
+HYPERION_API int hyperion_legal_moves(const hyperion_engine* engine, hyperion_move* moves, int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HYPERION_CAPI_HYPERION_H */
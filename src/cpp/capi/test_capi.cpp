@@ -0,0 +1,109 @@
+// hyperion/src/cpp/capi/test_capi.cpp
+#include "hyperion.h"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+---
+* Checks libhyperion through its C ABI: positions from FEN and moves, errors for bad input, a node limited
+  search with its result and root moves, the legal moves and the output callback
+
+* Build target: TestCAPI
+* Run it:
+    *./bin/TestCAPI*
+---
+*/
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+static void count_lines(const char* line, void* user_data) {
+    if (std::strncmp(line, "info depth", 10) == 0) ++*static_cast<int*>(user_data);
+}
+
+void test_position() {
+    std::cout << "Running test_position..." << std::endl;
+    hyperion_engine* engine = hyperion_create();
+    check(engine != nullptr, "the engine should be created");
+
+    hyperion_move moves[256];
+    check(hyperion_legal_moves(engine, moves, 256) == 20, "the start position has 20 moves");
+    check(hyperion_set_position(engine, "startpos", "e2e4 e7e5 g1f3") == HYPERION_OK, "moves from the start position");
+    char fen[128];
+    hyperion_get_fen(engine, fen, sizeof(fen));
+    check(std::string(fen).rfind("rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b", 0) == 0, "the moves should be played");
+
+    check(hyperion_set_position(engine, nullptr, "e2e4 e2e4") == HYPERION_ERROR_ILLEGAL_MOVE, "an illegal move is an error");
+    check(std::strlen(hyperion_last_error(engine)) > 0, "the error should be explained");
+    hyperion_get_fen(engine, fen, sizeof(fen));
+    check(std::string(fen).rfind("rnbqkbnr/pppp1ppp/8/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R b", 0) == 0,
+          "a failed set_position should keep the position");
+    check(hyperion_set_position(engine, "8/8/8/8/8/8/8/8 w - - 0 1", nullptr) == HYPERION_ERROR_INVALID_FEN,
+          "a board without kings is not a position");
+    check(hyperion_set_option(engine, "NoSuchOption", "1") == HYPERION_ERROR_INVALID_OPTION, "unknown options are errors");
+
+    check(hyperion_set_position(engine, "4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q") == HYPERION_OK, "promotions");
+    check(hyperion_legal_moves(engine, nullptr, 0) > 0, "the legal moves can be counted without a buffer");
+    hyperion_destroy(engine);
+}
+
+void test_search() {
+    std::cout << "Running test_search..." << std::endl;
+    hyperion_engine* engine = hyperion_create();
+    int info_lines = 0;
+    hyperion_set_output(engine, count_lines, &info_lines);
+    check(hyperion_set_option(engine, "LeafEval", "StaticEval") == HYPERION_OK, "options can be set");
+    check(hyperion_set_option(engine, "Seed", "5") == HYPERION_OK, "the seed can be set");
+
+    hyperion_limits no_limits = {};
+    check(hyperion_search(engine, &no_limits, nullptr) == HYPERION_ERROR_INVALID_ARGUMENT, "a search needs a limit");
+
+    hyperion_limits limits = {};
+    limits.nodes = 800;
+    hyperion_result result;
+    check(hyperion_search(engine, &limits, &result) == HYPERION_OK, "the search should run");
+    check(result.nodes == 800, "the node limit should be kept");
+    check(std::strlen(result.best_move.uci) == 4, "the search should find a move");
+    check(info_lines > 0, "the info lines should reach the callback");
+
+    std::vector<hyperion_root_move> root(64);
+    const int count = hyperion_root_moves(engine, root.data(), static_cast<int>(root.size()));
+    check(count == 20, "every root move should be listed");
+    check(std::strcmp(root[0].move.uci, result.best_move.uci) == 0, "the first root move is the best move");
+    check(root[0].visits >= root[1].visits, "the root moves should be ranked");
+
+    check(hyperion_set_position(engine, "7k/8/8/8/8/8/R7/1R5K w - - 0 1", nullptr) == HYPERION_OK, "mate position");
+    limits = hyperion_limits{};
+    limits.mate = 2;
+    hyperion_search(engine, &limits, &result);
+    check(result.mate == 2, "the mate in 2 should be reported");
+
+    // a mate search on its own still ends where there is no mate
+    check(hyperion_set_position(engine, "startpos", nullptr) == HYPERION_OK, "back to the start position");
+    limits.mate = 1;
+    check(hyperion_search(engine, &limits, &result) == HYPERION_OK && result.mate == 0 &&
+          std::strlen(result.best_move.uci) == 4, "a mate search without a mate should end with a move");
+    hyperion_destroy(engine);
+}
+
+int main() {
+    check(hyperion_api_version() == HYPERION_API_VERSION, "the library and the header should agree");
+    test_position();
+    test_search();
+
+    if (failures == 0) {
+        std::cout << "All C API tests passed." << std::endl;
+        return 0;
+    }
+    std::cout << failures << " C API test(s) failed." << std::endl;
+    return 1;
+}
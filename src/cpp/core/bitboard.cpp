@@ -165,6 +165,26 @@ std::string square_to_algebraic(int square_index) {
     return s;
 }
 
+//--
+/* move_to_uci_string */
+//--
+// The squares, then the promotion piece in lower case. The null move (no from square) is "0000", as UCI writes it
+std::string move_to_uci_string(const Move& move) {
+    if (move.from_sq == square_e::NO_SQ) return "0000";
+    std::string uci_move = square_to_algebraic(static_cast<int>(move.from_sq)) +
+                           square_to_algebraic(static_cast<int>(move.to_sq));
+    if (move.is_promotion()) {
+        switch (move.get_promotion_piece()) {
+            case P_QUEEN:  uci_move += 'q'; break;
+            case P_ROOK:   uci_move += 'r'; break;
+            case P_BISHOP: uci_move += 'b'; break;
+            case P_KNIGHT: uci_move += 'n'; break;
+            default: break;
+        }
+    }
+    return uci_move;
+}
+
 // --- attacks ---
 
 // Define the actual storage for the extern declared arrays
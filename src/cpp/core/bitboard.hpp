@@ -3,6 +3,7 @@
 #define HYPERION_CORE_BITBOARD_HPP
 
 #include "constants.hpp" 
+#include "move.hpp"
 
 #include <cstdint> 
 #include <string>   
@@ -63,6 +64,8 @@ std::string square_to_algebraic(int square_index);
 inline std::string square_to_algebraic(square_e sq) { 
     return (sq != square_e::NO_SQ) ? square_to_algebraic(static_cast<int>(sq)) : "NO_SQ";
 }
+// A move in UCI notation ("e2e4", "e7e8q"), "0000" for the null move
+std::string move_to_uci_string(const Move& move);
 
 inline bitboard_t square_to_bitboard(square_e sq) {
     if (sq == square_e::NO_SQ) return EMPTY_BB;
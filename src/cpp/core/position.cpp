@@ -131,6 +131,8 @@ void Position::clear_board_state() {
     halfmove_clock = 0;
     fullmove_number = 1;
     current_hash = 0ULL;
+    pawn_hash = 0ULL;
+    material_key = 0ULL;
     history_stack.clear();
      history_stack.reserve(256);
 }
@@ -179,21 +181,23 @@ void Position::update_derived_bitboards_and_mailbox() {
 // XORs the key for the side to move if it's black's turn.
 // XORs the key for the current castling rights state.
 // XORs the key for the en passant file if an en passant square is set.
+// The pawn hash (the pawn keys alone) and the material key (the piece counts) are computed in the same pass.
 
 void Position::compute_initial_hash() {
     current_hash = 0ULL;
+    pawn_hash = 0ULL;
+    material_key = 0ULL;
 
     // 1. Pieces on board
     for (int p_type_idx = 0; p_type_idx < NUM_PIECE_TYPES; ++p_type_idx) {
-        bitboard_t bb_w = piece_bbs[p_type_idx][WHITE];
-        while (bb_w) {
-            int sq_idx = pop_lsb(bb_w);
-            current_hash ^= Zobrist::piece_square_keys[p_type_idx][WHITE][sq_idx];
-        }
-        bitboard_t bb_b = piece_bbs[p_type_idx][BLACK];
-        while (bb_b) {
-            int sq_idx = pop_lsb(bb_b);
-            current_hash ^= Zobrist::piece_square_keys[p_type_idx][BLACK][sq_idx];
+        for (int color = WHITE; color <= BLACK; ++color) {
+            bitboard_t bb = piece_bbs[p_type_idx][color];
+            material_key += count_set_bits(bb) * material_key_unit(p_type_idx, color);
+            while (bb) {
+                int sq_idx = pop_lsb(bb);
+                current_hash ^= Zobrist::piece_square_keys[p_type_idx][color][sq_idx];
+                if (p_type_idx == P_PAWN) pawn_hash ^= Zobrist::piece_square_keys[p_type_idx][color][sq_idx];
+            }
         }
     }
 
@@ -404,7 +408,7 @@ int Position::get_piece_on_square(square_e sq) const {
 // Updates all relevant board state: piece bitboards, mailbox, Zobrist hash, side to move, castling rights, en passant square, halfmove clock, and fullmove number.
 // Saves the previous state information (castling rights, EP square, halfmove clock, hash, captured piece type) onto the history_stack for unmake_move.
 // Handles normal moves, captures (including en passant), promotions, and castling.
-// Updates Zobrist hash incrementally based on changes.
+// Updates Zobrist hash, pawn hash and material key incrementally based on changes.
 // Updates derived bitboards (color_bbs, occupied_bb) at the end.
 
 void Position::make_move(const Move& m) {
@@ -414,6 +418,8 @@ void Position::make_move(const Move& m) {
     prev_state.en_passant_square = this->en_passant_square;
     prev_state.halfmove_clock = this->halfmove_clock;
     prev_state.hash = this->current_hash;
+    prev_state.pawn_hash = this->pawn_hash;
+    prev_state.material_key = this->material_key;
     prev_state.captured_piece_type = m.piece_captured;
     history_stack.push_back(prev_state);
 
@@ -440,6 +446,7 @@ void Position::make_move(const Move& m) {
     clear_bit(color_bbs[mover_color], from_sq);
     clear_bit(occupied_bb, from_sq); // from_sq is now empty
     current_hash ^= Zobrist::piece_square_keys[moved_piece_idx][mover_color][from_sq_idx];
+    if (moved_piece_type == P_PAWN) pawn_hash ^= Zobrist::piece_square_keys[moved_piece_idx][mover_color][from_sq_idx];
     board_mailbox[from_sq_idx] = EMPTY_MAILBOX_VAL;
 
     // B. Handle capture
@@ -464,6 +471,8 @@ void Position::make_move(const Move& m) {
         clear_bit(color_bbs[opponent_color], actual_capture_sq);
         clear_bit(occupied_bb, actual_capture_sq); // This square becomes empty
         current_hash ^= Zobrist::piece_square_keys[captured_type_idx][opponent_color][actual_capture_sq_idx];
+        if (captured_type == P_PAWN) pawn_hash ^= Zobrist::piece_square_keys[captured_type_idx][opponent_color][actual_capture_sq_idx];
+        material_key -= material_key_unit(captured_type_idx, opponent_color);
         board_mailbox[actual_capture_sq_idx] = EMPTY_MAILBOX_VAL; // Only if actual_capture_sq is different from to_sq (EP)
                                                                // If normal capture, to_sq mailbox will be overwritten by landing piece.
                                                                // For EP, mailbox on actual_capture_sq must be cleared.
@@ -478,6 +487,7 @@ void Position::make_move(const Move& m) {
     if (m.is_promotion()) {
         piece_to_place = m.get_promotion_piece();
         this->halfmove_clock = 0;
+        material_key += material_key_unit(piece_to_place, mover_color) - material_key_unit(P_PAWN, mover_color);
     }
     int piece_to_place_idx = static_cast<int>(piece_to_place);
 
@@ -485,6 +495,7 @@ void Position::make_move(const Move& m) {
     set_bit(color_bbs[mover_color], to_sq);
     set_bit(occupied_bb, to_sq); // to_sq is now occupied by the moved/promoted piece
     current_hash ^= Zobrist::piece_square_keys[piece_to_place_idx][mover_color][to_sq_idx];
+    if (piece_to_place == P_PAWN) pawn_hash ^= Zobrist::piece_square_keys[piece_to_place_idx][mover_color][to_sq_idx];
     board_mailbox[to_sq_idx] = make_mailbox_entry(piece_to_place, mover_color);
 
     // D. Handle castling (moving the rook)
@@ -691,8 +702,10 @@ void Position::unmake_move(const Move& m) {
         board_mailbox[rook_original_sq_idx] = make_mailbox_entry(P_ROOK, mover_color);
     }
 
-    // F. Restore Zobrist hash
+    // F. Restore Zobrist hash, pawn hash and material key
     this->current_hash = prev_state.hash;
+    this->pawn_hash = prev_state.pawn_hash;
+    this->material_key = prev_state.material_key;
 }
 
 //--
@@ -837,6 +850,44 @@ bool Position::is_king_in_check(int king_color_to_check) const {
     return is_square_attacked(k_sq, (king_color_to_check == WHITE) ? BLACK : WHITE);
 }
 
+//--
+/* Position::is_repetition */
+//--
+// history_stack holds the hash before every move, so the position k plies ago is history_stack[size - k]
+// Only positions with the same side to move can match (every other entry, starting 4 plies back), and nothing
+// from before the last capture or pawn move (halfmove_clock plies back) can come back
+bool Position::is_repetition() const {
+    const int size = static_cast<int>(history_stack.size());
+    const int reversible_plies = std::min(halfmove_clock, size);
+    for (int k = 4; k <= reversible_plies; k += 2) {
+        if (history_stack[size - k].hash == current_hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//--
+/* Position::is_insufficient_material */
+//--
+// K vs K, K+N vs K, K+B vs K, and any number of bishops that all stand on the same colour squares
+// Mostly answered from the material key, only several bishops need the bitboards
+bool Position::is_insufficient_material() const {
+    constexpr material_key_t HEAVY_MASK = (0xFULL * material_key_unit(P_PAWN, WHITE)) | (0xFULL * material_key_unit(P_PAWN, BLACK)) |
+                                          (0xFULL * material_key_unit(P_ROOK, WHITE)) | (0xFULL * material_key_unit(P_ROOK, BLACK)) |
+                                          (0xFULL * material_key_unit(P_QUEEN, WHITE)) | (0xFULL * material_key_unit(P_QUEEN, BLACK));
+    if (material_key & HEAVY_MASK) {
+        return false;
+    }
+    const int knights = get_piece_count(P_KNIGHT, WHITE) + get_piece_count(P_KNIGHT, BLACK);
+    const int minors = knights + get_piece_count(P_BISHOP, WHITE) + get_piece_count(P_BISHOP, BLACK);
+    if (minors <= 1) {
+        return true;
+    }
+    const bitboard_t bishops = get_pieces_by_type(P_BISHOP);
+    constexpr bitboard_t DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+    return knights == 0 && ((bishops & DARK_SQUARES) == 0 || (bishops & ~DARK_SQUARES) == 0);
+}
 
 } // namespace core
 } // namespace hyperion
\ No newline at end of file
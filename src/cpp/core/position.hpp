@@ -13,6 +13,12 @@ namespace core {
 
 struct Move;
 
+// Material key: how many pieces of each type and color are on the board, 4 bits per (piece type, color)
+// Two positions have the same key exactly when they have the same material
+using material_key_t = uint64_t;
+constexpr int material_key_shift(int p_type, int p_color) { return 4 * (p_type * 2 + p_color); }
+constexpr material_key_t material_key_unit(int p_type, int p_color) { return 1ULL << material_key_shift(p_type, p_color); }
+
 class Position {
 public:
     // --- Bitboards ---
@@ -32,6 +38,8 @@ public:
     int fullmove_number;       // Incremented after Black's move
 
     zobrist_key_t current_hash; // Current position's Zobrist hash
+    zobrist_key_t pawn_hash;    // Zobrist hash of the pawns alone (both colors), the key for pawn structure caches
+    material_key_t material_key; // Piece counts, see material_key_t
 
     // A "mailbox" representation: board[square_index] = piece_char or piece_enum
     std::array<int, NUM_SQUARES> board_mailbox; // Stores combined piece type and color, or EMPTY_SQUARE
@@ -48,6 +56,9 @@ public:
     bitboard_t get_pieces_by_color(int p_color) const;
     bitboard_t get_occupied_squares() const;
     square_e get_king_square(int king_color) const;
+    int get_piece_count(piece_type_e p_type, int p_color) const {
+        return static_cast<int>((material_key >> material_key_shift(p_type, p_color)) & 0xF);
+    }
 
     //mailbox mutators
     int make_mailbox_entry(piece_type_e type, int color) const;
@@ -70,19 +81,28 @@ public:
     // Checks if the king of the specified color is in check
     bool is_king_in_check(int king_color_to_check) const;
 
+    // --- Draw Checks ---
+    // True if the current position already occurred since the last capture or pawn move (a twofold repetition,
+    // which the search treats as a draw). Only looks back halfmove_clock plies of history_stack
+    bool is_repetition() const;
+    // True if neither side can possibly checkmate: bare kings, a single minor piece, or only bishops on one colour
+    bool is_insufficient_material() const;
+
     // Generates a bitboard of all pieces of 'attacker_color' attacking 'sq'
     // bitboard_t attackers_to(square_e sq, int attacker_color) const; 
 
 private:
     void clear_board_state();
     void update_derived_bitboards_and_mailbox(); // From piece_bbs to color_bbs, occupied_bb, board_mailbox
-    void compute_initial_hash(); // Calculates hash from scratch for the current state
+    void compute_initial_hash(); // Calculates the hash, pawn hash and material key from scratch for the current state
     // Store state for unmake_move
     struct StateInfo {
         int castling_rights;
         square_e en_passant_square;
         int halfmove_clock;
         zobrist_key_t hash;
+        zobrist_key_t pawn_hash;
+        material_key_t material_key;
         piece_type_e captured_piece_type; // Type of piece captured, P_NONE if no capture
         // square_e captured_piece_square; // Not strictly needed if move implies it
     };
@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <stdexcept>
 #include <algorithm>
+#include <random>
 #include "core/position.hpp"
 #include "core/move.hpp"
 #include "core/movegen.hpp"
@@ -19,7 +20,9 @@
 #include <cmath>
 #include <numbers>
 
+#ifndef M_PI // MinGW only defines it with _USE_MATH_DEFINES, glibc always does
 double M_PI = 3.141592653589793238463;
+#endif
 
 // --- Helper Functions & Structs ---
 //                                                                  
@@ -32,32 +35,6 @@ struct Puzzle {
     int elo;
 };
 
-//--
-/* move_to_uci_string */
-//--
-// Converts a `hyperion::core::Move` object into its standard Universal Chess Interface (UCI)
-// string representation. The function formats the move by concatenating the algebraic
-// notation of the 'from' square and the 'to' square. If the move is a promotion, it
-// appends the corresponding character for the promotion piece ('q', 'r', 'b', or 'n').
-// This function does not modify any variables
-std::string move_to_uci_string(const hyperion::core::Move& move) {
-    using namespace hyperion::core;
-
-    std::string uci_move = square_to_algebraic(static_cast<int>(move.from_sq)) +
-                           square_to_algebraic(static_cast<int>(move.to_sq));
-
-    if (move.is_promotion()) {
-        switch (move.get_promotion_piece()) { 
-            case P_QUEEN:  uci_move += 'q'; break;
-            case P_ROOK:   uci_move += 'r'; break;
-            case P_BISHOP: uci_move += 'b'; break;
-            case P_KNIGHT: uci_move += 'n'; break;
-            default: break;
-        }
-    }
-    return uci_move;
-}
-
 //--
 /* find_solution_uci_from_san */
 //--
@@ -77,8 +54,8 @@ std::string find_solution_uci_from_san(const hyperion::core::Position& pos, std:
     move_gen.generate_legal_puzzle_moves(pos, legal_moves);
 
     for (const auto& move : legal_moves) {
-        if (move.is_kingside_castle() && (san == "O-O" || san == "0-0")) return move_to_uci_string(move);
-        if (move.is_queenside_castle() && (san == "O-O-O" || san == "0-0-0")) return move_to_uci_string(move);
+        if (move.is_kingside_castle() && (san == "O-O" || san == "0-0")) return hyperion::core::move_to_uci_string(move);
+        if (move.is_queenside_castle() && (san == "O-O-O" || san == "0-0-0")) return hyperion::core::move_to_uci_string(move);
         int mailbox_val = pos.get_piece_on_square(move.from_sq); 
         piece_type_e piece = pos.get_piece_type_from_mailbox_val(mailbox_val);
         std::string dest_sq_str = square_to_algebraic(static_cast<int>(move.to_sq));
@@ -97,7 +74,7 @@ std::string find_solution_uci_from_san(const hyperion::core::Position& pos, std:
         }
 
         if (piece_match) {
-            return move_to_uci_string(move);
+            return hyperion::core::move_to_uci_string(move);
         }
     }
     return "NOT_FOUND";
@@ -436,7 +413,7 @@ int main(int argc, char* argv[]) {
     hyperion::core::Position pos;
     pos.set_from_fen(puzzle.fen);
     hyperion::core::Move best_move = search_handler.find_best_move(pos, time_per_move_ms);
-    std::string engine_uci_move = move_to_uci_string(best_move);
+    std::string engine_uci_move = hyperion::core::move_to_uci_string(best_move);
 
     // --- Collect Results for this period ---
     bool is_correct = (engine_uci_move == puzzle.solution_uci);
@@ -0,0 +1,77 @@
+#include "encoder.hpp"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HYPERION_NN_ENCODER_AVX2 1
+#endif
+
+namespace hyperion {
+namespace nn {
+
+//--
+/* expand_bitboard */
+//--
+// AVX2: each rank is one byte of the bitboard. The byte is broadcast to 8 lanes, every lane tests its own
+// bit, and the all ones compare mask is ANDed with the bits of 1.0f, so a rank is 4 instructions and a store
+void expand_bitboard(uint64_t bb, float* out) {
+#ifdef HYPERION_NN_ENCODER_AVX2
+    const __m256i bit_masks = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (int rank = 0; rank < 8; ++rank) {
+        const __m256i byte = _mm256_set1_epi32(static_cast<int>((bb >> (rank * 8)) & 0xFF));
+        const __m256i set = _mm256_cmpeq_epi32(_mm256_and_si256(byte, bit_masks), bit_masks);
+        _mm256_storeu_ps(out + rank * 8, _mm256_and_ps(_mm256_castsi256_ps(set), one));
+    }
+#else
+    for (int sq = 0; sq < 64; ++sq) {
+        out[sq] = static_cast<float>((bb >> sq) & 1ULL);
+    }
+#endif
+}
+
+static void fill_plane(float* plane, float value) {
+    std::fill(plane, plane + 64, value);
+}
+
+//--
+/* encode_position */
+//--
+// Every plane is written (no memset first), the bit planes with expand_bitboard and the rest as constants
+void encode_position(const core::Position& pos, float* out) {
+    // piece planes: white pawn..king, then black pawn..king (core::piece_type_e is in the same order)
+    for (int color = core::WHITE; color <= core::BLACK; ++color) {
+        for (int piece = core::P_PAWN; piece <= core::P_KING; ++piece) {
+            expand_bitboard(pos.piece_bbs[piece][color], out + (color * 6 + piece) * 64);
+        }
+    }
+
+    fill_plane(out + SIDE_TO_MOVE_PLANE * 64, pos.side_to_move == core::WHITE ? 1.0f : 0.0f);
+
+    const int castling_flags[4] = {core::WK_CASTLE_FLAG, core::WQ_CASTLE_FLAG, core::BK_CASTLE_FLAG, core::BQ_CASTLE_FLAG};
+    for (int i = 0; i < 4; ++i) {
+        fill_plane(out + (CASTLING_PLANE + i) * 64, (pos.castling_rights & castling_flags[i]) ? 1.0f : 0.0f);
+    }
+
+    const uint64_t ep_bb = pos.en_passant_square == core::square_e::NO_SQ
+                               ? 0ULL
+                               : 1ULL << static_cast<int>(pos.en_passant_square);
+    expand_bitboard(ep_bb, out + EN_PASSANT_PLANE * 64);
+
+    // fen_parser divides in double precision and numpy rounds to float32 on assignment, so do the same
+    fill_plane(out + FIFTY_MOVE_PLANE * 64, static_cast<float>(std::min(1.0, pos.halfmove_clock / 100.0)));
+    fill_plane(out + FULLMOVE_PLANE * 64,
+               static_cast<float>(std::min(1.0, pos.fullmove_number / static_cast<double>(MAX_EXPECTED_FULLMOVES))));
+}
+
+//--
+/* encode_batch */
+//--
+void encode_batch(const core::Position* positions, int count, float* batch_out) {
+    for (int i = 0; i < count; ++i) {
+        encode_position(positions[i], batch_out + static_cast<size_t>(i) * INPUT_FLOATS);
+    }
+}
+
+} // namespace nn
+} // namespace hyperion
@@ -0,0 +1,41 @@
+#ifndef HYPERION_NN_ENCODER_HPP
+#define HYPERION_NN_ENCODER_HPP
+
+#include "core/position.hpp"
+#include "nn_inference.hpp"
+#include <cstdint>
+
+namespace hyperion {
+namespace nn {
+
+// --- Input planes (the same order as fen_parser.py) ---
+constexpr int PIECE_PLANES = 12;          // 0-5 white P N B R Q K, 6-11 black p n b r q k
+constexpr int SIDE_TO_MOVE_PLANE = 12;    // all 1.0 when white is to move
+constexpr int CASTLING_PLANE = 13;        // 13-16: white kingside, white queenside, black kingside, black queenside
+constexpr int EN_PASSANT_PLANE = 17;      // 1.0 on the en passant target square
+constexpr int FIFTY_MOVE_PLANE = 18;      // min(1, halfmove clock / 100)
+constexpr int FULLMOVE_PLANE = 19;        // min(1, fullmove number / 200)
+constexpr int MAX_EXPECTED_FULLMOVES = 200; // fen_parser.MAX_EXP_MOVE
+
+constexpr int INPUT_FLOATS = NUM_INPUT_PLANES * 64; // floats per encoded position
+
+//--
+/* expand_bitboard */
+//--
+// Writes 64 floats, 1.0 for every set bit and 0.0 for the rest (square index order, so rank by rank)
+void expand_bitboard(uint64_t bb, float* out);
+
+//--
+/* encode_position */
+//--
+// Builds exactly what fen_parser.fen_to_nn_input(pos.to_fen()) returns, straight from the bitboards:
+// INPUT_FLOATS floats in the [plane][rank][file] layout. out doesn't need to be cleared first
+void encode_position(const core::Position& pos, float* out);
+
+// Encodes count positions back to back, so batch_out can go straight into Network::forward
+void encode_batch(const core::Position* positions, int count, float* batch_out);
+
+} // namespace nn
+} // namespace hyperion
+
+#endif // HYPERION_NN_ENCODER_HPP
@@ -0,0 +1,251 @@
+#include "int8_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HYPERION_NN_INT8_AVX2 1
+#if defined(__AVXVNNI__)
+#define HYPERION_NN_INT8_VNNI 1
+#endif
+#endif
+
+namespace hyperion {
+namespace nn {
+
+constexpr int INT8_GROUP = 4;                               // input channels summed per int32 lane
+constexpr int INT8_WEIGHT_VECTOR = INT8_CHANNEL_BLOCK * INT8_GROUP; // 32 bytes, one ymm register
+
+const char* int8_kernels_name() {
+#if defined(HYPERION_NN_INT8_VNNI)
+    return "AVX-VNNI";
+#elif defined(HYPERION_NN_INT8_AVX2)
+    return "AVX2";
+#else
+    return "scalar";
+#endif
+}
+
+static inline uint8_t quantize_activation(float x, float inv_scale) {
+    const float q = std::floor(x * inv_scale + 0.5f);
+    return static_cast<uint8_t>(std::min(std::max(q, 0.0f), static_cast<float>(INT8_MAX_ACTIVATION)));
+}
+
+//--
+/* quantize_conv3x3 */
+//--
+// Symmetric per output channel quantization: scale = max|w| / 127
+// The packed order matches the inner loop of conv3x3_int8: for one block of 8 output channels, every tap
+// and group of 4 input channels is one 32 byte vector of [8 out][4 in]
+void quantize_conv3x3(const float* weights, const float* bias, int in_channels, int out_channels,
+                      float activation_range, Int8Conv3x3& layer) {
+    layer.in_channels = in_channels;
+    layer.out_channels = out_channels;
+    layer.in_padded = int8_channels(in_channels);
+    layer.out_padded = int8_channels(out_channels);
+    layer.input_scale = activation_range > 0.0f ? activation_range / INT8_MAX_ACTIVATION : 1.0f;
+
+    const int groups = layer.in_padded / INT8_GROUP;
+    layer.weights.assign(static_cast<size_t>(layer.out_padded / INT8_CHANNEL_BLOCK) * 9 * groups * INT8_WEIGHT_VECTOR, 0);
+    layer.out_scales.assign(layer.out_padded, 0.0f);
+    layer.bias.assign(layer.out_padded, 0.0f);
+
+    for (int oc = 0; oc < out_channels; ++oc) {
+        const float* w = weights + static_cast<size_t>(oc) * in_channels * 9;
+        float max_abs = 0.0f;
+        for (int i = 0; i < in_channels * 9; ++i) max_abs = std::max(max_abs, std::fabs(w[i]));
+        const float w_scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+
+        layer.out_scales[oc] = layer.input_scale * w_scale;
+        layer.bias[oc] = bias[oc];
+
+        const int block = oc / INT8_CHANNEL_BLOCK, lane = oc % INT8_CHANNEL_BLOCK;
+        for (int ic = 0; ic < in_channels; ++ic) {
+            for (int tap = 0; tap < 9; ++tap) {
+                const long q = std::lround(w[ic * 9 + tap] / w_scale);
+                const size_t idx = ((static_cast<size_t>(block) * 9 + tap) * groups + ic / INT8_GROUP) * INT8_WEIGHT_VECTOR +
+                                   lane * INT8_GROUP + ic % INT8_GROUP;
+                layer.weights[idx] = static_cast<int8_t>(std::min(127L, std::max(-127L, q)));
+            }
+        }
+    }
+}
+
+//--
+/* int8_quantize_input */
+//--
+void int8_quantize_input(const float* input, int batch, int channels, int padded_channels, float input_scale,
+                         uint8_t* output) {
+    std::memset(output, 0, static_cast<size_t>(batch) * INT8_PAD_SQUARES * padded_channels);
+    const float inv_scale = 1.0f / input_scale;
+    for (int b = 0; b < batch; ++b) {
+        uint8_t* dst = output + static_cast<size_t>(b) * INT8_PAD_SQUARES * padded_channels;
+        for (int c = 0; c < channels; ++c) {
+            const float* src = input + (static_cast<size_t>(b) * channels + c) * 64;
+            for (int sq = 0; sq < 64; ++sq) {
+                const int padded_sq = (sq / 8 + 1) * 10 + sq % 8 + 1;
+                dst[padded_sq * padded_channels + c] = quantize_activation(src[sq], inv_scale);
+            }
+        }
+    }
+}
+
+//--
+/* int8_quantize_nhwc */
+//--
+void int8_quantize_nhwc(const float* input, int batch, int padded_channels, float input_scale, uint8_t* output) {
+    std::memset(output, 0, static_cast<size_t>(batch) * INT8_PAD_SQUARES * padded_channels);
+    const float inv_scale = 1.0f / input_scale;
+    for (int b = 0; b < batch; ++b) {
+        uint8_t* dst = output + static_cast<size_t>(b) * INT8_PAD_SQUARES * padded_channels;
+        const float* src = input + static_cast<size_t>(b) * 64 * padded_channels;
+        for (int sq = 0; sq < 64; ++sq) {
+            uint8_t* d = dst + ((sq / 8 + 1) * 10 + sq % 8 + 1) * padded_channels;
+            const float* s = src + sq * padded_channels;
+            for (int c = 0; c < padded_channels; ++c) d[c] = quantize_activation(s[c], inv_scale);
+        }
+    }
+}
+
+//--
+/* nhwc_to_nchw */
+//--
+void nhwc_to_nchw(const float* input, int batch, int channels, int padded_channels, float* output) {
+    for (int b = 0; b < batch; ++b) {
+        const float* src = input + static_cast<size_t>(b) * 64 * padded_channels;
+        float* dst = output + static_cast<size_t>(b) * channels * 64;
+        for (int sq = 0; sq < 64; ++sq) {
+            for (int c = 0; c < channels; ++c) dst[c * 64 + sq] = src[sq * padded_channels + c];
+        }
+    }
+}
+
+#ifdef HYPERION_NN_INT8_AVX2
+
+// acc += the 4 u8 x s8 products of every int32 lane
+static inline __m256i dot_u8s8(__m256i acc, __m256i a, __m256i w) {
+#ifdef HYPERION_NN_INT8_VNNI
+    return _mm256_dpbusd_avx_epi32(acc, a, w);
+#else
+    // 7 bit activations keep the int16 pair sums of maddubs from saturating
+    const __m256i pairs = _mm256_maddubs_epi16(a, w);
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+#endif
+}
+
+static inline __m256i broadcast_group(const uint8_t* p) {
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return _mm256_set1_epi32(v);
+}
+
+//--
+/* conv3x3_int8 block (AVX2) */
+//--
+// W blocks of 8 output channels x P consecutive squares of one rank, W * P int32 accumulators
+// Each tap and group of 4 input channels costs W weight loads + P broadcasts for W * P dot products
+template <int W, int P>
+static void conv_block(const uint8_t* input, const Int8Conv3x3& layer, int first_block, int y, int x0,
+                       const float* residual, bool relu, float* output) {
+    const int cin = layer.in_padded;
+    const int groups = cin / INT8_GROUP;
+    const size_t block_stride = static_cast<size_t>(9) * groups * INT8_WEIGHT_VECTOR;
+
+    __m256i acc[W][P];
+    for (int w = 0; w < W; ++w)
+        for (int p = 0; p < P; ++p) acc[w][p] = _mm256_setzero_si256();
+
+    for (int kh = 0; kh < 3; ++kh) {
+        for (int kw = 0; kw < 3; ++kw) {
+            const uint8_t* a_base = input + ((y + kh) * 10 + x0 + kw) * cin;
+            const int8_t* w_base = layer.weights.data() + static_cast<size_t>(first_block) * block_stride +
+                                   static_cast<size_t>(kh * 3 + kw) * groups * INT8_WEIGHT_VECTOR;
+            for (int g = 0; g < groups; ++g) {
+                __m256i wv[W];
+                for (int w = 0; w < W; ++w) {
+                    wv[w] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                        w_base + w * block_stride + static_cast<size_t>(g) * INT8_WEIGHT_VECTOR));
+                }
+                for (int p = 0; p < P; ++p) {
+                    const __m256i a = broadcast_group(a_base + p * cin + g * INT8_GROUP);
+                    for (int w = 0; w < W; ++w) acc[w][p] = dot_u8s8(acc[w][p], a, wv[w]);
+                }
+            }
+        }
+    }
+
+    const int cout = layer.out_padded;
+    for (int w = 0; w < W; ++w) {
+        const int oc = (first_block + w) * INT8_CHANNEL_BLOCK;
+        const __m256 scale = _mm256_loadu_ps(layer.out_scales.data() + oc);
+        const __m256 bias = _mm256_loadu_ps(layer.bias.data() + oc);
+        for (int p = 0; p < P; ++p) {
+            const size_t idx = static_cast<size_t>(y * 8 + x0 + p) * cout + oc;
+            __m256 v = _mm256_fmadd_ps(_mm256_cvtepi32_ps(acc[w][p]), scale, bias);
+            if (residual) v = _mm256_add_ps(v, _mm256_loadu_ps(residual + idx));
+            if (relu) v = _mm256_max_ps(v, _mm256_setzero_ps());
+            _mm256_storeu_ps(output + idx, v);
+        }
+    }
+}
+
+//--
+/* conv3x3_int8 (AVX2) */
+//--
+void conv3x3_int8(const uint8_t* input, int batch, const Int8Conv3x3& layer, const float* residual, bool relu,
+                  float* output) {
+    const int blocks = layer.out_padded / INT8_CHANNEL_BLOCK;
+    for (int b = 0; b < batch; ++b) {
+        const uint8_t* in = input + static_cast<size_t>(b) * INT8_PAD_SQUARES * layer.in_padded;
+        const float* res = residual ? residual + static_cast<size_t>(b) * 64 * layer.out_padded : nullptr;
+        float* out = output + static_cast<size_t>(b) * 64 * layer.out_padded;
+        for (int y = 0; y < 8; ++y) {
+            for (int x0 = 0; x0 < 8; x0 += 4) {
+                int block = 0;
+                for (; block + 2 <= blocks; block += 2) conv_block<2, 4>(in, layer, block, y, x0, res, relu, out);
+                for (; block < blocks; ++block) conv_block<1, 4>(in, layer, block, y, x0, res, relu, out);
+            }
+        }
+    }
+}
+
+#else
+
+//--
+/* conv3x3_int8 (scalar) */
+//--
+void conv3x3_int8(const uint8_t* input, int batch, const Int8Conv3x3& layer, const float* residual, bool relu,
+                  float* output) {
+    const int cin = layer.in_padded, cout = layer.out_padded;
+    const int groups = cin / INT8_GROUP;
+    for (int b = 0; b < batch; ++b) {
+        const uint8_t* in = input + static_cast<size_t>(b) * INT8_PAD_SQUARES * cin;
+        for (int sq = 0; sq < 64; ++sq) {
+            const int y = sq / 8, x = sq % 8;
+            for (int oc = 0; oc < cout; ++oc) {
+                const int block = oc / INT8_CHANNEL_BLOCK, lane = oc % INT8_CHANNEL_BLOCK;
+                int32_t acc = 0;
+                for (int tap = 0; tap < 9; ++tap) {
+                    const uint8_t* a = in + ((y + tap / 3) * 10 + x + tap % 3) * cin;
+                    const int8_t* w = layer.weights.data() +
+                                      (static_cast<size_t>(block) * 9 + tap) * groups * INT8_WEIGHT_VECTOR + lane * INT8_GROUP;
+                    for (int g = 0; g < groups; ++g) {
+                        for (int i = 0; i < INT8_GROUP; ++i) {
+                            acc += static_cast<int32_t>(a[g * INT8_GROUP + i]) * w[g * INT8_WEIGHT_VECTOR + i];
+                        }
+                    }
+                }
+                const size_t idx = (static_cast<size_t>(b) * 64 + sq) * cout + oc;
+                float v = static_cast<float>(acc) * layer.out_scales[oc] + layer.bias[oc];
+                if (residual) v += residual[idx];
+                output[idx] = (relu && v < 0.0f) ? 0.0f : v;
+            }
+        }
+    }
+}
+
+#endif
+
+} // namespace nn
+} // namespace hyperion
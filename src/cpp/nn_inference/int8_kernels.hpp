@@ -0,0 +1,81 @@
+#ifndef HYPERION_NN_INT8_KERNELS_HPP
+#define HYPERION_NN_INT8_KERNELS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Quantized 3x3 convolution used by the INT8 path of nn_inference.cpp for the entry conv and residual tower
+// Unlike kernels.hpp these layers work on channels last tensors: [batch][square][channel], with the channel
+// count rounded up to INT8_CHANNEL_BLOCK so every square is a whole number of 8 channel vectors
+//
+// Quantization scheme:
+//  - activations are unsigned 7 bit (0..127), input is relu'd (or 0/1 planes) so nothing is lost to the sign,
+//    and 7 bits keep the u8 x s8 pair sums of maddubs from saturating int16 (2 * 127 * 127 < 32767)
+//  - weights are signed 8 bit (-127..127), one scale per output channel
+//  - accumulation is int32, then output = acc * input_scale * weight_scale[oc] + bias (+ residual, relu) in float
+// The scalar, AVX2 (maddubs) and AVX-VNNI (dpbusd) versions compute exactly the same int32 accumulators
+
+namespace hyperion {
+namespace nn {
+
+constexpr int INT8_CHANNEL_BLOCK = 8;           // output channels per vector (8 int32 lanes)
+constexpr int INT8_PAD_SQUARES = 10 * 10;       // 8x8 board with a 1 square zero border
+constexpr int INT8_MAX_ACTIVATION = 127;
+
+inline int int8_channels(int channels) {
+    return (channels + INT8_CHANNEL_BLOCK - 1) / INT8_CHANNEL_BLOCK * INT8_CHANNEL_BLOCK;
+}
+
+//--
+/* struct Int8Conv3x3 */
+//--
+// A 3x3 conv layer with BatchNorm already folded in, quantized once when the INT8 path is enabled
+struct Int8Conv3x3 {
+    int in_channels = 0;            // real channel counts
+    int out_channels = 0;
+    int in_padded = 0;              // rounded up with int8_channels()
+    int out_padded = 0;
+    float input_scale = 1.0f;       // float value of one activation step (calibrated range / 127)
+    std::vector<int8_t> weights;    // [out / 8][kh][kw][in / 4][8 out][4 in]
+    std::vector<float> out_scales;  // input_scale * weight scale, per (padded) output channel
+    std::vector<float> bias;        // per (padded) output channel, zero for the padding
+};
+
+// Quantizes float [out][in][3][3] conv weights (per output channel) into layer, activation_range is the largest
+// input value the layer is expected to see (from calibration)
+void quantize_conv3x3(const float* weights, const float* bias, int in_channels, int out_channels,
+                      float activation_range, Int8Conv3x3& layer);
+
+//--
+/* int8_quantize_input */
+//--
+// Quantizes a channels first [batch][channel][64] float tensor (the network input) into the zero padded,
+// channels last u8 buffer the int8 conv reads: [batch][10 * 10][padded channels]
+void int8_quantize_input(const float* input, int batch, int channels, int padded_channels, float input_scale,
+                         uint8_t* output);
+
+//--
+/* int8_quantize_nhwc */
+//--
+// Same as int8_quantize_input, for a channels last [batch][64][padded channels] float tensor
+void int8_quantize_nhwc(const float* input, int batch, int padded_channels, float input_scale, uint8_t* output);
+
+//--
+/* conv3x3_int8 */
+//--
+// output[b][square][oc] = relu?(acc * out_scales[oc] + bias[oc] + residual?[b][square][oc]), channels last,
+// out_padded channels wide. residual can be nullptr
+void conv3x3_int8(const uint8_t* input, int batch, const Int8Conv3x3& layer, const float* residual, bool relu,
+                  float* output);
+
+// Converts a channels last [batch][64][padded channels] tensor back to [batch][channel][64]
+void nhwc_to_nchw(const float* input, int batch, int channels, int padded_channels, float* output);
+
+// Which instructions conv3x3_int8 was compiled with ("AVX-VNNI", "AVX2" or "scalar")
+const char* int8_kernels_name();
+
+} // namespace nn
+} // namespace hyperion
+
+#endif // HYPERION_NN_INT8_KERNELS_HPP
@@ -0,0 +1,283 @@
+#include "kernels.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define HYPERION_NN_AVX2 1
+#endif
+
+namespace hyperion {
+namespace nn {
+
+// Offsets into one plane's padded block (see conv3x3_pad_input)
+constexpr int PAD_ROWS = 10;
+constexpr int PAD_SHIFT_STRIDE = PAD_ROWS * 8; // floats between the kw = 0, 1, 2 copies
+
+bool kernels_use_avx2() {
+#ifdef HYPERION_NN_AVX2
+    return true;
+#else
+    return false;
+#endif
+}
+
+//--
+/* conv3x3_pad_input */
+//--
+// For every input plane this writes three 10x8 copies, one per kernel column (kw = 0, 1, 2)
+// Copy kw holds in[y][x + kw - 1] at padded row y + 1, with zeros where that falls off the board,
+// and the padded rows 0 and 9 are all zeros
+// This way the tap (kh, kw) for two whole board rows y, y + 1 is just 16 contiguous floats starting at
+// copy kw, padded row y + kh, so the inner loop of conv3x3 is nothing but plain loads and FMAs
+void conv3x3_pad_input(const float* input, int batch, int in_channels, float* pad_buffer) {
+    const int planes = batch * in_channels;
+    std::memset(pad_buffer, 0, sizeof(float) * static_cast<size_t>(planes) * CONV3X3_PAD_FLOATS);
+
+    for (int plane = 0; plane < planes; ++plane) {
+        const float* src = input + static_cast<size_t>(plane) * BOARD_SQUARES;
+        float* dst = pad_buffer + static_cast<size_t>(plane) * CONV3X3_PAD_FLOATS;
+        for (int y = 0; y < 8; ++y) {
+            const float* src_row = src + y * 8;
+            float* left = dst + 0 * PAD_SHIFT_STRIDE + (y + 1) * 8;   // kw = 0 reads x - 1
+            float* center = dst + 1 * PAD_SHIFT_STRIDE + (y + 1) * 8; // kw = 1 reads x
+            float* right = dst + 2 * PAD_SHIFT_STRIDE + (y + 1) * 8;  // kw = 2 reads x + 1
+            for (int x = 0; x < 8; ++x) {
+                center[x] = src_row[x];
+                if (x > 0) left[x] = src_row[x - 1];
+                if (x < 7) right[x] = src_row[x + 1];
+            }
+        }
+    }
+}
+
+#ifdef HYPERION_NN_AVX2
+
+// Adds bias (and the residual), applies relu and stores 8 squares
+static inline void store_output(__m256 acc, float bias, const float* residual, bool relu, float* out) {
+    acc = _mm256_add_ps(acc, _mm256_set1_ps(bias));
+    if (residual) acc = _mm256_add_ps(acc, _mm256_loadu_ps(residual));
+    if (relu) acc = _mm256_max_ps(acc, _mm256_setzero_ps());
+    _mm256_storeu_ps(out, acc);
+}
+
+static inline float horizontal_sum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+//--
+/* conv3x3 (AVX2) */
+//--
+// Register blocked as 4 output channels x 16 squares (two board rows), which is 8 accumulators
+// Each tap costs 2 loads + 4 broadcasts for 8 FMAs. Leftover output channels are done one at a time
+// over the whole board (8 accumulators again)
+void conv3x3(const float* pad_buffer, int batch, int in_channels, int out_channels,
+             const float* weights, const float* bias, const float* residual, bool relu, float* output) {
+    const int K = in_channels * 9;
+
+    for (int b = 0; b < batch; ++b) {
+        const float* pad_b = pad_buffer + static_cast<size_t>(b) * in_channels * CONV3X3_PAD_FLOATS;
+        const size_t out_base = static_cast<size_t>(b) * out_channels * BOARD_SQUARES;
+
+        int oc = 0;
+        for (; oc + 4 <= out_channels; oc += 4) {
+            const float* w0 = weights + static_cast<size_t>(oc) * K;
+            const float* w1 = w0 + K;
+            const float* w2 = w1 + K;
+            const float* w3 = w2 + K;
+
+            for (int y0 = 0; y0 < 8; y0 += 2) {
+                __m256 a00 = _mm256_setzero_ps(), a01 = _mm256_setzero_ps();
+                __m256 a10 = _mm256_setzero_ps(), a11 = _mm256_setzero_ps();
+                __m256 a20 = _mm256_setzero_ps(), a21 = _mm256_setzero_ps();
+                __m256 a30 = _mm256_setzero_ps(), a31 = _mm256_setzero_ps();
+
+                for (int ic = 0; ic < in_channels; ++ic) {
+                    const float* plane = pad_b + static_cast<size_t>(ic) * CONV3X3_PAD_FLOATS;
+                    const int wk = ic * 9;
+                    for (int kh = 0; kh < 3; ++kh) {
+                        for (int kw = 0; kw < 3; ++kw) {
+                            const float* src = plane + kw * PAD_SHIFT_STRIDE + (y0 + kh) * 8;
+                            const __m256 v0 = _mm256_loadu_ps(src);
+                            const __m256 v1 = _mm256_loadu_ps(src + 8);
+                            const int tap = wk + kh * 3 + kw;
+
+                            __m256 w = _mm256_broadcast_ss(w0 + tap);
+                            a00 = _mm256_fmadd_ps(w, v0, a00);
+                            a01 = _mm256_fmadd_ps(w, v1, a01);
+                            w = _mm256_broadcast_ss(w1 + tap);
+                            a10 = _mm256_fmadd_ps(w, v0, a10);
+                            a11 = _mm256_fmadd_ps(w, v1, a11);
+                            w = _mm256_broadcast_ss(w2 + tap);
+                            a20 = _mm256_fmadd_ps(w, v0, a20);
+                            a21 = _mm256_fmadd_ps(w, v1, a21);
+                            w = _mm256_broadcast_ss(w3 + tap);
+                            a30 = _mm256_fmadd_ps(w, v0, a30);
+                            a31 = _mm256_fmadd_ps(w, v1, a31);
+                        }
+                    }
+                }
+
+                const __m256 accs[4][2] = {{a00, a01}, {a10, a11}, {a20, a21}, {a30, a31}};
+                for (int j = 0; j < 4; ++j) {
+                    const size_t idx = out_base + static_cast<size_t>(oc + j) * BOARD_SQUARES + y0 * 8;
+                    for (int h = 0; h < 2; ++h) {
+                        store_output(accs[j][h], bias[oc + j], residual ? residual + idx + h * 8 : nullptr,
+                                     relu, output + idx + h * 8);
+                    }
+                }
+            }
+        }
+
+        for (; oc < out_channels; ++oc) {
+            const float* w = weights + static_cast<size_t>(oc) * K;
+            __m256 acc[8];
+            for (int r = 0; r < 8; ++r) acc[r] = _mm256_setzero_ps();
+
+            for (int ic = 0; ic < in_channels; ++ic) {
+                const float* plane = pad_b + static_cast<size_t>(ic) * CONV3X3_PAD_FLOATS;
+                for (int kh = 0; kh < 3; ++kh) {
+                    for (int kw = 0; kw < 3; ++kw) {
+                        const __m256 wv = _mm256_broadcast_ss(w + ic * 9 + kh * 3 + kw);
+                        const float* src = plane + kw * PAD_SHIFT_STRIDE + kh * 8;
+                        for (int r = 0; r < 8; ++r) {
+                            acc[r] = _mm256_fmadd_ps(wv, _mm256_loadu_ps(src + r * 8), acc[r]);
+                        }
+                    }
+                }
+            }
+            const size_t idx = out_base + static_cast<size_t>(oc) * BOARD_SQUARES;
+            for (int r = 0; r < 8; ++r) {
+                store_output(acc[r], bias[oc], residual ? residual + idx + r * 8 : nullptr, relu, output + idx + r * 8);
+            }
+        }
+    }
+}
+
+//--
+/* conv1x1 (AVX2) */
+//--
+// Keeps the whole 64 square output plane in 8 accumulators and streams the input planes through it
+void conv1x1(const float* input, int batch, int in_channels, int out_channels,
+             const float* weights, const float* bias, bool relu, float* output) {
+    for (int b = 0; b < batch; ++b) {
+        const float* in_b = input + static_cast<size_t>(b) * in_channels * BOARD_SQUARES;
+        for (int oc = 0; oc < out_channels; ++oc) {
+            __m256 acc[8];
+            for (int r = 0; r < 8; ++r) acc[r] = _mm256_setzero_ps();
+            const float* w = weights + static_cast<size_t>(oc) * in_channels;
+            for (int ic = 0; ic < in_channels; ++ic) {
+                const __m256 wv = _mm256_broadcast_ss(w + ic);
+                const float* src = in_b + static_cast<size_t>(ic) * BOARD_SQUARES;
+                for (int r = 0; r < 8; ++r) {
+                    acc[r] = _mm256_fmadd_ps(wv, _mm256_loadu_ps(src + r * 8), acc[r]);
+                }
+            }
+            float* out = output + (static_cast<size_t>(b) * out_channels + oc) * BOARD_SQUARES;
+            for (int r = 0; r < 8; ++r) {
+                store_output(acc[r], bias[oc], nullptr, relu, out + r * 8);
+            }
+        }
+    }
+}
+
+//--
+/* dense (AVX2) */
+//--
+// The output neuron is the outer loop so each weight row is read from memory once and reused for the whole batch
+void dense(const float* input, int batch, int in_features, int out_features,
+           const float* weights, const float* bias, bool relu, float* output) {
+    for (int o = 0; o < out_features; ++o) {
+        const float* w = weights + static_cast<size_t>(o) * in_features;
+        for (int b = 0; b < batch; ++b) {
+            const float* x = input + static_cast<size_t>(b) * in_features;
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            int i = 0;
+            for (; i + 16 <= in_features; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w + i), _mm256_loadu_ps(x + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(w + i + 8), _mm256_loadu_ps(x + i + 8), acc1);
+            }
+            for (; i + 8 <= in_features; i += 8) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(w + i), _mm256_loadu_ps(x + i), acc0);
+            }
+            float sum = bias[o] + horizontal_sum(_mm256_add_ps(acc0, acc1));
+            for (; i < in_features; ++i) sum += w[i] * x[i];
+            output[static_cast<size_t>(b) * out_features + o] = (relu && sum < 0.0f) ? 0.0f : sum;
+        }
+    }
+}
+
+#else // plain C++ versions of the same kernels
+
+void conv3x3(const float* pad_buffer, int batch, int in_channels, int out_channels,
+             const float* weights, const float* bias, const float* residual, bool relu, float* output) {
+    const int K = in_channels * 9;
+    for (int b = 0; b < batch; ++b) {
+        const float* pad_b = pad_buffer + static_cast<size_t>(b) * in_channels * CONV3X3_PAD_FLOATS;
+        for (int oc = 0; oc < out_channels; ++oc) {
+            float acc[BOARD_SQUARES] = {};
+            const float* w = weights + static_cast<size_t>(oc) * K;
+            for (int ic = 0; ic < in_channels; ++ic) {
+                const float* plane = pad_b + static_cast<size_t>(ic) * CONV3X3_PAD_FLOATS;
+                for (int kh = 0; kh < 3; ++kh) {
+                    for (int kw = 0; kw < 3; ++kw) {
+                        const float wv = w[ic * 9 + kh * 3 + kw];
+                        const float* src = plane + kw * PAD_SHIFT_STRIDE + kh * 8;
+                        for (int sq = 0; sq < BOARD_SQUARES; ++sq) acc[sq] += wv * src[sq];
+                    }
+                }
+            }
+            const size_t idx = (static_cast<size_t>(b) * out_channels + oc) * BOARD_SQUARES;
+            for (int sq = 0; sq < BOARD_SQUARES; ++sq) {
+                float v = acc[sq] + bias[oc];
+                if (residual) v += residual[idx + sq];
+                output[idx + sq] = (relu && v < 0.0f) ? 0.0f : v;
+            }
+        }
+    }
+}
+
+void conv1x1(const float* input, int batch, int in_channels, int out_channels,
+             const float* weights, const float* bias, bool relu, float* output) {
+    for (int b = 0; b < batch; ++b) {
+        const float* in_b = input + static_cast<size_t>(b) * in_channels * BOARD_SQUARES;
+        for (int oc = 0; oc < out_channels; ++oc) {
+            float acc[BOARD_SQUARES] = {};
+            for (int ic = 0; ic < in_channels; ++ic) {
+                const float wv = weights[static_cast<size_t>(oc) * in_channels + ic];
+                const float* src = in_b + static_cast<size_t>(ic) * BOARD_SQUARES;
+                for (int sq = 0; sq < BOARD_SQUARES; ++sq) acc[sq] += wv * src[sq];
+            }
+            float* out = output + (static_cast<size_t>(b) * out_channels + oc) * BOARD_SQUARES;
+            for (int sq = 0; sq < BOARD_SQUARES; ++sq) {
+                const float v = acc[sq] + bias[oc];
+                out[sq] = (relu && v < 0.0f) ? 0.0f : v;
+            }
+        }
+    }
+}
+
+void dense(const float* input, int batch, int in_features, int out_features,
+           const float* weights, const float* bias, bool relu, float* output) {
+    for (int o = 0; o < out_features; ++o) {
+        const float* w = weights + static_cast<size_t>(o) * in_features;
+        for (int b = 0; b < batch; ++b) {
+            const float* x = input + static_cast<size_t>(b) * in_features;
+            float sum = bias[o];
+            for (int i = 0; i < in_features; ++i) sum += w[i] * x[i];
+            output[static_cast<size_t>(b) * out_features + o] = (relu && sum < 0.0f) ? 0.0f : sum;
+        }
+    }
+}
+
+#endif // HYPERION_NN_AVX2
+
+} // namespace nn
+} // namespace hyperion
@@ -0,0 +1,51 @@
+#ifndef HYPERION_NN_KERNELS_HPP
+#define HYPERION_NN_KERNELS_HPP
+
+// Low level layers used by nn_inference.cpp
+// Every activation tensor is laid out as [batch][channel][64], where the 64 is the board square index
+// (rank * 8 + file, the same order as core::square_e and as the [plane][rank][file] tensors from fen_parser.py)
+// Weights use the PyTorch layouts directly: conv weights are [out][in][kh][kw] and linear weights are [out][in]
+// With AVX2 + FMA the kernels are vectorized, otherwise the plain C++ loops are used
+
+namespace hyperion {
+namespace nn {
+
+constexpr int BOARD_SQUARES = 64;
+
+//--
+/* conv3x3_pad_input */
+//--
+// Builds the zero padded, column shifted copies of every input plane that conv3x3 reads from
+// Needs pad_buffer to hold batch * in_channels * CONV3X3_PAD_FLOATS floats
+constexpr int CONV3X3_PAD_FLOATS = 3 * 10 * 8; // 3 column shifts * 10 padded rows * 8 files
+void conv3x3_pad_input(const float* input, int batch, int in_channels, float* pad_buffer);
+
+//--
+/* conv3x3 */
+//--
+// 3x3 convolution with 'same' padding on an 8x8 board, using the buffer built by conv3x3_pad_input
+// output = relu?(conv(input) + bias + residual?), residual can be nullptr
+void conv3x3(const float* pad_buffer, int batch, int in_channels, int out_channels,
+             const float* weights, const float* bias, const float* residual, bool relu, float* output);
+
+//--
+/* conv1x1 */
+//--
+// 1x1 convolution (a per square matrix multiply over the channels), used by the policy and value heads
+void conv1x1(const float* input, int batch, int in_channels, int out_channels,
+             const float* weights, const float* bias, bool relu, float* output);
+
+//--
+/* dense */
+//--
+// Fully connected layer: output[b][o] = relu?(bias[o] + dot(weights[o], input[b]))
+void dense(const float* input, int batch, int in_features, int out_features,
+           const float* weights, const float* bias, bool relu, float* output);
+
+// Returns true if this build was compiled with the AVX2/FMA kernels
+bool kernels_use_avx2();
+
+} // namespace nn
+} // namespace hyperion
+
+#endif // HYPERION_NN_KERNELS_HPP
@@ -1 +1,351 @@
-// these files will eventually be used for inference on the trained neural network using ONNX
\ No newline at end of file
+#include "nn_inference.hpp"
+#include "kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <utility>
+
+namespace hyperion {
+namespace nn {
+
+// rounds a tensor size up so the next tensor starts on a 64 byte boundary
+static size_t aligned_size(size_t num_floats) {
+    return (num_floats + WEIGHT_ALIGN_FLOATS - 1) & ~(WEIGHT_ALIGN_FLOATS - 1);
+}
+
+// Walks the standard weight layout once, calling visit(weights_count, bias_count) for every layer in order
+// Both weights_float_count and map_weights use this, so they can never disagree about the layout
+template <typename Visitor>
+static void walk_layout(const NetworkShape& shape, Visitor&& visit) {
+    const size_t f = static_cast<size_t>(shape.num_filters);
+    visit(f * shape.input_planes * 9, f);                              // entry conv
+    for (int i = 0; i < shape.num_blocks; ++i) {
+        visit(f * f * 9, f);                                           // conv1
+        visit(f * f * 9, f);                                           // conv2
+    }
+    visit(POLICY_HEAD_CHANNELS * f, POLICY_HEAD_CHANNELS);             // policy conv
+    visit(static_cast<size_t>(shape.policy_size) * POLICY_HEAD_CHANNELS * 64, shape.policy_size); // policy fc
+    visit(VALUE_HEAD_CHANNELS * f, VALUE_HEAD_CHANNELS);               // value conv
+    visit(static_cast<size_t>(VALUE_HIDDEN_SIZE) * VALUE_HEAD_CHANNELS * 64, VALUE_HIDDEN_SIZE); // value fc1
+    visit(VALUE_HIDDEN_SIZE, 1);                                       // value fc2
+}
+
+//--
+/* weights_float_count */
+//--
+// Total number of floats (with per tensor alignment padding) a network of this shape needs
+size_t weights_float_count(const NetworkShape& shape) {
+    size_t total = 0;
+    walk_layout(shape, [&](size_t w, size_t b) {
+        total += aligned_size(w) + aligned_size(b);
+    });
+    return total;
+}
+
+//--
+/* map_weights */
+//--
+// Builds the layer views for a flat buffer in the standard layout. Nothing is copied
+NetworkWeights map_weights(const float* base, const NetworkShape& shape) {
+    // collect (weights, bias) pointers in layout order
+    std::vector<std::pair<const float*, const float*>> tensors;
+    const float* cursor = base;
+    walk_layout(shape, [&](size_t w, size_t b) {
+        const float* w_ptr = cursor;
+        cursor += aligned_size(w);
+        const float* b_ptr = cursor;
+        cursor += aligned_size(b);
+        tensors.emplace_back(w_ptr, b_ptr);
+    });
+
+    const int f = shape.num_filters;
+    auto conv = [&](size_t idx, int in, int out) {
+        ConvLayer layer;
+        layer.weights = tensors[idx].first;
+        layer.bias = tensors[idx].second;
+        layer.in_channels = in;
+        layer.out_channels = out;
+        return layer;
+    };
+    auto dense = [&](size_t idx, int in, int out) {
+        DenseLayer layer;
+        layer.weights = tensors[idx].first;
+        layer.bias = tensors[idx].second;
+        layer.in_features = in;
+        layer.out_features = out;
+        return layer;
+    };
+
+    NetworkWeights w;
+    w.shape = shape;
+    size_t idx = 0;
+    w.entry = conv(idx++, shape.input_planes, f);
+    w.blocks.resize(shape.num_blocks);
+    for (auto& block : w.blocks) {
+        block.conv1 = conv(idx++, f, f);
+        block.conv2 = conv(idx++, f, f);
+    }
+    w.policy_conv = conv(idx++, f, POLICY_HEAD_CHANNELS);
+    w.policy_fc = dense(idx++, POLICY_HEAD_CHANNELS * 64, shape.policy_size);
+    w.value_conv = conv(idx++, f, VALUE_HEAD_CHANNELS);
+    w.value_fc1 = dense(idx++, VALUE_HEAD_CHANNELS * 64, VALUE_HIDDEN_SIZE);
+    w.value_fc2 = dense(idx++, VALUE_HIDDEN_SIZE, 1);
+    return w;
+}
+
+//--
+/* Network::init_random */
+//--
+// Fills an owned buffer with He-normal weights (std = sqrt(2 / fan_in)) and small random biases
+// The same seed always gives the same network
+void Network::init_random(const NetworkShape& shape, uint32_t seed) {
+    owned_storage.assign(weights_float_count(shape), 0.0f);
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    float* cursor = owned_storage.data();
+    // the fan-in of a layer is weights / bias (out channels), which works for convs and dense layers alike
+    walk_layout(shape, [&](size_t w, size_t b) {
+        const float scale = std::sqrt(2.0f * static_cast<float>(b) / static_cast<float>(w));
+        for (size_t i = 0; i < w; ++i) cursor[i] = normal(rng) * scale;
+        cursor += aligned_size(w);
+        for (size_t i = 0; i < b; ++i) cursor[i] = normal(rng) * 0.1f;
+        cursor += aligned_size(b);
+    });
+
+    weights = map_weights(owned_storage.data(), shape);
+    buffer_batch = 0;
+    loaded = true;
+    reset_int8();
+}
+
+//--
+/* Network::set_weights */
+//--
+// Switches the network over to externally owned weights, dropping any weights it owned
+void Network::set_weights(const NetworkWeights& new_weights) {
+    weights = new_weights;
+    owned_storage.clear();
+    owned_storage.shrink_to_fit();
+    buffer_batch = 0;
+    loaded = true;
+    reset_int8();
+}
+
+//--
+/* Network::reset_int8 */
+//--
+// New weights invalidate both the calibration and the quantized layers
+void Network::reset_int8() {
+    current_precision = Precision::FP32;
+    activation_ranges.clear();
+    int8_layers.clear();
+}
+
+//--
+/* Network::calibrate */
+//--
+// Runs the FP32 network over the positions in chunks, keeping the largest input seen by every 3x3 conv
+void Network::calibrate(const float* inputs, int num_positions) {
+    if (!loaded || num_positions <= 0) return;
+    constexpr int CALIBRATION_BATCH = 64;
+
+    std::vector<float> ranges(activation_range_count(weights.shape), 0.0f);
+    std::vector<float> policy(static_cast<size_t>(CALIBRATION_BATCH) * weights.shape.policy_size);
+    std::vector<float> values(CALIBRATION_BATCH);
+    const size_t position_floats = static_cast<size_t>(weights.shape.input_planes) * BOARD_SQUARES;
+
+    for (int start = 0; start < num_positions; start += CALIBRATION_BATCH) {
+        const int count = std::min(CALIBRATION_BATCH, num_positions - start);
+        forward_fp32(inputs + start * position_floats, count, policy.data(), values.data(), ranges.data());
+    }
+    set_activation_ranges(ranges);
+}
+
+//--
+/* Network::set_activation_ranges */
+//--
+bool Network::set_activation_ranges(const std::vector<float>& ranges) {
+    if (!loaded || ranges.size() != activation_range_count(weights.shape)) return false;
+    activation_ranges = ranges;
+    // the quantized layers depend on the ranges, so rebuild them if they are in use
+    if (current_precision == Precision::INT8) {
+        int8_layers.clear();
+        current_precision = Precision::FP32;
+        set_precision(Precision::INT8);
+    }
+    return true;
+}
+
+//--
+/* Network::set_precision */
+//--
+// Quantizes the entry conv and every tower conv the first time INT8 is selected
+bool Network::set_precision(Precision new_precision) {
+    if (new_precision == Precision::FP32) {
+        current_precision = Precision::FP32;
+        return true;
+    }
+    if (!loaded || activation_ranges.size() != activation_range_count(weights.shape)) return false;
+
+    if (int8_layers.empty()) {
+        int8_layers.resize(activation_range_count(weights.shape));
+        size_t idx = 0;
+        auto quantize = [&](const ConvLayer& layer) {
+            quantize_conv3x3(layer.weights, layer.bias, layer.in_channels, layer.out_channels,
+                             activation_ranges[idx], int8_layers[idx]);
+            idx++;
+        };
+        quantize(weights.entry);
+        for (const auto& block : weights.blocks) {
+            quantize(block.conv1);
+            quantize(block.conv2);
+        }
+        buffer_batch = 0; // the int8 path needs different scratch buffers
+    }
+    current_precision = Precision::INT8;
+    return true;
+}
+
+//--
+/* Network::ensure_buffers */
+//--
+// Makes sure the scratch buffers are big enough for batch_size positions
+void Network::ensure_buffers(int batch_size) {
+    if (batch_size <= buffer_batch) return;
+    const size_t b = static_cast<size_t>(batch_size);
+    const size_t channels = static_cast<size_t>(std::max(weights.shape.num_filters, weights.shape.input_planes));
+    // the int8 tower keeps its activations channels last, with the channels padded
+    const size_t padded_channels = static_cast<size_t>(int8_channels(static_cast<int>(channels)));
+
+    pad_buffer.resize(b * channels * CONV3X3_PAD_FLOATS);
+    act_a.resize(b * padded_channels * BOARD_SQUARES);
+    act_b.resize(act_a.size());
+    act_c.resize(act_a.size());
+    policy_hidden.resize(b * POLICY_HEAD_CHANNELS * BOARD_SQUARES);
+    value_hidden.resize(b * VALUE_HEAD_CHANNELS * BOARD_SQUARES);
+    value_fc_hidden.resize(b * VALUE_HIDDEN_SIZE);
+    if (!int8_layers.empty()) int8_input.resize(b * padded_channels * INT8_PAD_SQUARES);
+    buffer_batch = batch_size;
+}
+
+//--
+/* Network::forward */
+//--
+// Runs the full HyperionNN forward pass, mirroring HyperionNN.forward in resnet_cnn.py:
+// entry conv -> residual tower -> (policy head, value head)
+void Network::forward(const float* input, int batch_size, float* policy_logits, float* values) {
+    if (!loaded || batch_size <= 0) return;
+    if (current_precision == Precision::INT8) {
+        forward_int8(input, batch_size, policy_logits, values);
+    } else {
+        forward_fp32(input, batch_size, policy_logits, values, nullptr);
+    }
+}
+
+// ranges[i] = max(ranges[i], largest value in the tensor), for calibration
+static void track_range(const float* data, size_t count, float* ranges, size_t idx) {
+    if (!ranges) return;
+    float largest = ranges[idx];
+    for (size_t i = 0; i < count; ++i) largest = std::max(largest, data[i]);
+    ranges[idx] = largest;
+}
+
+//--
+/* Network::forward_fp32 */
+//--
+// The float network. If ranges isn't nullptr the largest input of every 3x3 conv gets recorded into it
+void Network::forward_fp32(const float* input, int batch_size, float* policy_logits, float* values, float* ranges) {
+    ensure_buffers(batch_size);
+
+    const NetworkShape& s = weights.shape;
+    const int f = s.num_filters;
+    const size_t tower_floats = static_cast<size_t>(batch_size) * f * BOARD_SQUARES;
+    float* x = act_a.data();   // tower output lives here between blocks
+    float* mid = act_b.data();
+    float* out = act_c.data();
+    size_t range_idx = 0;
+
+    // entry block
+    track_range(input, static_cast<size_t>(batch_size) * s.input_planes * BOARD_SQUARES, ranges, range_idx++);
+    conv3x3_pad_input(input, batch_size, s.input_planes, pad_buffer.data());
+    conv3x3(pad_buffer.data(), batch_size, s.input_planes, f,
+            weights.entry.weights, weights.entry.bias, nullptr, true, x);
+
+    // residual tower
+    for (const auto& block : weights.blocks) {
+        track_range(x, tower_floats, ranges, range_idx++);
+        conv3x3_pad_input(x, batch_size, f, pad_buffer.data());
+        conv3x3(pad_buffer.data(), batch_size, f, f, block.conv1.weights, block.conv1.bias, nullptr, true, mid);
+        track_range(mid, tower_floats, ranges, range_idx++);
+        conv3x3_pad_input(mid, batch_size, f, pad_buffer.data());
+        conv3x3(pad_buffer.data(), batch_size, f, f, block.conv2.weights, block.conv2.bias, x, true, out);
+        std::swap(x, out);
+    }
+
+    forward_heads(x, batch_size, policy_logits, values);
+}
+
+//--
+/* Network::forward_int8 */
+//--
+// Same network with the 3x3 convs quantized. The tower runs channels last: every conv quantizes its float
+// input with the calibrated scale, accumulates in int32 and writes float again, so the skip connections
+// stay in float. The tower output is converted back to channels first for the (cheap) float heads
+void Network::forward_int8(const float* input, int batch_size, float* policy_logits, float* values) {
+    ensure_buffers(batch_size);
+
+    const NetworkShape& s = weights.shape;
+    const int padded = int8_layers[0].out_padded;
+    float* x = act_a.data();
+    float* mid = act_b.data();
+    float* out = act_c.data();
+    uint8_t* q = int8_input.data();
+
+    const Int8Conv3x3& entry = int8_layers[0];
+    int8_quantize_input(input, batch_size, s.input_planes, entry.in_padded, entry.input_scale, q);
+    conv3x3_int8(q, batch_size, entry, nullptr, true, x);
+
+    for (size_t i = 1; i < int8_layers.size(); i += 2) {
+        const Int8Conv3x3& conv1 = int8_layers[i];
+        const Int8Conv3x3& conv2 = int8_layers[i + 1];
+        int8_quantize_nhwc(x, batch_size, padded, conv1.input_scale, q);
+        conv3x3_int8(q, batch_size, conv1, nullptr, true, mid);
+        int8_quantize_nhwc(mid, batch_size, padded, conv2.input_scale, q);
+        conv3x3_int8(q, batch_size, conv2, x, true, out);
+        std::swap(x, out);
+    }
+
+    // mid is free again, use it for the channels first copy of the tower output
+    nhwc_to_nchw(x, batch_size, s.num_filters, padded, mid);
+    forward_heads(mid, batch_size, policy_logits, values);
+}
+
+//--
+/* Network::forward_heads */
+//--
+// Policy and value heads on the [batch][filters][64] tower output
+void Network::forward_heads(const float* x, int batch_size, float* policy_logits, float* values) {
+    const NetworkShape& s = weights.shape;
+    const int f = s.num_filters;
+
+    // policy head: 1x1 conv + relu, flatten, linear
+    conv1x1(x, batch_size, f, POLICY_HEAD_CHANNELS, weights.policy_conv.weights, weights.policy_conv.bias,
+            true, policy_hidden.data());
+    dense(policy_hidden.data(), batch_size, POLICY_HEAD_CHANNELS * BOARD_SQUARES, s.policy_size,
+          weights.policy_fc.weights, weights.policy_fc.bias, false, policy_logits);
+
+    // value head: 1x1 conv + relu, flatten, linear + relu, linear, tanh (train.py applies the tanh outside the model)
+    conv1x1(x, batch_size, f, VALUE_HEAD_CHANNELS, weights.value_conv.weights, weights.value_conv.bias,
+            true, value_hidden.data());
+    dense(value_hidden.data(), batch_size, VALUE_HEAD_CHANNELS * BOARD_SQUARES, VALUE_HIDDEN_SIZE,
+          weights.value_fc1.weights, weights.value_fc1.bias, true, value_fc_hidden.data());
+    dense(value_fc_hidden.data(), batch_size, VALUE_HIDDEN_SIZE, 1,
+          weights.value_fc2.weights, weights.value_fc2.bias, false, values);
+    for (int b = 0; b < batch_size; ++b) {
+        values[b] = std::tanh(values[b]);
+    }
+}
+
+} // namespace nn
+} // namespace hyperion
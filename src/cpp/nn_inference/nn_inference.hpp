@@ -1 +1,151 @@
-// these files will eventually be used for inference on the trained neural network using ONNX
\ No newline at end of file
+#ifndef HYPERION_NN_INFERENCE_HPP
+#define HYPERION_NN_INFERENCE_HPP
+
+#include "int8_kernels.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace hyperion {
+namespace nn {
+
+// --- Network I/O dimensions (these have to match ModelConfig in config.py) ---
+constexpr int NUM_INPUT_PLANES = 20;          // see fen_parser.py
+constexpr int POLICY_MOVE_PLANES = 73;        // see move_encoder.py
+constexpr int POLICY_SIZE = 64 * POLICY_MOVE_PLANES;
+constexpr int POLICY_HEAD_CHANNELS = 2;       // policy head 1x1 conv output channels
+constexpr int VALUE_HEAD_CHANNELS = 1;        // value head 1x1 conv output channels
+constexpr int VALUE_HIDDEN_SIZE = 256;        // value head hidden linear layer
+
+//--
+/* struct NetworkShape */
+//--
+// The hyperparameters of a HyperionNN (models/resnet_cnn.py) that change the size of the weights
+struct NetworkShape {
+    int num_blocks = 16;                   // ModelConfig.NUM_RESIDUAL_BLOCKS
+    int num_filters = 196;                 // ModelConfig.NUM_FILTERS
+    int input_planes = NUM_INPUT_PLANES;   // ModelConfig.NUM_INPUT_PLANES
+    int policy_size = POLICY_SIZE;         // ModelConfig.POLICY_HEAD_SIZE
+};
+
+// --- Views of the weights of one layer ---
+// BatchNorm layers are expected to already be folded into the conv weights and bias,
+// so every conv is just conv + bias. The pointers are not owned by these structs
+struct ConvLayer {
+    const float* weights = nullptr; // [out][in][k][k]
+    const float* bias = nullptr;    // [out]
+    int in_channels = 0;
+    int out_channels = 0;
+};
+
+struct DenseLayer {
+    const float* weights = nullptr; // [out][in]
+    const float* bias = nullptr;    // [out]
+    int in_features = 0;
+    int out_features = 0;
+};
+
+struct ResidualBlockWeights {
+    ConvLayer conv1; // conv + bn1 + relu
+    ConvLayer conv2; // conv + bn2, then skip connection + relu
+};
+
+struct NetworkWeights {
+    NetworkShape shape;
+    ConvLayer entry;                            // 3x3, input_planes -> filters, + relu
+    std::vector<ResidualBlockWeights> blocks;   // 3x3 convs, filters -> filters
+    ConvLayer policy_conv;                      // 1x1, filters -> 2, + relu (no batch norm in this head)
+    DenseLayer policy_fc;                       // 128 -> policy_size
+    ConvLayer value_conv;                       // 1x1, filters -> 1, + relu
+    DenseLayer value_fc1;                       // 64 -> 256, + relu
+    DenseLayer value_fc2;                       // 256 -> 1, then tanh
+};
+
+// Every tensor starts on a 64 byte boundary, so sizes are rounded up to a multiple of this many floats
+constexpr size_t WEIGHT_ALIGN_FLOATS = 16;
+
+// Number of floats needed to store all the weights of a network with this shape (including alignment padding)
+size_t weights_float_count(const NetworkShape& shape);
+
+// Points every layer of a NetworkWeights into one flat buffer laid out in the standard order:
+// entry, blocks (conv1, conv2), policy conv, policy fc, value conv, value fc1, value fc2,
+// with the weights of each layer followed by its bias
+NetworkWeights map_weights(const float* base, const NetworkShape& shape);
+
+// Number of activation ranges the INT8 path needs: the largest input of every 3x3 conv, in the order
+// entry conv, then conv1, conv2 of every residual block
+inline size_t activation_range_count(const NetworkShape& shape) {
+    return 1 + 2 * static_cast<size_t>(shape.num_blocks);
+}
+
+enum class Precision {
+    FP32,
+    INT8    // entry conv and residual tower in int8 (see int8_kernels.hpp), heads stay in float
+};
+
+//--
+/* class Network */
+//--
+// CPU inference for HyperionNN
+// forward() is not thread safe (it uses scratch buffers owned by the network), so give each
+// evaluating thread its own Network, or feed one Network from a single thread
+class Network {
+public:
+    Network() = default;
+
+    // Creates random He initialized weights, owned by the network. Useful for benchmarks and tests
+    void init_random(const NetworkShape& shape, uint32_t seed);
+
+    // Uses weights owned by someone else (they must outlive the network)
+    void set_weights(const NetworkWeights& new_weights);
+
+    bool is_loaded() const { return loaded; }
+    const NetworkShape& shape() const { return weights.shape; }
+    const NetworkWeights& get_weights() const { return weights; }
+
+    // Records the activation ranges of the 3x3 convs by running num_positions positions through the FP32 network
+    // Calibrate on real positions (the Python side uses a sample of the training shards)
+    void calibrate(const float* inputs, int num_positions);
+    // Uses ranges computed elsewhere (e.g. stored in the weight file by calibrate_int8.py)
+    bool set_activation_ranges(const std::vector<float>& ranges);
+    const std::vector<float>& get_activation_ranges() const { return activation_ranges; }
+
+    // Switching to INT8 quantizes the tower weights, so it needs the activation ranges first
+    // Returns false (and stays in FP32) if there aren't any
+    bool set_precision(Precision new_precision);
+    Precision precision() const { return current_precision; }
+
+    // Runs the network on batch_size positions
+    //  input: batch_size * input_planes * 64 floats, the same [plane][rank][file] layout as fen_to_nn_input
+    //  policy_logits: receives batch_size * policy_size raw logits (no softmax)
+    //  values: receives batch_size values in [-1, 1] from the side to move's point of view (tanh applied)
+    void forward(const float* input, int batch_size, float* policy_logits, float* values);
+
+private:
+    NetworkWeights weights;
+    std::vector<float> owned_storage;
+    bool loaded = false;
+
+    // INT8 path
+    Precision current_precision = Precision::FP32;
+    std::vector<float> activation_ranges;
+    std::vector<Int8Conv3x3> int8_layers;   // entry, then conv1, conv2 of every block
+
+    // scratch buffers, grown on demand
+    int buffer_batch = 0;
+    std::vector<float> pad_buffer;
+    std::vector<float> act_a, act_b, act_c;
+    std::vector<float> policy_hidden, value_hidden, value_fc_hidden;
+    std::vector<uint8_t> int8_input;
+
+    void ensure_buffers(int batch_size);
+    void reset_int8();
+    void forward_fp32(const float* input, int batch_size, float* policy_logits, float* values, float* ranges);
+    void forward_int8(const float* input, int batch_size, float* policy_logits, float* values);
+    void forward_heads(const float* tower_output, int batch_size, float* policy_logits, float* values);
+};
+
+} // namespace nn
+} // namespace hyperion
+
+#endif // HYPERION_NN_INFERENCE_HPP
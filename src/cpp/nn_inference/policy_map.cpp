@@ -0,0 +1,108 @@
+#include "policy_map.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define HYPERION_NN_POLICY_AVX2 1
+#endif
+
+namespace hyperion {
+namespace nn {
+
+#ifdef HYPERION_NN_POLICY_AVX2
+// exp for 8 floats: x = n * ln2 + r with |r| <= ln2 / 2, exp(r) from a degree 5 polynomial and 2^n built in
+// the exponent bits. Relative error is about 2e-7, the inputs here are always <= 0 (the max is subtracted)
+static inline __m256 exp256(__m256 x) {
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.0f)); // below this 2^n isn't a normal float anymore
+
+    const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x); // ln2 split in two for precision
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+    const __m256i pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(pow2n));
+}
+
+static inline float horizontal_max(__m256 v) {
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}
+
+static inline float horizontal_sum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+//--
+/* softmax */
+//--
+void softmax(float* values, int count) {
+    if (count <= 0) return;
+    int i = 0;
+    float max_value = values[0];
+#ifdef HYPERION_NN_POLICY_AVX2
+    if (count >= 8) {
+        __m256 vmax = _mm256_loadu_ps(values);
+        for (i = 8; i + 8 <= count; i += 8) vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(values + i));
+        max_value = horizontal_max(vmax);
+    }
+#endif
+    for (; i < count; ++i) max_value = std::max(max_value, values[i]);
+
+    float sum = 0.0f;
+    i = 0;
+#ifdef HYPERION_NN_POLICY_AVX2
+    const __m256 vmax = _mm256_set1_ps(max_value);
+    __m256 vsum = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        const __m256 e = exp256(_mm256_sub_ps(_mm256_loadu_ps(values + i), vmax));
+        _mm256_storeu_ps(values + i, e);
+        vsum = _mm256_add_ps(vsum, e);
+    }
+    sum = horizontal_sum(vsum);
+#endif
+    for (; i < count; ++i) {
+        values[i] = std::exp(values[i] - max_value);
+        sum += values[i];
+    }
+
+    // sum >= 1, the max itself contributes exp(0)
+    const float inv_sum = 1.0f / sum;
+    i = 0;
+#ifdef HYPERION_NN_POLICY_AVX2
+    const __m256 vinv = _mm256_set1_ps(inv_sum);
+    for (; i + 8 <= count; i += 8) _mm256_storeu_ps(values + i, _mm256_mul_ps(_mm256_loadu_ps(values + i), vinv));
+#endif
+    for (; i < count; ++i) values[i] *= inv_sum;
+}
+
+//--
+/* legal_move_priors */
+//--
+// A position has ~35 legal moves, so this softmaxes ~35 values instead of all 4672 outputs
+void legal_move_priors(const float* policy_logits, const std::vector<core::Move>& moves, int side_to_move,
+                       std::vector<float>& priors) {
+    priors.resize(moves.size());
+    for (size_t i = 0; i < moves.size(); ++i) {
+        priors[i] = policy_logits[policy_index(moves[i], side_to_move)];
+    }
+    softmax(priors.data(), static_cast<int>(priors.size()));
+}
+
+} // namespace nn
+} // namespace hyperion
@@ -0,0 +1,87 @@
+#ifndef HYPERION_NN_POLICY_MAP_HPP
+#define HYPERION_NN_POLICY_MAP_HPP
+
+#include "core/move.hpp"
+#include "nn_inference.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace hyperion {
+namespace nn {
+
+// --- Policy move planes (the same order as move_encoder.py) ---
+// index = from_square * POLICY_MOVE_PLANES + plane
+constexpr int QUEEN_MOVE_PLANES = 8 * 7;     // 0-55: direction N NE E SE S SW W NW * 7 + (distance - 1)
+constexpr int KNIGHT_MOVE_PLANES = 8;        // 56-63: NNE ENE ESE SSE SSW WSW WNW NNW
+constexpr int UNDERPROMOTION_PLANE = QUEEN_MOVE_PLANES + KNIGHT_MOVE_PLANES; // 64-72: piece (N B R) * 3 + direction
+constexpr int NO_MOVE_PLANE = -1;
+
+//--
+/* build_move_plane_table */
+//--
+// For every (from, to) pair, the queen or knight plane move_encoder gives that move, or NO_MOVE_PLANE if no
+// piece can move like that. Only the geometry is needed: a knight jump never lines up with a queen direction
+constexpr std::array<int8_t, 64 * 64> build_move_plane_table() {
+    std::array<int8_t, 64 * 64> table{};
+    // QUEEN_DIRECTION_MAP and KNIGHT_DIRECTION_MAP as (file step, rank step)
+    constexpr int queen_dirs[8][2] = {{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+    constexpr int knight_dirs[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+
+    for (int i = 0; i < 64 * 64; ++i) table[i] = NO_MOVE_PLANE;
+    for (int from = 0; from < 64; ++from) {
+        const int file = from % 8, rank = from / 8;
+        for (int dir = 0; dir < 8; ++dir) {
+            for (int distance = 1; distance <= 7; ++distance) {
+                const int f = file + queen_dirs[dir][0] * distance, r = rank + queen_dirs[dir][1] * distance;
+                if (f < 0 || f > 7 || r < 0 || r > 7) break;
+                table[from * 64 + r * 8 + f] = static_cast<int8_t>(dir * 7 + distance - 1);
+            }
+            const int f = file + knight_dirs[dir][0], r = rank + knight_dirs[dir][1];
+            if (f >= 0 && f <= 7 && r >= 0 && r <= 7) {
+                table[from * 64 + r * 8 + f] = static_cast<int8_t>(QUEEN_MOVE_PLANES + dir);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr std::array<int8_t, 64 * 64> MOVE_PLANE_TABLE = build_move_plane_table();
+
+//--
+/* policy_index */
+//--
+// The index of a move in the 4672 policy outputs, the same as move_encoder.uci_to_policy_index
+// The network sees the board from white's side for both colors (fen_parser doesn't flip it), so the side to
+// move only matters for underpromotions, whose direction is relative to the pawn's forward step
+// (straight, toward the a file, toward the h file). Queen promotions use the queen planes
+inline int policy_index(const core::Move& move, int side_to_move) {
+    const int from = static_cast<int>(move.from_sq), to = static_cast<int>(move.to_sq);
+    const core::piece_type_e promotion = move.get_promotion_piece();
+    if (promotion == core::P_KNIGHT || promotion == core::P_BISHOP || promotion == core::P_ROOK) {
+        const int forward = side_to_move == core::WHITE ? 8 : -8;
+        const int direction = (to - from == forward) ? 0 : ((to - from == forward - 1) ? 1 : 2);
+        const int piece = static_cast<int>(promotion) - static_cast<int>(core::P_KNIGHT);
+        return from * POLICY_MOVE_PLANES + UNDERPROMOTION_PLANE + piece * 3 + direction;
+    }
+    return from * POLICY_MOVE_PLANES + MOVE_PLANE_TABLE[from * 64 + to];
+}
+
+//--
+/* softmax */
+//--
+// In place softmax over count values, stable (the max is subtracted first). Vectorized with AVX2 + FMA
+void softmax(float* values, int count);
+
+//--
+/* legal_move_priors */
+//--
+// Gathers the logits of only the legal moves out of one position's policy output (POLICY_SIZE floats,
+// as returned by Network::forward) and softmaxes them, so priors[i] is the prior of moves[i] and they sum to 1
+void legal_move_priors(const float* policy_logits, const std::vector<core::Move>& moves, int side_to_move,
+                       std::vector<float>& priors);
+
+} // namespace nn
+} // namespace hyperion
+
+#endif // HYPERION_NN_POLICY_MAP_HPP
@@ -0,0 +1,150 @@
+// hyperion/src/cpp/nn_inference/test_encoder.cpp
+#include "encoder.hpp"
+#include "core/position.hpp"
+#include "core/zobrist.hpp"
+#include "core/bitboard.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+---
+* Checks the C++ input plane encoder (bitboards -> the 20x8x8 planes of fen_parser.py)
+
+* Build target: TestEncoder
+* Run it:
+    *./bin/TestEncoder*
+        runs the checks below
+    *./bin/TestEncoder --dump "<fen>"*
+        prints the encoded planes as hex float32 bytes, used by src/python/tests/encoder_parity_test.py
+        to compare byte for byte against fen_parser.fen_to_nn_input
+---
+*/
+
+using namespace hyperion;
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+static std::vector<float> encode(const std::string& fen) {
+    core::Position pos;
+    pos.set_from_fen(fen);
+    std::vector<float> planes(nn::INPUT_FLOATS, -1.0f); // not zeroed on purpose, the encoder has to write everything
+    nn::encode_position(pos, planes.data());
+    return planes;
+}
+
+static bool plane_is(const std::vector<float>& planes, int plane, float value) {
+    for (int sq = 0; sq < 64; ++sq) {
+        if (planes[plane * 64 + sq] != value) return false;
+    }
+    return true;
+}
+
+void test_expand_bitboard() {
+    std::cout << "Running test_expand_bitboard..." << std::endl;
+    std::mt19937_64 rng(42);
+    float out[64];
+    for (int i = 0; i < 1000; ++i) {
+        const uint64_t bb = rng();
+        nn::expand_bitboard(bb, out);
+        for (int sq = 0; sq < 64; ++sq) {
+            if (out[sq] != (((bb >> sq) & 1ULL) ? 1.0f : 0.0f)) {
+                check(false, "expand_bitboard differs from the bit at square " + std::to_string(sq));
+                return;
+            }
+        }
+    }
+}
+
+void test_start_position() {
+    std::cout << "Running test_start_position..." << std::endl;
+    std::vector<float> planes = encode("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+
+    // white pawns on rank 2 (plane 0, squares 8-15), black king on e8 (plane 11, square 60)
+    for (int sq = 0; sq < 64; ++sq) {
+        check(planes[0 * 64 + sq] == ((sq >= 8 && sq < 16) ? 1.0f : 0.0f), "white pawn plane");
+        check(planes[11 * 64 + sq] == (sq == 60 ? 1.0f : 0.0f), "black king plane");
+    }
+    check(plane_is(planes, nn::SIDE_TO_MOVE_PLANE, 1.0f), "white to move plane");
+    for (int i = 0; i < 4; ++i) check(plane_is(planes, nn::CASTLING_PLANE + i, 1.0f), "castling plane");
+    check(plane_is(planes, nn::EN_PASSANT_PLANE, 0.0f), "en passant plane");
+    check(plane_is(planes, nn::FIFTY_MOVE_PLANE, 0.0f), "fifty move plane");
+    check(plane_is(planes, nn::FULLMOVE_PLANE, static_cast<float>(1.0 / 200.0)), "fullmove plane");
+}
+
+void test_state_planes() {
+    std::cout << "Running test_state_planes..." << std::endl;
+    // black to move, only white queenside and black kingside castling, en passant on d3, clocks 37 / 250
+    std::vector<float> planes = encode("r3k2r/8/8/8/3Pp3/8/8/R3K2R b Qk d3 37 250");
+
+    check(plane_is(planes, nn::SIDE_TO_MOVE_PLANE, 0.0f), "black to move plane");
+    check(plane_is(planes, nn::CASTLING_PLANE + 0, 0.0f), "white kingside castling plane");
+    check(plane_is(planes, nn::CASTLING_PLANE + 1, 1.0f), "white queenside castling plane");
+    check(plane_is(planes, nn::CASTLING_PLANE + 2, 1.0f), "black kingside castling plane");
+    check(plane_is(planes, nn::CASTLING_PLANE + 3, 0.0f), "black queenside castling plane");
+    for (int sq = 0; sq < 64; ++sq) {
+        check(planes[nn::EN_PASSANT_PLANE * 64 + sq] == (sq == 19 ? 1.0f : 0.0f), "en passant plane (d3)");
+    }
+    check(plane_is(planes, nn::FIFTY_MOVE_PLANE, static_cast<float>(37 / 100.0)), "fifty move plane");
+    check(plane_is(planes, nn::FULLMOVE_PLANE, 1.0f), "fullmove plane is capped at 1");
+}
+
+void test_batch_encoding() {
+    std::cout << "Running test_batch_encoding..." << std::endl;
+    const char* fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "8/2k5/8/8/8/8/5K2/8 b - - 12 60",
+    };
+    std::vector<core::Position> positions(3);
+    for (int i = 0; i < 3; ++i) positions[i].set_from_fen(fens[i]);
+
+    std::vector<float> batch(3 * nn::INPUT_FLOATS, -1.0f);
+    nn::encode_batch(positions.data(), 3, batch.data());
+    for (int i = 0; i < 3; ++i) {
+        std::vector<float> single = encode(fens[i]);
+        check(std::memcmp(single.data(), batch.data() + i * nn::INPUT_FLOATS, sizeof(float) * nn::INPUT_FLOATS) == 0,
+              "batch slot " + std::to_string(i) + " differs from encoding the position alone");
+    }
+}
+
+// Prints the planes as the hex of their little endian float32 bytes (numpy's tobytes().hex())
+static int dump(const std::string& fen) {
+    std::vector<float> planes = encode(fen);
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(planes.data());
+    for (size_t i = 0; i < planes.size() * sizeof(float); ++i) std::printf("%02x", bytes[i]);
+    std::printf("\n");
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    core::Zobrist::initialize_keys();
+    core::initialize_attack_tables();
+
+    if (argc == 3 && std::string(argv[1]) == "--dump") {
+        return dump(argv[2]);
+    }
+
+    std::cout << "---===--- Encoder test ---===---" << std::endl;
+    test_expand_bitboard();
+    test_start_position();
+    test_state_planes();
+    test_batch_encoding();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "All encoder tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,420 @@
+// hyperion/src/cpp/nn_inference/test_nn_inference.cpp
+#include "nn_inference.hpp"
+#include "kernels.hpp"
+#include "weights_file.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+/*
+---
+* Checks the (AVX2) inference engine against a naive, obviously correct implementation of HyperionNN
+* on a small random network, checks the INT8 path against a fake quantized reference and reports how close
+* it stays to FP32, checks that weight files load back exactly, then prints rough FP32/INT8 evaluation
+* speeds and how long it takes to map a full size (20 blocks x 256 filters) weight file
+
+* Build target: TestNNInference
+* Run it:
+    *./bin/TestNNInference*
+---
+*/
+
+using namespace hyperion::nn;
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+// --- Naive reference layers, written straight from the PyTorch definitions ---
+
+static void ref_conv(const std::vector<float>& in, int batch, const ConvLayer& layer, int k,
+                     const std::vector<float>* residual, bool relu, std::vector<float>& out) {
+    out.assign(static_cast<size_t>(batch) * layer.out_channels * 64, 0.0f);
+    const int pad = k / 2;
+    for (int b = 0; b < batch; ++b)
+    for (int oc = 0; oc < layer.out_channels; ++oc)
+    for (int y = 0; y < 8; ++y)
+    for (int x = 0; x < 8; ++x) {
+        float sum = layer.bias[oc];
+        for (int ic = 0; ic < layer.in_channels; ++ic)
+        for (int kh = 0; kh < k; ++kh)
+        for (int kw = 0; kw < k; ++kw) {
+            int sy = y + kh - pad, sx = x + kw - pad;
+            if (sy < 0 || sy > 7 || sx < 0 || sx > 7) continue;
+            sum += layer.weights[((oc * layer.in_channels + ic) * k + kh) * k + kw] *
+                   in[((static_cast<size_t>(b) * layer.in_channels + ic) * 64) + sy * 8 + sx];
+        }
+        size_t idx = (static_cast<size_t>(b) * layer.out_channels + oc) * 64 + y * 8 + x;
+        if (residual) sum += (*residual)[idx];
+        out[idx] = (relu && sum < 0.0f) ? 0.0f : sum;
+    }
+}
+
+static void ref_dense(const std::vector<float>& in, int batch, const DenseLayer& layer, bool relu, std::vector<float>& out) {
+    out.assign(static_cast<size_t>(batch) * layer.out_features, 0.0f);
+    for (int b = 0; b < batch; ++b)
+    for (int o = 0; o < layer.out_features; ++o) {
+        float sum = layer.bias[o];
+        for (int i = 0; i < layer.in_features; ++i) {
+            sum += layer.weights[static_cast<size_t>(o) * layer.in_features + i] * in[static_cast<size_t>(b) * layer.in_features + i];
+        }
+        out[static_cast<size_t>(b) * layer.out_features + o] = (relu && sum < 0.0f) ? 0.0f : sum;
+    }
+}
+
+static void ref_forward(const NetworkWeights& w, const std::vector<float>& input, int batch,
+                        std::vector<float>& policy, std::vector<float>& value) {
+    std::vector<float> x, mid, out, ph, vh, vfc;
+    ref_conv(input, batch, w.entry, 3, nullptr, true, x);
+    for (const auto& block : w.blocks) {
+        ref_conv(x, batch, block.conv1, 3, nullptr, true, mid);
+        ref_conv(mid, batch, block.conv2, 3, &x, true, out);
+        x.swap(out);
+    }
+    ref_conv(x, batch, w.policy_conv, 1, nullptr, true, ph);
+    ref_dense(ph, batch, w.policy_fc, false, policy);
+    ref_conv(x, batch, w.value_conv, 1, nullptr, true, vh);
+    ref_dense(vh, batch, w.value_fc1, true, vfc);
+    ref_dense(vfc, batch, w.value_fc2, false, value);
+    for (auto& v : value) v = std::tanh(v);
+}
+
+static std::vector<float> random_planes(int batch, std::mt19937& rng) {
+    std::vector<float> planes(static_cast<size_t>(batch) * NUM_INPUT_PLANES * 64);
+    std::bernoulli_distribution bit(0.15);
+    for (auto& p : planes) p = bit(rng) ? 1.0f : 0.0f;
+    return planes;
+}
+
+void test_forward_matches_reference() {
+    std::cout << "Running test_forward_matches_reference..." << std::endl;
+    // 18 filters is not a multiple of 4, so the leftover channel path of conv3x3 is covered too
+    NetworkShape shape;
+    shape.num_blocks = 2;
+    shape.num_filters = 18;
+
+    Network net;
+    net.init_random(shape, 1234);
+
+    std::mt19937 rng(99);
+    const int batch = 3;
+    std::vector<float> input = random_planes(batch, rng);
+
+    std::vector<float> policy(static_cast<size_t>(batch) * shape.policy_size), value(batch);
+    net.forward(input.data(), batch, policy.data(), value.data());
+
+    std::vector<float> ref_policy, ref_value;
+    ref_forward(net.get_weights(), input, batch, ref_policy, ref_value);
+
+    float max_policy_err = 0.0f, max_value_err = 0.0f;
+    for (size_t i = 0; i < policy.size(); ++i) max_policy_err = std::max(max_policy_err, std::fabs(policy[i] - ref_policy[i]));
+    for (int b = 0; b < batch; ++b) max_value_err = std::max(max_value_err, std::fabs(value[b] - ref_value[b]));
+
+    std::cout << "  max policy error " << max_policy_err << ", max value error " << max_value_err
+              << (kernels_use_avx2() ? " (AVX2 kernels)" : " (scalar kernels)") << std::endl;
+    check(max_policy_err < 1e-3f, "policy logits differ from the reference");
+    check(max_value_err < 1e-4f, "values differ from the reference");
+}
+
+void test_batch_is_independent() {
+    std::cout << "Running test_batch_is_independent..." << std::endl;
+    // evaluating positions together has to give exactly what evaluating them one by one gives
+    NetworkShape shape;
+    shape.num_blocks = 1;
+    shape.num_filters = 8;
+    Network net;
+    net.init_random(shape, 7);
+
+    std::mt19937 rng(5);
+    const int batch = 4;
+    std::vector<float> input = random_planes(batch, rng);
+    std::vector<float> policy(static_cast<size_t>(batch) * shape.policy_size), value(batch);
+    net.forward(input.data(), batch, policy.data(), value.data());
+
+    std::vector<float> single_policy(shape.policy_size);
+    float single_value = 0.0f;
+    for (int b = 0; b < batch; ++b) {
+        net.forward(input.data() + static_cast<size_t>(b) * NUM_INPUT_PLANES * 64, 1, single_policy.data(), &single_value);
+        check(single_value == value[b], "batched value differs from the single position value");
+        check(std::equal(single_policy.begin(), single_policy.end(), policy.begin() + static_cast<size_t>(b) * shape.policy_size),
+              "batched policy differs from the single position policy");
+    }
+}
+
+// --- INT8 reference: quantize / dequantize every 3x3 conv input and weight exactly like int8_kernels.cpp ---
+
+static std::vector<float> fake_quantize_input(const std::vector<float>& in, float range) {
+    const float scale = range > 0.0f ? range / 127.0f : 1.0f;
+    std::vector<float> out(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        const float q = std::floor(in[i] * (1.0f / scale) + 0.5f);
+        out[i] = std::min(std::max(q, 0.0f), 127.0f) * scale;
+    }
+    return out;
+}
+
+static ConvLayer fake_quantize_weights(const ConvLayer& layer, std::vector<float>& storage) {
+    const size_t per_oc = static_cast<size_t>(layer.in_channels) * 9;
+    storage.assign(layer.weights, layer.weights + per_oc * layer.out_channels);
+    for (int oc = 0; oc < layer.out_channels; ++oc) {
+        float* w = storage.data() + oc * per_oc;
+        float max_abs = 0.0f;
+        for (size_t i = 0; i < per_oc; ++i) max_abs = std::max(max_abs, std::fabs(w[i]));
+        const float scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+        for (size_t i = 0; i < per_oc; ++i) w[i] = static_cast<float>(std::lround(w[i] / scale)) * scale;
+    }
+    ConvLayer quantized = layer;
+    quantized.weights = storage.data();
+    return quantized;
+}
+
+static void ref_forward_int8(const NetworkWeights& w, const std::vector<float>& ranges, const std::vector<float>& input,
+                             int batch, std::vector<float>& policy, std::vector<float>& value) {
+    std::vector<float> x, mid, out, ph, vh, vfc, storage;
+    size_t r = 0;
+    ref_conv(fake_quantize_input(input, ranges[r++]), batch, fake_quantize_weights(w.entry, storage), 3, nullptr, true, x);
+    for (const auto& block : w.blocks) {
+        ref_conv(fake_quantize_input(x, ranges[r++]), batch, fake_quantize_weights(block.conv1, storage), 3, nullptr, true, mid);
+        ref_conv(fake_quantize_input(mid, ranges[r++]), batch, fake_quantize_weights(block.conv2, storage), 3, &x, true, out);
+        x.swap(out);
+    }
+    ref_conv(x, batch, w.policy_conv, 1, nullptr, true, ph);
+    ref_dense(ph, batch, w.policy_fc, false, policy);
+    ref_conv(x, batch, w.value_conv, 1, nullptr, true, vh);
+    ref_dense(vh, batch, w.value_fc1, true, vfc);
+    ref_dense(vfc, batch, w.value_fc2, false, value);
+    for (auto& v : value) v = std::tanh(v);
+}
+
+void test_int8_matches_reference() {
+    std::cout << "Running test_int8_matches_reference..." << std::endl;
+    // 18 filters pads to 24 channels, and 3 blocks of 8 output channels leaves one for the single block path
+    NetworkShape shape;
+    shape.num_blocks = 2;
+    shape.num_filters = 18;
+    Network net;
+    net.init_random(shape, 1234);
+
+    std::mt19937 rng(21);
+    std::vector<float> calibration = random_planes(64, rng);
+    check(!net.set_precision(Precision::INT8), "INT8 was enabled without calibration");
+    net.calibrate(calibration.data(), 64);
+    check(net.set_precision(Precision::INT8), "could not enable INT8 after calibration");
+
+    const int batch = 3;
+    std::vector<float> input = random_planes(batch, rng);
+    std::vector<float> policy(static_cast<size_t>(batch) * shape.policy_size), value(batch);
+    net.forward(input.data(), batch, policy.data(), value.data());
+
+    std::vector<float> ref_policy, ref_value;
+    ref_forward_int8(net.get_weights(), net.get_activation_ranges(), input, batch, ref_policy, ref_value);
+
+    float max_policy_err = 0.0f, max_value_err = 0.0f;
+    for (size_t i = 0; i < policy.size(); ++i) max_policy_err = std::max(max_policy_err, std::fabs(policy[i] - ref_policy[i]));
+    for (int b = 0; b < batch; ++b) max_value_err = std::max(max_value_err, std::fabs(value[b] - ref_value[b]));
+    std::cout << "  max policy error " << max_policy_err << ", max value error " << max_value_err
+              << " (" << int8_kernels_name() << " int8 kernels)" << std::endl;
+    // rounding exactly on a .5 step can flip one quantized activation, so allow a little slack
+    check(max_policy_err < 1e-2f, "INT8 policy logits differ from the fake quantized reference");
+    check(max_value_err < 1e-3f, "INT8 values differ from the fake quantized reference");
+}
+
+void test_int8_accuracy_report() {
+    std::cout << "Running test_int8_accuracy_report..." << std::endl;
+    // the same numbers calibrate_int8.py reports on real positions: policy top-1 agreement and value MSE vs FP32
+    NetworkShape shape;
+    shape.num_blocks = 4;
+    shape.num_filters = 32;
+    Network net;
+    net.init_random(shape, 77);
+
+    std::mt19937 rng(8);
+    const int calibration_size = 256, test_size = 256;
+    std::vector<float> calibration = random_planes(calibration_size, rng);
+    std::vector<float> input = random_planes(test_size, rng);
+    net.calibrate(calibration.data(), calibration_size);
+
+    std::vector<float> policy_fp32(static_cast<size_t>(test_size) * shape.policy_size), value_fp32(test_size);
+    std::vector<float> policy_int8(policy_fp32.size()), value_int8(test_size);
+    net.forward(input.data(), test_size, policy_fp32.data(), value_fp32.data());
+    net.set_precision(Precision::INT8);
+    net.forward(input.data(), test_size, policy_int8.data(), value_int8.data());
+
+    int agree = 0;
+    double mse = 0.0;
+    for (int b = 0; b < test_size; ++b) {
+        auto fp32_begin = policy_fp32.begin() + static_cast<size_t>(b) * shape.policy_size;
+        auto int8_begin = policy_int8.begin() + static_cast<size_t>(b) * shape.policy_size;
+        if (std::max_element(fp32_begin, fp32_begin + shape.policy_size) - fp32_begin ==
+            std::max_element(int8_begin, int8_begin + shape.policy_size) - int8_begin) {
+            agree++;
+        }
+        mse += (value_fp32[b] - value_int8[b]) * (value_fp32[b] - value_int8[b]);
+    }
+    mse /= test_size;
+    const double agreement = 100.0 * agree / test_size;
+    std::cout << "  policy top-1 agreement " << agreement << "%, value MSE " << mse << std::endl;
+    check(agreement >= 85.0, "INT8 policy top-1 agreement with FP32 is too low");
+    check(mse < 5e-3, "INT8 value MSE against FP32 is too high");
+}
+
+void test_weight_file_roundtrip() {
+    std::cout << "Running test_weight_file_roundtrip..." << std::endl;
+    NetworkShape shape;
+    shape.num_blocks = 2;
+    shape.num_filters = 18;
+    Network net;
+    net.init_random(shape, 42);
+
+    const std::string path = "test_weights_roundtrip.hnn";
+    check(save_weight_file(path, net.get_weights()), "could not write the weight file");
+
+    {
+        WeightFile file;
+        check(file.open(path), "could not open the weight file: " + file.error());
+        if (file.is_open()) {
+            check(file.shape().num_blocks == 2 && file.shape().num_filters == 18, "weight file shape differs");
+
+            Network mapped;
+            mapped.set_weights(file.weights());
+
+            std::mt19937 rng(11);
+            const int batch = 2;
+            std::vector<float> input = random_planes(batch, rng);
+            std::vector<float> policy_a(static_cast<size_t>(batch) * shape.policy_size), value_a(batch);
+            std::vector<float> policy_b(policy_a.size()), value_b(batch);
+            net.forward(input.data(), batch, policy_a.data(), value_a.data());
+            mapped.forward(input.data(), batch, policy_b.data(), value_b.data());
+            check(policy_a == policy_b && value_a == value_b, "mapped weights give a different result");
+            check(file.activation_ranges().empty(), "a file without calibration has activation ranges");
+        }
+    }
+
+    // with the INT8 calibration stored in the file
+    {
+        std::mt19937 rng(12);
+        std::vector<float> calibration = random_planes(16, rng);
+        net.calibrate(calibration.data(), 16);
+        check(save_weight_file(path, net.get_weights(), net.get_activation_ranges()), "could not write the calibrated weight file");
+        WeightFile file;
+        check(file.open(path), "could not open the calibrated weight file: " + file.error());
+        check(file.activation_ranges() == net.get_activation_ranges(), "activation ranges differ after loading");
+    }
+
+    // a header whose shape or body offset doesn't fit the file has to be rejected before anything is sized from it
+    auto patch_header = [&path](const WeightFileHeader& header) {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        if (!f) return;
+        std::fwrite(&header, sizeof(header), 1, f);
+        std::fclose(f);
+    };
+    {
+        WeightFile file;
+        check(file.open(path), "could not reopen the weight file: " + file.error());
+        const WeightFileHeader good = file.header();
+        file.close();
+
+        WeightFileHeader bad = good;
+        bad.num_blocks = 0x80000000u;
+        patch_header(bad);
+        check(!file.open(path), "a weight file with 2^31 blocks was accepted");
+
+        bad = good;
+        bad.body_offset = ~uint64_t(0) - 63;
+        patch_header(bad);
+        check(!file.open(path), "a weight file with a body offset past the end was accepted");
+        patch_header(good);
+    }
+
+    // a file with a bad magic has to be rejected instead of mapped
+    {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        if (f) {
+            std::fputc('X', f);
+            std::fclose(f);
+        }
+        WeightFile file;
+        check(!file.open(path), "a corrupted weight file was accepted");
+    }
+    std::remove(path.c_str());
+}
+
+void benchmark_forward() {
+    std::cout << "Running benchmark_forward..." << std::endl;
+    NetworkShape shape;
+    shape.num_blocks = 4;
+    shape.num_filters = 64;
+    Network net;
+    net.init_random(shape, 1);
+
+    std::mt19937 rng(3);
+    const int batch = 16;
+    std::vector<float> input = random_planes(batch, rng);
+    std::vector<float> policy(static_cast<size_t>(batch) * shape.policy_size), value(batch);
+
+    net.calibrate(input.data(), batch);
+
+    const int runs = 10;
+    for (Precision precision : {Precision::FP32, Precision::INT8}) {
+        net.set_precision(precision);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; ++i) net.forward(input.data(), batch, policy.data(), value.data());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  4b x 64f, batch " << batch << (precision == Precision::INT8 ? ", INT8: " : ", FP32: ")
+                  << static_cast<int>(runs * batch / seconds) << " evals/s" << std::endl;
+    }
+}
+
+void benchmark_weight_file_open() {
+    std::cout << "Running benchmark_weight_file_open..." << std::endl;
+    NetworkShape shape;
+    shape.num_blocks = 20;
+    shape.num_filters = 256;
+    const std::string path = "test_weights_20b_256f.hnn";
+    {
+        Network net;
+        net.init_random(shape, 2);
+        check(save_weight_file(path, net.get_weights()), "could not write the 20b x 256f weight file");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WeightFile file;
+    bool opened = file.open(path);
+    Network net;
+    net.set_weights(file.weights());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    check(opened, "could not open the 20b x 256f weight file: " + file.error());
+    std::cout << "  mapped " << (file.header().body_floats * sizeof(float)) / (1024 * 1024) << " MB of weights in "
+              << ms << " ms" << std::endl;
+    check(ms < 50.0, "loading the weight file took longer than 50 ms");
+
+    file.close();
+    std::remove(path.c_str());
+}
+
+int main() {
+    std::cout << "---===--- NN inference test ---===---" << std::endl;
+    test_forward_matches_reference();
+    test_batch_is_independent();
+    test_int8_matches_reference();
+    test_int8_accuracy_report();
+    test_weight_file_roundtrip();
+    benchmark_forward();
+    benchmark_weight_file_open();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "All NN inference tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,161 @@
+// hyperion/src/cpp/nn_inference/test_policy_map.cpp
+#include "policy_map.hpp"
+#include "core/position.hpp"
+#include "core/movegen.hpp"
+#include "core/zobrist.hpp"
+#include "core/bitboard.hpp"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+---
+* Checks the Move -> policy index mapping and the legal move softmax
+
+* Build target: TestPolicyMap
+* Run it:
+    *./bin/TestPolicyMap*
+        runs the checks below
+    *./bin/TestPolicyMap --dump "<fen>"*
+        prints "<uci> <piece> <policy index>" for every legal move, used by src/python/tests/policy_map_parity_test.py
+        to compare against move_encoder.uci_to_policy_index
+---
+*/
+
+using namespace hyperion;
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+static std::vector<core::Move> legal_moves_of(const std::string& fen, core::Position& pos) {
+    pos.set_from_fen(fen);
+    core::MoveGenerator move_gen;
+    std::vector<core::Move> moves;
+    move_gen.generate_legal_moves(pos, moves);
+    return moves;
+}
+
+void test_known_indices() {
+    std::cout << "Running test_known_indices..." << std::endl;
+    using core::Move;
+    using core::square_e;
+    // worked out by hand from move_encoder.py
+    check(nn::policy_index(Move(square_e::SQ_E2, square_e::SQ_E4, core::P_PAWN), core::WHITE) == 12 * 73 + 0 * 7 + 1, "e2e4");
+    check(nn::policy_index(Move(square_e::SQ_G1, square_e::SQ_F3, core::P_KNIGHT), core::WHITE) == 6 * 73 + 56 + 7, "g1f3");
+    check(nn::policy_index(Move(square_e::SQ_E8, square_e::SQ_C8, core::P_KING), core::BLACK) == 60 * 73 + 6 * 7 + 1, "e8c8");
+    check(nn::policy_index(Move(square_e::SQ_H8, square_e::SQ_A1, core::P_QUEEN), core::BLACK) == 63 * 73 + 5 * 7 + 6, "h8a1");
+    check(nn::policy_index(Move::make_promotion(square_e::SQ_B7, square_e::SQ_A8, core::P_PAWN, core::P_ROOK, true, core::P_KNIGHT),
+                           core::WHITE) == 49 * 73 + 64 + 2 * 3 + 1, "b7a8r");
+    check(nn::policy_index(Move::make_promotion(square_e::SQ_B2, square_e::SQ_C1, core::P_PAWN, core::P_KNIGHT, true, core::P_ROOK),
+                           core::BLACK) == 9 * 73 + 64 + 0 * 3 + 2, "b2c1n");
+    check(nn::policy_index(Move::make_promotion(square_e::SQ_D2, square_e::SQ_D1, core::P_PAWN, core::P_BISHOP, false), core::BLACK)
+          == 11 * 73 + 64 + 1 * 3 + 0, "d2d1b");
+    check(nn::policy_index(Move::make_promotion(square_e::SQ_D7, square_e::SQ_D8, core::P_PAWN, core::P_QUEEN, false), core::WHITE)
+          == 51 * 73 + 0 * 7 + 0, "d7d8q uses the queen plane");
+}
+
+void test_legal_moves_are_distinct() {
+    std::cout << "Running test_legal_moves_are_distinct..." << std::endl;
+    const char* fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N w - - 0 1",
+    };
+    for (const char* fen : fens) {
+        core::Position pos;
+        std::vector<core::Move> moves = legal_moves_of(fen, pos);
+        std::set<int> seen;
+        for (const auto& move : moves) {
+            const int index = nn::policy_index(move, pos.side_to_move);
+            check(index >= 0 && index < nn::POLICY_SIZE, "index out of range for " + core::move_to_uci_string(move));
+            check(index / nn::POLICY_MOVE_PLANES == static_cast<int>(move.from_sq), "index isn't on the from square");
+            seen.insert(index);
+        }
+        check(seen.size() == moves.size(), std::string("two legal moves share a policy index in ") + fen);
+    }
+}
+
+void test_softmax() {
+    std::cout << "Running test_softmax..." << std::endl;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-20.0f, 20.0f);
+    for (int count : {1, 5, 8, 35, 64, 218}) {
+        std::vector<float> values(count);
+        for (auto& v : values) v = dist(rng);
+        values[0] = 1000.0f; // would overflow without subtracting the max
+
+        std::vector<double> expected(count);
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) sum += (expected[i] = std::exp(static_cast<double>(values[i]) - 1000.0));
+
+        nn::softmax(values.data(), count);
+        double total = 0.0;
+        for (int i = 0; i < count; ++i) {
+            check(std::fabs(values[i] - expected[i] / sum) < 1e-6, "softmax differs from the double reference");
+            total += values[i];
+        }
+        check(std::fabs(total - 1.0) < 1e-5, "softmax doesn't sum to 1");
+    }
+}
+
+void test_legal_move_priors() {
+    std::cout << "Running test_legal_move_priors..." << std::endl;
+    core::Position pos;
+    std::vector<core::Move> moves = legal_moves_of("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", pos);
+
+    std::vector<float> logits(nn::POLICY_SIZE, -5.0f);
+    const int favourite = 3;
+    logits[nn::policy_index(moves[favourite], pos.side_to_move)] = 5.0f;
+
+    std::vector<float> priors;
+    nn::legal_move_priors(logits.data(), moves, pos.side_to_move, priors);
+    check(priors.size() == moves.size(), "one prior per legal move");
+    const double others = static_cast<double>(moves.size() - 1);
+    const double expected = 1.0 / (1.0 + others * std::exp(-10.0));
+    check(std::fabs(priors[favourite] - expected) < 1e-5, "the boosted move got the wrong prior");
+}
+
+// Prints the legal moves with the piece letter move_encoder expects ('N' / 'n' for knights) and their index
+static int dump(const std::string& fen) {
+    core::Position pos;
+    std::vector<core::Move> moves = legal_moves_of(fen, pos);
+    const char pieces[] = "pnbrqk";
+    for (const auto& move : moves) {
+        char piece = pieces[move.piece_moved];
+        if (pos.side_to_move == core::WHITE) piece = static_cast<char>(piece - 'a' + 'A');
+        std::cout << core::move_to_uci_string(move) << " " << piece << " " << nn::policy_index(move, pos.side_to_move) << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    core::Zobrist::initialize_keys();
+    core::initialize_attack_tables();
+
+    if (argc == 3 && std::string(argv[1]) == "--dump") {
+        return dump(argv[2]);
+    }
+
+    std::cout << "---===--- Policy map test ---===---" << std::endl;
+    test_known_indices();
+    test_legal_moves_are_distinct();
+    test_softmax();
+    test_legal_move_priors();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "All policy map tests passed" << std::endl;
+    return 0;
+}
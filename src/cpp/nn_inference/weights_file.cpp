@@ -0,0 +1,195 @@
+#include "weights_file.hpp"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace hyperion {
+namespace nn {
+
+WeightFile::~WeightFile() {
+    close();
+}
+
+bool WeightFile::fail(const std::string& message) {
+    close();
+    last_error = message;
+    return false;
+}
+
+//--
+/* WeightFile::open */
+//--
+// Maps the whole file read only and checks the header against the size of the file
+// Nothing is copied: the returned weights point into the mapping
+bool WeightFile::open(const std::string& path) {
+    close();
+    last_error.clear();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return fail("could not open " + path);
+    file_handle = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) return fail("could not get the size of " + path);
+    mapped_size = static_cast<size_t>(file_size.QuadPart);
+    if (mapped_size < sizeof(WeightFileHeader)) return fail(path + " is too small to be a weight file");
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) return fail("could not map " + path);
+    mapping_handle = mapping;
+
+    mapped_data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (mapped_data == nullptr) return fail("could not map " + path);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail("could not open " + path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return fail("could not get the size of " + path);
+    }
+    if (static_cast<size_t>(st.st_size) < sizeof(WeightFileHeader)) {
+        ::close(fd);
+        return fail(path + " is too small to be a weight file");
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (data == MAP_FAILED) return fail("could not map " + path);
+    mapped_data = static_cast<const unsigned char*>(data);
+    mapped_size = static_cast<size_t>(st.st_size);
+    // the whole file gets read during the first forward pass anyway, so let the OS start early
+    madvise(data, mapped_size, MADV_WILLNEED);
+#endif
+
+    const WeightFileHeader& h = header();
+    if (std::memcmp(h.magic, WEIGHT_FILE_MAGIC, sizeof(h.magic)) != 0) return fail(path + " is not a Hyperion weight file");
+    if (h.version != WEIGHT_FILE_VERSION) {
+        return fail(path + " has weight file version " + std::to_string(h.version) +
+                    ", expected " + std::to_string(WEIGHT_FILE_VERSION));
+    }
+    if (h.header_size != sizeof(WeightFileHeader)) return fail(path + " has an unexpected header size");
+    if (h.body_offset % (WEIGHT_ALIGN_FLOATS * sizeof(float)) != 0) return fail(path + " has a misaligned body");
+    if (h.num_blocks > WEIGHT_FILE_MAX_BLOCKS || h.num_filters == 0 || h.num_filters > WEIGHT_FILE_MAX_FILTERS) {
+        return fail(path + " has an unsupported network shape");
+    }
+
+    file_shape.num_blocks = static_cast<int>(h.num_blocks);
+    file_shape.num_filters = static_cast<int>(h.num_filters);
+    file_shape.input_planes = static_cast<int>(h.input_planes);
+    file_shape.policy_size = static_cast<int>(h.policy_size);
+    if (file_shape.input_planes != NUM_INPUT_PLANES || file_shape.policy_size != POLICY_SIZE) {
+        return fail(path + " was exported for a different input/policy encoding");
+    }
+
+    const size_t expected_floats = weights_float_count(file_shape);
+    if (h.body_floats != expected_floats) return fail(path + " has the wrong amount of weights for its shape");
+    // written so that nothing can overflow, whatever the header says
+    if (h.body_offset > mapped_size || expected_floats > (mapped_size - h.body_offset) / sizeof(float)) {
+        return fail(path + " is truncated");
+    }
+
+    file_weights = map_weights(reinterpret_cast<const float*>(mapped_data + h.body_offset), file_shape);
+
+    if (h.flags & WEIGHT_FILE_HAS_ACTIVATION_RANGES) {
+        const size_t ranges_offset = h.body_offset + expected_floats * sizeof(float);
+        const size_t count = activation_range_count(file_shape);
+        if (count > (mapped_size - ranges_offset) / sizeof(float)) return fail(path + " has a truncated calibration section");
+        const float* ranges = reinterpret_cast<const float*>(mapped_data + ranges_offset);
+        file_activation_ranges.assign(ranges, ranges + count);
+    }
+    return true;
+}
+
+//--
+/* WeightFile::close */
+//--
+void WeightFile::close() {
+#ifdef _WIN32
+    if (mapped_data) UnmapViewOfFile(mapped_data);
+    if (mapping_handle) CloseHandle(static_cast<HANDLE>(mapping_handle));
+    if (file_handle) CloseHandle(static_cast<HANDLE>(file_handle));
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    if (mapped_data) munmap(const_cast<unsigned char*>(mapped_data), mapped_size);
+#endif
+    mapped_data = nullptr;
+    mapped_size = 0;
+    file_weights = NetworkWeights();
+    file_activation_ranges.clear();
+}
+
+//--
+/* save_weight_file */
+//--
+// Writes the header and every layer in the map_weights order, padding each tensor to WEIGHT_ALIGN_FLOATS
+bool save_weight_file(const std::string& path, const NetworkWeights& weights,
+                      const std::vector<float>& activation_ranges) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    const NetworkShape& s = weights.shape;
+    WeightFileHeader h{};
+    std::memcpy(h.magic, WEIGHT_FILE_MAGIC, sizeof(h.magic));
+    h.version = WEIGHT_FILE_VERSION;
+    h.header_size = sizeof(WeightFileHeader);
+    h.num_blocks = static_cast<uint32_t>(s.num_blocks);
+    h.num_filters = static_cast<uint32_t>(s.num_filters);
+    h.input_planes = static_cast<uint32_t>(s.input_planes);
+    h.policy_size = static_cast<uint32_t>(s.policy_size);
+    h.body_offset = sizeof(WeightFileHeader);
+    h.body_floats = weights_float_count(s);
+    if (!activation_ranges.empty()) {
+        if (activation_ranges.size() != activation_range_count(s)) return false;
+        h.flags |= WEIGHT_FILE_HAS_ACTIVATION_RANGES;
+    }
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    const std::vector<float> zeros(WEIGHT_ALIGN_FLOATS, 0.0f);
+    auto write_tensor = [&](const float* data, size_t count) {
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(float)));
+        const size_t padding = (WEIGHT_ALIGN_FLOATS - count % WEIGHT_ALIGN_FLOATS) % WEIGHT_ALIGN_FLOATS;
+        out.write(reinterpret_cast<const char*>(zeros.data()), static_cast<std::streamsize>(padding * sizeof(float)));
+    };
+    auto write_conv = [&](const ConvLayer& layer, size_t kernel_area) {
+        write_tensor(layer.weights, static_cast<size_t>(layer.out_channels) * layer.in_channels * kernel_area);
+        write_tensor(layer.bias, static_cast<size_t>(layer.out_channels));
+    };
+    auto write_dense = [&](const DenseLayer& layer) {
+        write_tensor(layer.weights, static_cast<size_t>(layer.out_features) * layer.in_features);
+        write_tensor(layer.bias, static_cast<size_t>(layer.out_features));
+    };
+
+    write_conv(weights.entry, 9);
+    for (const auto& block : weights.blocks) {
+        write_conv(block.conv1, 9);
+        write_conv(block.conv2, 9);
+    }
+    write_conv(weights.policy_conv, 1);
+    write_dense(weights.policy_fc);
+    write_conv(weights.value_conv, 1);
+    write_dense(weights.value_fc1);
+    write_dense(weights.value_fc2);
+    if (!activation_ranges.empty()) write_tensor(activation_ranges.data(), activation_ranges.size());
+
+    return static_cast<bool>(out);
+}
+
+} // namespace nn
+} // namespace hyperion
@@ -0,0 +1,98 @@
+#ifndef HYPERION_NN_WEIGHTS_FILE_HPP
+#define HYPERION_NN_WEIGHTS_FILE_HPP
+
+#include "nn_inference.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace hyperion {
+namespace nn {
+
+// --- Binary weight file format (written by hyperion_nn/training/export_weights.py) ---
+// 64 byte header followed by the float32 weights in the map_weights layout, BatchNorm already folded in
+// The body starts on a 64 byte boundary so the mapped file can be used directly, without copying anything
+constexpr char WEIGHT_FILE_MAGIC[8] = {'H', 'Y', 'P', 'N', 'N', 'W', 'T', 'S'};
+constexpr uint32_t WEIGHT_FILE_VERSION = 1;
+
+// Header flags for the optional sections that follow the body
+// HAS_ACTIVATION_RANGES: activation_range_count(shape) floats right after the body, the INT8 calibration
+// written by calibrate_int8.py
+constexpr uint32_t WEIGHT_FILE_HAS_ACTIVATION_RANGES = 1u << 0;
+
+// The largest network shape a weight file may declare, far above anything trained. The file comes from a user
+// setting, so a header outside these is rejected before the shape is used for any size
+constexpr uint32_t WEIGHT_FILE_MAX_BLOCKS = 128;
+constexpr uint32_t WEIGHT_FILE_MAX_FILTERS = 1024;
+
+struct WeightFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t num_blocks;
+    uint32_t num_filters;
+    uint32_t input_planes;
+    uint32_t policy_size;
+    uint64_t body_offset;   // in bytes, from the start of the file
+    uint64_t body_floats;   // has to equal weights_float_count(shape)
+    uint32_t flags;         // WEIGHT_FILE_HAS_* bits
+    uint32_t reserved[3];
+};
+static_assert(sizeof(WeightFileHeader) == 64, "WeightFileHeader has to match the 64 byte header written by export_weights.py");
+
+//--
+/* class WeightFile */
+//--
+// A weight file mapped read only into memory. The NetworkWeights it hands out point straight into the
+// mapping, so the WeightFile has to outlive every Network using them
+// Loading only validates the header, the pages themselves are read in by the OS the first time they are used
+class WeightFile {
+public:
+    WeightFile() = default;
+    ~WeightFile();
+
+    WeightFile(const WeightFile&) = delete;
+    WeightFile& operator=(const WeightFile&) = delete;
+
+    // Maps the file at path, returns false (see error()) if it can't be opened or isn't a valid weight file
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return mapped_data != nullptr; }
+    const std::string& error() const { return last_error; }
+
+    const WeightFileHeader& header() const { return *reinterpret_cast<const WeightFileHeader*>(mapped_data); }
+    const NetworkShape& shape() const { return file_shape; }
+
+    // Zero copy views of the weights in the mapping
+    const NetworkWeights& weights() const { return file_weights; }
+
+    // INT8 calibration stored in the file, empty if the file doesn't have any
+    const std::vector<float>& activation_ranges() const { return file_activation_ranges; }
+
+private:
+    const unsigned char* mapped_data = nullptr;
+    size_t mapped_size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+    NetworkShape file_shape;
+    NetworkWeights file_weights;
+    std::vector<float> file_activation_ranges;
+    std::string last_error;
+
+    bool fail(const std::string& message);
+};
+
+// Writes weights to path in the weight file format (the same bytes export_weights.py would write),
+// plus the INT8 activation ranges if there are any
+// Mostly useful for tests and for saving networks created in C++
+bool save_weight_file(const std::string& path, const NetworkWeights& weights,
+                      const std::vector<float>& activation_ranges = {});
+
+} // namespace nn
+} // namespace hyperion
+
+#endif // HYPERION_NN_WEIGHTS_FILE_HPP
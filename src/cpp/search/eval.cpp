@@ -1,25 +1,18 @@
 #include "eval.hpp"
+#include "pawn_hash.hpp"
 #include "../core/movegen.hpp"
 #include "../core/bitboard.hpp"
 #include "../core/constants.hpp"
 #include "../core/position.hpp"
 #include "../core/move.hpp"
-#include "search.hpp"
+#include <algorithm>
+#include <cmath>
 #include <vector>
-#include <random>
 
 namespace hyperion {
 namespace engine {
 
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-// For fun I Will add a temporary static evaluation to see how good I can make this. a lot of this will be refactored but hey, the source code is on github so who cares if I cange it
-// Static evaluation for fun:
-/*
-// --- Piece Values ---
+// --- Piece Values (centipawns) ---
 constexpr int PAWN_VALUE   = 100;
 constexpr int KNIGHT_VALUE = 320;
 constexpr int BISHOP_VALUE = 330;
@@ -64,7 +57,7 @@ const int* piece_square_tables[] = {
     queen_pst,
     king_pst
 };
-*/
+
 //--
 /* static_evaluate */
 //--
@@ -73,10 +66,11 @@ const int* piece_square_tables[] = {
 // on the board, it adds (for White) or subtracts (for Black) two values: the material
 // value of the piece (e.g., Queen = 900) and a positional bonus from a Piece-Square
 // Table (PST). The PST rewards pieces for being on strategically advantageous squares.
+// On top of that come the pawn structure terms (passed, isolated and doubled pawns) and the pawn shield
+// of a king still on its first two ranks, both read from the thread's pawn hash table.
 // The final score is returned from the perspective of the side to move, a common
 // practice in negamax-style search algorithms. This means a positive score is always
 // advantageous for the current player.
-/*
 double static_evaluate(const core::Position& pos) {
     int score = 0;
     
@@ -108,78 +102,116 @@ double static_evaluate(const core::Position& pos) {
         }
     }
 
+    // --- Pawn structure ---
+    const PawnEntry& pawns = thread_pawn_table().probe(pos);
+    score += pawns.score;
+    // the shield only counts for a king on its first two ranks, a position without a king (tests) has no shield
+    const core::square_e white_king = pos.get_king_square(WHITE);
+    const core::square_e black_king = pos.get_king_square(BLACK);
+    if (white_king != core::square_e::NO_SQ && static_cast<int>(white_king) / 8 <= 1) {
+        score += pawns.shield[WHITE][static_cast<int>(white_king) % 8];
+    }
+    if (black_king != core::square_e::NO_SQ && static_cast<int>(black_king) / 8 >= 6) {
+        score -= pawns.shield[BLACK][static_cast<int>(black_king) % 8];
+    }
+
     // Return score from the perspective of the side to move
     // If it's White's turn, a positive score is good for White.
     // If it's Black's turn, a positive score is good for White, so its bad for Black (-score).
     return (pos.get_side_to_move() == WHITE) ? static_cast<double>(score) : -static_cast<double>(score);
 }
-*/
+
+//--
+/* static_eval_value */
+//--
+// static_evaluate squashed into [-1, 1] for MCTS. tanh is a great function for this, the score is scaled
+// so that +/- 3 pawns is a near certain win/loss
+double static_eval_value(const core::Position& pos) {
+    return std::tanh(static_evaluate(pos) / (PAWN_VALUE * 3.0));
+}
+
+//--
+/* game_result */
+//--
+// Checks for the end of the game: no legal moves (checkmate or stalemate), the 50-move rule, a repetition
+// or insufficient material
+// Returns true and sets result (from the side to move's perspective) if the game is over
+bool game_result(const core::Position& pos, const std::vector<core::Move>& legal_moves, double& result) {
+    if (legal_moves.empty()) {
+        // the side to move is checkmated (a loss) or stalemated (a draw)
+        result = pos.is_in_check() ? -1.0 : 0.0;
+        return true;
+    }
+    if (pos.halfmove_clock >= 100 || pos.is_repetition() || pos.is_insufficient_material()) {
+        result = 0.0;
+        return true;
+    }
+    return false;
+}
+
 //--
 /* limited_depth_playout */
 //--
 // Simulates a short, random game (a "playout") from a given starting position to
-// quickly estimate the game's outcome. It plays a fixed number of pseudo-legal moves
-// (defined by `MAX_PLAYOUT_DEPTH`), selecting a move randomly at each step. This
-// simulation modifies a local copy of the `position` object. If the simulation
+// quickly estimate the game's outcome. It plays up to `max_plies` random legal moves.
+// This simulation modifies a local copy of the `position` object. If the simulation
 // encounters a checkmate, stalemate, or a draw by the 50-move rule, it returns
-// an immediate score (-1.0 for a loss, 0.0 for a draw). After the playout reaches
-// its depth limit, it calls `static_evaluate` on the final position. The result is
-// then normalized to a value between -1.0 and 1.0 using `std::tanh`, making it
-// suitable for use in a Monte Carlo Tree Search (MCTS) algorithm.
-/*
-double limited_depth_playout(core::Position position, std::mt19937& gen) {
+// an immediate score (+/-1.0 for a win/loss, 0.0 for a draw). After the playout reaches
+// its depth limit, the final position is scored with `static_eval_value`.
+// The result is from the perspective of the starting player, like random_playout
+double limited_depth_playout(core::Position position, Rng& gen, int max_plies) {
     core::MoveGenerator move_gen;
     std::vector<core::Move> move_list;
-    const int MAX_PLAYOUT_DEPTH = 20; // Simulate 20 moves (10 per side) deep
 
     // We need to know who the player was at the *start* of the simulation
     // to correctly interpret the final static evaluation score.
     int starting_player = position.get_side_to_move();
 
-    for (int depth = 0; depth < MAX_PLAYOUT_DEPTH; ++depth) {
+    for (int depth = 0; depth < max_plies; ++depth) {
         move_list.clear();
-        move_gen.generate_pseudo_legal_moves(position, move_list);
+        move_gen.generate_legal_moves(position, move_list);
 
-        if (move_list.empty()) {
-            // Checkmate is a huge loss for the current player
-            if (position.is_king_in_check(position.get_side_to_move())) {
-                 // The player whose turn it is got checkmated.
-                 // This is the worst possible outcome for them.
-                 return -1.0; 
-            } else {
-                // Stalemate is a draw.
-                return 0.0;
-            }
-        }
-        
-        if (position.halfmove_clock >= 100) {
-            return 0.0;
+        double result;
+        if (game_result(position, move_list, result)) {
+            return (position.get_side_to_move() == starting_player) ? result : -result;
         }
 
-        std::uniform_int_distribution<> distrib(0, move_list.size() - 1);
-        const core::Move& random_move = move_list[distrib(gen)];
+        const core::Move& random_move = move_list[gen.bounded(static_cast<uint32_t>(move_list.size()))];
         position.make_move(random_move);
     }
     
     // After the depth limit, do a static evaluation
-    double final_score = static_evaluate(position);
+    double final_score = static_eval_value(position);
     
-    // The static_evaluate function returns the score from the perspective of the side whose turn it is
+    // The static evaluation is from the perspective of the side whose turn it is
     // at the *end* of the playout. We need to flip it if the player has changed.
-    if (position.get_side_to_move() != starting_player) {
-        final_score = -final_score;
+    return (position.get_side_to_move() == starting_player) ? final_score : -final_score;
+}
+
+//--
+/* leaf_evaluator_name / parse_leaf_evaluator */
+//--
+// The names used by the UCI LeafEval option
+const char* leaf_evaluator_name(LeafEvaluatorKind kind) {
+    switch (kind) {
+        case LeafEvaluatorKind::RandomPlayout:    return "Playout";
+        case LeafEvaluatorKind::TruncatedPlayout: return "TruncatedPlayout";
+        case LeafEvaluatorKind::StaticEval:       return "StaticEval";
+        case LeafEvaluatorKind::Network:          return "NN";
     }
+    return "Playout";
+}
 
-    // Normalize the score to be between -1 and 1 for MCTS.
-    // tanh is a great function for this. We scale the score so that +/- 3 pawns is a near certain win/loss.
-    return std::tanh(final_score / (PAWN_VALUE * 3.0));
+bool parse_leaf_evaluator(const std::string& name, LeafEvaluatorKind& kind) {
+    for (LeafEvaluatorKind k : {LeafEvaluatorKind::RandomPlayout, LeafEvaluatorKind::TruncatedPlayout,
+                                LeafEvaluatorKind::StaticEval, LeafEvaluatorKind::Network}) {
+        if (name == leaf_evaluator_name(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
 }
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
 
 
 //--
@@ -187,11 +219,11 @@ double limited_depth_playout(core::Position position, std::mt19937& gen) {
 //--
 // Simulates a complete game from a given position by making random moves for both sides
 // This function is the core of the "simulation" phase in Monte Carlo Tree Searc, the point of this whole thing
-// The simulation ends when a terminal state (checkmate, stalemate, or 50-move rule draw) is reached
+// The simulation ends when a terminal state (checkmate, stalemate, or a draw) is reached
     //  position: The board state from which the random playout will begin. It is passed by value to avoid modifying the original
-    //  gen: A reference to a Mersenne Twister random number generator for selecting moves
+    //  gen: The search thread's random number generator, for selecting moves
     // The result of the game from the perspective of the starting player: 1.0 for a win, -1.0 for a loss, and 0.0 for a draw
-double random_playout(core::Position position, std::mt19937& gen) {
+double random_playout(core::Position position, Rng& gen) {
     core::MoveGenerator move_gen;
     std::vector<core::Move> move_list;
     // Store the side to move at the beginning of the playout to correctly evaluate the final score
@@ -199,6 +231,12 @@ double random_playout(core::Position position, std::mt19937& gen) {
 
     // The main game loop for the random simulation
     while (true) {
+        // --- Check for draws by repetition or insufficient material ---
+        // Done before generating moves, a position that repeats can't be checkmate (it wasn't the first time)
+        if (position.is_repetition() || position.is_insufficient_material()) {
+            return 0.0;
+        }
+
         move_list.clear();
         // Generate all legal moves for the current player
         move_gen.generate_legal_moves(position, move_list);
@@ -223,10 +261,8 @@ double random_playout(core::Position position, std::mt19937& gen) {
         }
 
         // --- Pick and play a random move ---
-        // Create a uniform distribution to select a random move index
-        std::uniform_int_distribution<> distrib(0, move_list.size() - 1);
         // Select a random move from the list of legal moves
-        const core::Move& random_move = move_list[distrib(gen)];
+        const core::Move& random_move = move_list[gen.bounded(static_cast<uint32_t>(move_list.size()))];
         // Apply the chosen move to the board to advance the position
         position.make_move(random_move);
     }
@@ -234,5 +270,37 @@ double random_playout(core::Position position, std::mt19937& gen) {
     return 0.0;
 }
 
+//--
+/* heuristic_priors */
+//--
+// Move priors for PUCT when there is no network: every move starts at the same logit, captures get a bonus
+// that grows with the captured piece and shrinks with the capturing one (MVV-LVA), queen promotions and castling
+// get a bonus and underpromotions a penalty. The logits are softmaxed, so the priors sum to 1
+void heuristic_priors(const core::Position& pos, const std::vector<core::Move>& moves, std::vector<float>& priors) {
+    (void)pos; // everything needed is in the moves for now
+    // in pawns, the king can't be captured and moving it doesn't cost anything
+    constexpr float piece_values[] = {1.0f, 3.0f, 3.0f, 5.0f, 9.0f, 0.0f};
+
+    priors.resize(moves.size());
+    if (moves.empty()) return;
+    float max_logit = -1e9f;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const core::Move& move = moves[i];
+        float logit = 0.0f;
+        if (move.is_capture()) {
+            const float victim = move.is_en_passant() ? piece_values[core::P_PAWN] : piece_values[move.piece_captured];
+            logit += 1.0f + 0.3f * victim - 0.05f * piece_values[move.piece_moved];
+        }
+        if (move.is_promotion()) logit += move.get_promotion_piece() == core::P_QUEEN ? 2.0f : -1.0f;
+        if (move.is_castling()) logit += 0.5f;
+        priors[i] = logit;
+        max_logit = std::max(max_logit, logit);
+    }
+
+    float sum = 0.0f;
+    for (auto& p : priors) sum += (p = std::exp(p - max_logit));
+    for (auto& p : priors) p /= sum;
+}
+
 } // namespace engine
 } // namespace hyperion
\ No newline at end of file
@@ -1,32 +1,70 @@
 #ifndef HYPERION_ENGINE_EVAL_HPP
 #define HYPERION_ENGINE_EVAL_HPP
-#include <random>
+#include <string>
+#include <vector>
 
 #include "../core/position.hpp"
+#include "../core/move.hpp"
+#include "../core/movegen.hpp"
+#include "rng.hpp"
 
 namespace hyperion {
 namespace engine {
 
-double random_playout(core::Position position, std::mt19937& gen);
+double random_playout(core::Position position, Rng& gen);
 
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-/*
-// satic evaluation function
+// static evaluation function (material + piece square tables), in centipawns for the side to move
 double static_evaluate(const core::Position& pos);
+// static_evaluate mapped to [-1, 1]
+double static_eval_value(const core::Position& pos);
+
+// Plays up to max_plies random legal moves, then evaluates statically
+constexpr int DEFAULT_PLAYOUT_PLIES = 20;
+double limited_depth_playout(core::Position position, Rng& gen, int max_plies = DEFAULT_PLAYOUT_PLIES);
+
+// True if the game is over (mate, stalemate, 50 move rule, repetition, insufficient material), with result from the side to move's perspective
+bool game_result(const core::Position& pos, const std::vector<core::Move>& legal_moves, double& result);
+
+// Cheap move priors for PUCT when no network is loaded, one per move, summing to 1
+void heuristic_priors(const core::Position& pos, const std::vector<core::Move>& moves, std::vector<float>& priors);
+
+//--
+/* Leaf evaluators */
+//--
+// How the search scores a new leaf. The search threads are templated on the evaluator struct, so the call in
+// the hot loop is resolved at compile time; the runtime choice (the UCI LeafEval option) is made once per search
+// Network doesn't have a struct here: its leaves go through the EvalQueue to a BatchEvaluator instead
+enum class LeafEvaluatorKind {
+    RandomPlayout,    // random legal moves until the game ends
+    TruncatedPlayout, // random legal moves for a few plies, then the static evaluation
+    StaticEval,       // the static evaluation of the leaf itself
+    Network           // the batch evaluator (the neural network)
+};
+
+const char* leaf_evaluator_name(LeafEvaluatorKind kind);
+bool parse_leaf_evaluator(const std::string& name, LeafEvaluatorKind& kind);
+
+// Every evaluator returns the value of pos for its side to move, in [-1, 1]
+struct RandomPlayoutEvaluator {
+    double evaluate(const core::Position& pos, Rng& gen) const { return random_playout(pos, gen); }
+};
+
+struct TruncatedPlayoutEvaluator {
+    int max_plies = DEFAULT_PLAYOUT_PLIES;
+    double evaluate(const core::Position& pos, Rng& gen) const { return limited_depth_playout(pos, gen, max_plies); }
+};
+
+struct StaticEvaluator {
+    double evaluate(const core::Position& pos, Rng&) const {
+        core::MoveGenerator move_gen;
+        std::vector<core::Move> legal_moves;
+        move_gen.generate_legal_moves(pos, legal_moves);
+        double result;
+        return game_result(pos, legal_moves, result) ? result : static_eval_value(pos);
+    }
+};
 
-// Simulates a limited number of pseudo-legal random moves, then evaluates.
-double limited_depth_playout(core::Position position, std::mt19937& gen);
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
 } // namespace engine
 } // namespace hyperion
 
-#endif // HYPERION_ENGINE_EVAL_HPP
\ No newline at end of file
+#endif // HYPERION_ENGINE_EVAL_HPP
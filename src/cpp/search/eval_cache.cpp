@@ -0,0 +1,138 @@
+#include "eval_cache.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace hyperion {
+namespace engine {
+
+static_assert(sizeof(EvalCacheEntry) == 128, "EvalCacheEntry should stay exactly two cache lines");
+static_assert((EVAL_CACHE_NUM_SHARDS & (EVAL_CACHE_NUM_SHARDS - 1)) == 0, "shard count must be a power of two");
+
+//--
+/* EvalCache::EvalCache */
+//--
+// Constructs the cache and allocates size_mb megabytes for it
+EvalCache::EvalCache(size_t size_mb) : shards(new Shard[EVAL_CACHE_NUM_SHARDS]) {
+    resize(size_mb);
+}
+
+//--
+/* EvalCache::resize */
+//--
+// Splits the memory budget evenly between the shards. Each shard gets the largest power of two
+// number of entries that fits, so the slot can be picked with a mask instead of a modulo
+// A budget of 0 MB still keeps one entry per shard so probe/store never have to check for an empty table
+void EvalCache::resize(size_t size_mb) {
+    size_t total_entries = (size_mb * 1024 * 1024) / sizeof(EvalCacheEntry);
+    size_t per_shard = std::max<size_t>(1, total_entries / EVAL_CACHE_NUM_SHARDS);
+
+    // round down to a power of two
+    size_t pow2 = 1;
+    while (pow2 * 2 <= per_shard) pow2 *= 2;
+
+    for (size_t i = 0; i < EVAL_CACHE_NUM_SHARDS; ++i) {
+        std::lock_guard<std::mutex> guard(shards[i].lock);
+        shards[i].entries.assign(pow2, EvalCacheEntry{});
+        shards[i].entries.shrink_to_fit();
+    }
+    entries_per_shard = pow2;
+    allocated_mb = size_mb;
+}
+
+//--
+/* EvalCache::clear */
+//--
+// Marks every entry as empty (key 0), the memory stays allocated
+void EvalCache::clear() {
+    for (size_t i = 0; i < EVAL_CACHE_NUM_SHARDS; ++i) {
+        std::lock_guard<std::mutex> guard(shards[i].lock);
+        std::fill(shards[i].entries.begin(), shards[i].entries.end(), EvalCacheEntry{});
+    }
+}
+
+//--
+/* EvalCache::hashfull */
+//--
+// Looks at the first entries of every shard, about a thousand in total. Keys are spread evenly over the slots,
+// so the start of the table fills up like the rest of it
+int EvalCache::hashfull() {
+    const size_t per_shard = std::min<size_t>(entries_per_shard, (1000 + EVAL_CACHE_NUM_SHARDS - 1) / EVAL_CACHE_NUM_SHARDS);
+    size_t used = 0;
+    for (size_t i = 0; i < EVAL_CACHE_NUM_SHARDS; ++i) {
+        std::lock_guard<std::mutex> guard(shards[i].lock);
+        for (size_t j = 0; j < per_shard; ++j) used += shards[i].entries[j].key != 0;
+    }
+    return static_cast<int>(used * 1000 / (per_shard * EVAL_CACHE_NUM_SHARDS));
+}
+
+//--
+/* EvalCache::probe */
+//--
+// Looks for the position in its slot. The full 64 bit key is compared so a different position
+// sharing the slot is a miss, not a wrong evaluation
+    //  key: Zobrist hash of the position (Position::current_hash)
+    //  value: set to the cached value on a hit
+    //  priors: resized and filled with the de-quantized priors on a hit
+    // true on a hit, false otherwise
+bool EvalCache::probe(uint64_t key, float& value, std::vector<float>& priors) {
+    lookup_count.fetch_add(1, std::memory_order_relaxed);
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    const EvalCacheEntry& entry = shard.entries[slot_for(key)];
+    if (entry.key != key || key == 0) {
+        return false;
+    }
+
+    value = entry.value;
+    priors.resize(entry.num_moves);
+    for (int i = 0; i < entry.num_moves; ++i) {
+        priors[i] = static_cast<float>(entry.priors[i]) * (1.0f / 65535.0f);
+    }
+    hit_count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+//--
+/* EvalCache::store */
+//--
+// Quantizes the priors to 16 bits and writes the entry into its slot (always-replace scheme)
+// Positions with more than EVAL_CACHE_MAX_MOVES legal moves are skipped
+void EvalCache::store(uint64_t key, float value, const std::vector<float>& priors) {
+    if (priors.size() > static_cast<size_t>(EVAL_CACHE_MAX_MOVES)) {
+        return;
+    }
+    EvalCacheEntry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.num_moves = static_cast<uint16_t>(priors.size());
+    for (size_t i = 0; i < priors.size(); ++i) {
+        float p = std::min(1.0f, std::max(0.0f, priors[i]));
+        entry.priors[i] = static_cast<uint16_t>(std::lround(p * 65535.0f));
+    }
+
+    Shard& shard = shard_for(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    shard.entries[slot_for(key)] = entry;
+}
+
+//--
+/* EvalCache::hit_rate */
+//--
+// Returns the percentage of probes that were hits since the last reset_stats()
+double EvalCache::hit_rate() const {
+    uint64_t total = lookups();
+    if (total == 0) return 0.0;
+    return 100.0 * static_cast<double>(hits()) / static_cast<double>(total);
+}
+
+//--
+/* EvalCache::reset_stats */
+//--
+// Zeroes the hit/lookup counters
+void EvalCache::reset_stats() {
+    hit_count.store(0, std::memory_order_relaxed);
+    lookup_count.store(0, std::memory_order_relaxed);
+}
+
+} // namespace engine
+} // namespace hyperion
@@ -0,0 +1,84 @@
+#ifndef HYPERION_ENGINE_EVAL_CACHE_HPP
+#define HYPERION_ENGINE_EVAL_CACHE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+namespace hyperion {
+namespace engine {
+
+// Default size of the evaluation cache in megabytes
+constexpr size_t DEFAULT_EVAL_CACHE_MB = 64;
+
+// Number of independently locked shards, so search threads rarely wait on each other
+constexpr size_t EVAL_CACHE_NUM_SHARDS = 64;
+
+// Max number of legal moves whose priors fit in one entry. Positions with more moves are just not cached (they are rare)
+constexpr int EVAL_CACHE_MAX_MOVES = 56;
+
+//--
+/* struct EvalCacheEntry */
+//--
+// One cached network evaluation (128 bytes, two cache lines)
+// The policy is "compressed" by only keeping the priors of the legal moves (in move generation order)
+// and quantizing each one to 16 bits, instead of storing the whole 4672 float policy head
+struct EvalCacheEntry {
+    uint64_t key = 0;         // Full Zobrist hash of the position, 0 means the slot is empty
+    float value = 0.0f;       // Value from the perspective of the side to move
+    uint16_t num_moves = 0;   // How many entries of priors are used
+    uint16_t padding = 0;
+    uint16_t priors[EVAL_CACHE_MAX_MOVES] = {}; // Prior * 65535, same order as generate_legal_moves
+};
+
+class EvalCache {
+public:
+    explicit EvalCache(size_t size_mb = DEFAULT_EVAL_CACHE_MB);
+
+    // Reallocates the cache to use (roughly) size_mb megabytes, this also clears it
+    void resize(size_t size_mb);
+
+    // Empties every entry, the hit counters are left alone
+    void clear();
+
+    // Looks up a position. On a hit, value and priors are filled in and true is returned
+    bool probe(uint64_t key, float& value, std::vector<float>& priors);
+
+    // Stores an evaluation, always replacing whatever was in the slot before
+    void store(uint64_t key, float value, const std::vector<float>& priors);
+
+    // --- Statistics (for the info output) ---
+    uint64_t hits() const { return hit_count.load(std::memory_order_relaxed); }
+    uint64_t lookups() const { return lookup_count.load(std::memory_order_relaxed); }
+    double hit_rate() const; // in percent
+    void reset_stats();
+    // Used entries per mille, from a sample of the table (UCI hashfull)
+    int hashfull();
+
+    size_t size_mb() const { return allocated_mb; }
+    size_t num_entries() const { return entries_per_shard * EVAL_CACHE_NUM_SHARDS; }
+
+private:
+    struct Shard {
+        std::mutex lock;
+        std::vector<EvalCacheEntry> entries;
+    };
+
+    Shard& shard_for(uint64_t key) { return shards[key >> 58]; } // top 6 bits pick the shard
+    size_t slot_for(uint64_t key) const { return static_cast<size_t>(key) & (entries_per_shard - 1); }
+
+    std::unique_ptr<Shard[]> shards;
+    size_t entries_per_shard = 0; // always a power of two
+    size_t allocated_mb = 0;
+
+    std::atomic<uint64_t> hit_count{0};
+    std::atomic<uint64_t> lookup_count{0};
+};
+
+} // namespace engine
+} // namespace hyperion
+
+#endif // HYPERION_ENGINE_EVAL_CACHE_HPP
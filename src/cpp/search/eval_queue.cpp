@@ -0,0 +1,157 @@
+#include "eval_queue.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace hyperion {
+namespace engine {
+
+//--
+/* EvalQueue::EvalQueue */
+//--
+EvalQueue::EvalQueue(BatchEvaluator& evaluator, const EvalQueueConfig& config)
+    : evaluator(evaluator), queue_config(config) {
+    queue_config.max_batch_size = std::max(1, queue_config.max_batch_size);
+    queue_config.max_wait_us = std::max(0, queue_config.max_wait_us);
+    worker = std::thread(&EvalQueue::evaluator_loop, this);
+}
+
+//--
+/* EvalQueue::~EvalQueue */
+//--
+EvalQueue::~EvalQueue() {
+    {
+        std::lock_guard<std::mutex> guard(queue_lock);
+        stopping = true;
+    }
+    queue_ready.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+int EvalQueue::register_client() {
+    std::lock_guard<std::mutex> guard(clients_lock);
+    if (!free_clients.empty()) {
+        const int client = free_clients.back();
+        free_clients.pop_back();
+        return client;
+    }
+    clients.push_back(std::make_unique<Client>());
+    return static_cast<int>(clients.size()) - 1;
+}
+
+void EvalQueue::release_client(int client) {
+    std::lock_guard<std::mutex> guard(clients_lock);
+    free_clients.push_back(client);
+}
+
+EvalQueue::Client& EvalQueue::client_at(int client) {
+    std::lock_guard<std::mutex> guard(clients_lock);
+    return *clients[client];
+}
+
+//--
+/* EvalQueue::submit */
+//--
+void EvalQueue::submit(int client, const core::Position& pos, void* user_data) {
+    bool first, batch_full;
+    {
+        std::lock_guard<std::mutex> guard(queue_lock);
+        first = pending.empty();
+        pending.push_back(Request{pos, user_data, client, std::chrono::steady_clock::now()});
+        batch_full = static_cast<int>(pending.size()) >= queue_config.max_batch_size;
+    }
+    // the evaluator only needs waking for the first position of a batch or when the batch is full,
+    // otherwise it's already sleeping until the wait time is up
+    if (first || batch_full) queue_ready.notify_one();
+}
+
+//--
+/* EvalQueue::poll */
+//--
+size_t EvalQueue::poll(int client, std::vector<Completion>& out) {
+    Client& c = client_at(client);
+    std::lock_guard<std::mutex> guard(c.lock);
+    const size_t count = c.completed.size();
+    std::move(c.completed.begin(), c.completed.end(), std::back_inserter(out));
+    c.completed.clear();
+    return count;
+}
+
+//--
+/* EvalQueue::wait */
+//--
+size_t EvalQueue::wait(int client, std::vector<Completion>& out, std::chrono::microseconds timeout) {
+    Client& c = client_at(client);
+    {
+        std::unique_lock<std::mutex> guard(c.lock);
+        if (!c.completed.empty()) {
+            guard.unlock();
+            return poll(client, out);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(queue_lock);
+        flush_requested = true;
+    }
+    queue_ready.notify_one();
+
+    {
+        std::unique_lock<std::mutex> guard(c.lock);
+        c.ready.wait_for(guard, timeout, [&] { return !c.completed.empty(); });
+    }
+    return poll(client, out);
+}
+
+double EvalQueue::average_batch_size() const {
+    const uint64_t b = batches();
+    return b == 0 ? 0.0 : static_cast<double>(evaluations()) / static_cast<double>(b);
+}
+
+//--
+/* EvalQueue::evaluator_loop */
+//--
+// Sleeps until something is queued, then waits until either max_batch_size positions are waiting,
+// the first one has waited max_wait_us, or a client is blocked waiting. Then it evaluates one batch
+// and hands every result to the client that submitted it
+void EvalQueue::evaluator_loop() {
+    std::vector<core::Position> positions;
+    std::vector<LeafEvaluation> results;
+    std::vector<Request> batch;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(queue_lock);
+            queue_ready.wait(guard, [&] { return stopping || !pending.empty(); });
+            if (pending.empty()) return; // stopping, and everything has been evaluated
+
+            const auto deadline = pending.front().submitted + std::chrono::microseconds(queue_config.max_wait_us);
+            queue_ready.wait_until(guard, deadline, [&] {
+                return stopping || flush_requested || static_cast<int>(pending.size()) >= queue_config.max_batch_size;
+            });
+            flush_requested = false;
+
+            const size_t count = std::min(pending.size(), static_cast<size_t>(queue_config.max_batch_size));
+            batch.assign(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.begin() + count));
+            pending.erase(pending.begin(), pending.begin() + count);
+        }
+
+        positions.clear();
+        for (const auto& request : batch) positions.push_back(request.position);
+        results.assign(batch.size(), LeafEvaluation());
+        evaluator.evaluate_batch(positions.data(), static_cast<int>(positions.size()), results.data());
+
+        batch_count.fetch_add(1, std::memory_order_relaxed);
+        evaluation_count.fetch_add(batch.size(), std::memory_order_relaxed);
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            Client& c = client_at(batch[i].client);
+            {
+                std::lock_guard<std::mutex> guard(c.lock);
+                c.completed.push_back(Completion{batch[i].user_data, std::move(results[i])});
+            }
+            c.ready.notify_one();
+        }
+    }
+}
+
+} // namespace engine
+} // namespace hyperion
@@ -0,0 +1,131 @@
+#ifndef HYPERION_ENGINE_EVAL_QUEUE_HPP
+#define HYPERION_ENGINE_EVAL_QUEUE_HPP
+
+#include "../core/position.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hyperion {
+namespace engine {
+
+class EvalCache;
+
+//--
+/* struct LeafEvaluation */
+//--
+// What a batch evaluator returns for one leaf position
+struct LeafEvaluation {
+    float value = 0.0f;         // from the side to move's point of view, in [-1, 1]
+    std::vector<float> priors;  // optional move priors, one per legal move in MoveGenerator order
+    bool cached = false;        // answered from the evaluator's cache, for the search's statistics
+};
+
+//--
+/* class BatchEvaluator */
+//--
+// Anything that evaluates many positions at once (the neural network, mostly)
+// evaluate_batch is only ever called from the EvalQueue's evaluator thread, so it doesn't have to be thread safe
+class BatchEvaluator {
+public:
+    virtual ~BatchEvaluator() = default;
+    virtual void evaluate_batch(const core::Position* positions, int count, LeafEvaluation* results) = 0;
+    // The cache the evaluator answers from, nullptr if it has none. The search reports its hashfull
+    virtual EvalCache* get_cache() { return nullptr; }
+};
+
+struct EvalQueueConfig {
+    int max_batch_size = 32;    // B: a batch is sent as soon as this many positions are waiting
+    int max_wait_us = 500;      // T: or when the oldest waiting position has waited this long
+};
+
+//--
+/* class EvalQueue */
+//--
+// Batches leaf evaluations from the search threads for one dedicated evaluator thread
+// A search thread registers as a client, submits leaves without blocking (with an opaque pointer, the search
+// uses the leaf Node*) and later collects the finished evaluations of its own leaves with poll() or wait()
+class EvalQueue {
+public:
+    struct Completion {
+        void* user_data = nullptr;
+        LeafEvaluation result;
+    };
+
+    // Starts the evaluator thread. The evaluator has to outlive the queue
+    EvalQueue(BatchEvaluator& evaluator, const EvalQueueConfig& config);
+    // Finishes whatever is still queued, then stops the evaluator thread
+    ~EvalQueue();
+
+    EvalQueue(const EvalQueue&) = delete;
+    EvalQueue& operator=(const EvalQueue&) = delete;
+
+    // Gives a search thread its own completion queue. Returns the client id to use below
+    int register_client();
+    // Gives the id back once every submitted position of the client has been collected, a later register_client
+    // reuses it. A queue shared by many searches (the multi-session host) doesn't grow with every search
+    void release_client(int client);
+
+    // Queues a position for evaluation, never blocks
+    void submit(int client, const core::Position& pos, void* user_data);
+
+    // Moves the finished evaluations of this client into out, returns how many were added. Never blocks
+    size_t poll(int client, std::vector<Completion>& out);
+
+    // Like poll, but waits up to timeout for at least one evaluation to finish
+    // A waiting client has nothing else to do, so the current partial batch is sent right away
+    size_t wait(int client, std::vector<Completion>& out, std::chrono::microseconds timeout);
+
+    // --- Statistics ---
+    uint64_t batches() const { return batch_count.load(std::memory_order_relaxed); }
+    uint64_t evaluations() const { return evaluation_count.load(std::memory_order_relaxed); }
+    double average_batch_size() const;
+    const EvalQueueConfig& config() const { return queue_config; }
+    BatchEvaluator& get_evaluator() { return evaluator; }
+
+private:
+    struct Request {
+        core::Position position;
+        void* user_data;
+        int client;
+        std::chrono::steady_clock::time_point submitted;
+    };
+    struct Client {
+        std::mutex lock;
+        std::condition_variable ready;
+        std::vector<Completion> completed;
+    };
+
+    BatchEvaluator& evaluator;
+    EvalQueueConfig queue_config;
+
+    std::mutex queue_lock;
+    std::condition_variable queue_ready;
+    std::deque<Request> pending;
+    bool flush_requested = false;
+    bool stopping = false;
+
+    std::mutex clients_lock; // only guards adding and releasing clients, the Client objects themselves never move
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<int> free_clients;
+
+    std::atomic<uint64_t> batch_count{0};
+    std::atomic<uint64_t> evaluation_count{0};
+
+    std::thread worker;
+
+    void evaluator_loop();
+    Client& client_at(int client);
+};
+
+} // namespace engine
+} // namespace hyperion
+
+#endif // HYPERION_ENGINE_EVAL_QUEUE_HPP
@@ -0,0 +1,89 @@
+#include "nn_evaluator.hpp"
+#include "../nn_inference/encoder.hpp"
+#include "../nn_inference/policy_map.hpp"
+
+namespace hyperion {
+namespace engine {
+
+//--
+/* NetworkEvaluator::load */
+//--
+bool NetworkEvaluator::load(const std::string& path) {
+    auto file = std::make_unique<nn::WeightFile>();
+    if (!file->open(path)) {
+        last_error = file->error();
+        return false;
+    }
+    // the network points into the mapping, so the old file can only go once the new weights are set
+    network.set_weights(file->weights());
+    if (!file->activation_ranges().empty()) network.set_activation_ranges(file->activation_ranges());
+    weight_file = std::move(file);
+    cache.clear(); // the cached evaluations came from the old network
+    last_error.clear();
+    // new weights start in FP32, a file without calibration still loads (error() says it's in FP32)
+    apply_precision();
+    return true;
+}
+
+//--
+/* NetworkEvaluator::set_precision */
+//--
+bool NetworkEvaluator::set_precision(nn::Precision precision) {
+    wanted_precision = precision;
+    last_error.clear();
+    return apply_precision();
+}
+
+bool NetworkEvaluator::apply_precision() {
+    if (!network.is_loaded()) return true; // applied by load
+    const nn::Precision before = network.precision();
+    const bool applied = network.set_precision(wanted_precision);
+    if (!applied) last_error = "the network has no INT8 calibration, using FP32";
+    if (network.precision() != before) cache.clear();
+    return applied;
+}
+
+//--
+/* NetworkEvaluator::init_random */
+//--
+void NetworkEvaluator::init_random(const nn::NetworkShape& shape, uint32_t seed) {
+    network.init_random(shape, seed);
+    cache.clear();
+    apply_precision();
+}
+
+//--
+/* NetworkEvaluator::evaluate_batch */
+//--
+void NetworkEvaluator::evaluate_batch(const core::Position* positions, int count, LeafEvaluation* results) {
+    misses.clear();
+    for (int i = 0; i < count; ++i) {
+        results[i].cached = cache.probe(positions[i].current_hash, results[i].value, results[i].priors);
+        if (results[i].cached) continue;
+        misses.push_back(i);
+    }
+    if (misses.empty()) return;
+
+    const int batch = static_cast<int>(misses.size());
+    input.resize(static_cast<size_t>(batch) * nn::INPUT_FLOATS);
+    policy.resize(static_cast<size_t>(batch) * nn::POLICY_SIZE);
+    values.resize(batch);
+    for (int k = 0; k < batch; ++k) {
+        nn::encode_position(positions[misses[k]], input.data() + static_cast<size_t>(k) * nn::INPUT_FLOATS);
+    }
+    network.forward(input.data(), batch, policy.data(), values.data());
+
+    for (int k = 0; k < batch; ++k) {
+        const core::Position& pos = positions[misses[k]];
+        LeafEvaluation& result = results[misses[k]];
+        legal_moves.clear();
+        move_gen.generate_legal_moves(pos, legal_moves);
+        nn::legal_move_priors(policy.data() + static_cast<size_t>(k) * nn::POLICY_SIZE, legal_moves, pos.side_to_move,
+                              result.priors);
+        result.value = values[k];
+        cache.store(pos.current_hash, result.value, result.priors);
+    }
+}
+
+} // namespace engine
+} // namespace hyperion
@@ -0,0 +1,67 @@
+#ifndef HYPERION_ENGINE_NN_EVALUATOR_HPP
+#define HYPERION_ENGINE_NN_EVALUATOR_HPP
+
+#include "eval_queue.hpp"
+#include "eval_cache.hpp"
+#include "../core/movegen.hpp"
+#include "../nn_inference/nn_inference.hpp"
+#include "../nn_inference/weights_file.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hyperion {
+namespace engine {
+
+//--
+/* class NetworkEvaluator */
+//--
+// The BatchEvaluator behind LeafEvaluatorKind::Network: encodes the positions straight from their bitboards,
+// runs them through the network in one batch and turns the policy into priors over the legal moves
+// It owns the evaluation cache: positions found in it skip the network, and a search using the evaluator
+// reports the cache through get_cache
+class NetworkEvaluator : public BatchEvaluator {
+public:
+    // cache_mb: the evaluation cache, the UCI Hash option
+    explicit NetworkEvaluator(size_t cache_mb = DEFAULT_EVAL_CACHE_MB) : cache(cache_mb) {}
+
+    // Maps a weight file written by export_weights.py. On failure the previous network is kept and error() says why
+    bool load(const std::string& path);
+    // Random weights, for tests and benchmarks
+    void init_random(const nn::NetworkShape& shape, uint32_t seed);
+
+    // FP32, or INT8 with the activation ranges stored in the weight file (calibrate_int8.py). The choice is kept
+    // for the networks loaded later. False, with error(), when the loaded network has no calibration: it stays in
+    // FP32 then. A change of precision clears the cache, its evaluations came from the other one
+    bool set_precision(nn::Precision precision);
+    nn::Precision get_precision() const { return network.precision(); }
+
+    bool is_loaded() const { return network.is_loaded(); }
+    const std::string& error() const { return last_error; }
+    nn::Network& get_network() { return network; }
+
+    void evaluate_batch(const core::Position* positions, int count, LeafEvaluation* results) override;
+    EvalCache* get_cache() override { return &cache; }
+
+private:
+    std::unique_ptr<nn::WeightFile> weight_file; // the network's weights point into this mapping
+    nn::Network network;
+    EvalCache cache; // kept between searches, positions repeat from move to move
+    nn::Precision wanted_precision = nn::Precision::FP32;
+    std::string last_error;
+
+    // Puts the network in wanted_precision, see set_precision
+    bool apply_precision();
+
+    // scratch, only used from the evaluator thread
+    core::MoveGenerator move_gen;
+    std::vector<core::Move> legal_moves;
+    std::vector<int> misses;
+    std::vector<float> input, policy, values;
+};
+
+} // namespace engine
+} // namespace hyperion
+
+#endif // HYPERION_ENGINE_NN_EVALUATOR_HPP
@@ -0,0 +1,116 @@
+#include "pawn_hash.hpp"
+#include "../core/constants.hpp"
+#include <algorithm>
+
+namespace hyperion {
+namespace engine {
+
+using core::bitboard_t;
+using core::WHITE;
+using core::BLACK;
+
+// --- Pawn structure terms (centipawns) ---
+constexpr int PASSED_PAWN_BONUS[8] = {0, 5, 10, 20, 35, 60, 100, 0}; // by rank, counted from the pawn's own side
+constexpr int ISOLATED_PAWN_PENALTY = 15;
+constexpr int DOUBLED_PAWN_PENALTY = 10;
+constexpr int SHIELD_NEAR_BONUS = 10; // a pawn right in front of the king's rank
+constexpr int SHIELD_FAR_BONUS = 5;   // one rank further up
+
+static inline bitboard_t north_fill(bitboard_t b) {
+    b |= b << 8;
+    b |= b << 16;
+    return b | (b << 32);
+}
+
+static inline bitboard_t south_fill(bitboard_t b) {
+    b |= b >> 8;
+    b |= b >> 16;
+    return b | (b >> 32);
+}
+
+// The files next to the set bits, without wrapping around the board
+static inline bitboard_t adjacent_files(bitboard_t b) {
+    return ((b & core::NOT_FILE_H_BB) << 1) | ((b & core::NOT_FILE_A_BB) >> 1);
+}
+
+//--
+/* analyze_pawns */
+//--
+// Everything is done with fills over whole bitboards, one pass per color:
+//   front span: the squares in front of every pawn (north fill of the pawns moved one rank up, for white)
+//   passed: not inside the enemy's front span or the files next to it
+//   doubled: inside the own front span, so some friendly pawn is behind it
+//   isolated: no friendly pawn anywhere on the adjacent files
+void analyze_pawns(const core::Position& pos, PawnEntry& entry) {
+    const bitboard_t pawns[2] = {pos.get_pieces(core::P_PAWN, WHITE), pos.get_pieces(core::P_PAWN, BLACK)};
+    const bitboard_t front_span[2] = {north_fill(pawns[WHITE] << 8), south_fill(pawns[BLACK] >> 8)};
+
+    entry.key = pos.pawn_hash;
+    int score = 0;
+    for (int color = WHITE; color <= BLACK; ++color) {
+        const int enemy = color ^ 1;
+        const bitboard_t own = pawns[color];
+        const bitboard_t files = north_fill(own) | south_fill(own);
+
+        entry.passed[color] = own & ~(front_span[enemy] | adjacent_files(front_span[enemy]));
+        entry.doubled[color] = own & front_span[color];
+        entry.isolated[color] = own & ~adjacent_files(files);
+
+        int color_score = -ISOLATED_PAWN_PENALTY * core::count_set_bits(entry.isolated[color])
+                          - DOUBLED_PAWN_PENALTY * core::count_set_bits(entry.doubled[color]);
+        bitboard_t passed = entry.passed[color];
+        while (passed) {
+            const int rank = core::pop_lsb(passed) / 8;
+            color_score += PASSED_PAWN_BONUS[color == WHITE ? rank : 7 - rank];
+        }
+        score += color == WHITE ? color_score : -color_score;
+
+        // the two ranks in front of the king's first rank, near one first
+        const bitboard_t near_rank = color == WHITE ? core::RANK_2_BB : core::RANK_7_BB;
+        const bitboard_t far_rank = color == WHITE ? core::RANK_3_BB : core::RANK_6_BB;
+        for (int file = 0; file < 8; ++file) {
+            const bitboard_t king_file = core::FILE_A_BB << file;
+            const bitboard_t shield_files = king_file | adjacent_files(king_file);
+            entry.shield[color][file] = static_cast<int8_t>(SHIELD_NEAR_BONUS * core::count_set_bits(own & shield_files & near_rank) +
+                                                            SHIELD_FAR_BONUS * core::count_set_bits(own & shield_files & far_rank));
+        }
+    }
+    entry.score = static_cast<int16_t>(score);
+}
+
+//--
+/* PawnHashTable */
+//--
+PawnHashTable::PawnHashTable(size_t num_entries) {
+    size_t size = 1;
+    while (size * 2 <= num_entries) size *= 2;
+    entries.resize(size);
+    mask = size - 1;
+}
+
+const PawnEntry& PawnHashTable::probe(const core::Position& pos) {
+    PawnEntry& entry = entries[pos.pawn_hash & mask];
+    lookup_count++;
+    if (entry.key == pos.pawn_hash) {
+        hit_count++;
+    } else {
+        analyze_pawns(pos, entry);
+    }
+    return entry;
+}
+
+void PawnHashTable::clear() {
+    std::fill(entries.begin(), entries.end(), PawnEntry());
+}
+
+//--
+/* thread_pawn_table */
+//--
+// thread_local: the table is created the first time a thread evaluates and lives as long as the thread
+PawnHashTable& thread_pawn_table() {
+    thread_local PawnHashTable table;
+    return table;
+}
+
+} // namespace engine
+} // namespace hyperion
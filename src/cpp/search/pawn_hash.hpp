@@ -0,0 +1,68 @@
+#ifndef HYPERION_ENGINE_PAWN_HASH_HPP
+#define HYPERION_ENGINE_PAWN_HASH_HPP
+
+#include "../core/bitboard.hpp"
+#include "../core/position.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hyperion {
+namespace engine {
+
+// Default number of entries in a pawn hash table (a power of two), 80 bytes each
+constexpr size_t DEFAULT_PAWN_HASH_ENTRIES = 1 << 14;
+
+//--
+/* struct PawnEntry */
+//--
+// Everything the evaluation needs that depends only on where the pawns are, indexed [color]
+// The pawn shield depends on the king too, so it's stored for a king on each file and picked at evaluation time
+struct PawnEntry {
+    core::zobrist_key_t key = 0; // Position::pawn_hash. A position without pawns has key 0, and an empty entry
+                                 // (all zeros) is exactly its analysis, so empty slots never need a special case
+    core::bitboard_t passed[2] = {};   // no enemy pawn in front on the same or an adjacent file
+    core::bitboard_t isolated[2] = {}; // no friendly pawn on an adjacent file
+    core::bitboard_t doubled[2] = {};  // a friendly pawn behind on the same file
+    int16_t score = 0;                 // the pawn structure terms above in centipawns, from white's point of view
+    int8_t shield[2][8] = {};          // pawn shield bonus for a king on file f on its first two ranks
+};
+
+//--
+/* class PawnHashTable */
+//--
+// Caches analyze_pawns per pawn configuration. Pawns move rarely, so the positions of a search tree share only a
+// few pawn structures and almost every probe is a hit
+// Not thread safe: every search thread uses its own table (see thread_pawn_table), so probing needs no lock
+class PawnHashTable {
+public:
+    explicit PawnHashTable(size_t num_entries = DEFAULT_PAWN_HASH_ENTRIES);
+
+    // The entry for pos's pawns, analyzed first if it isn't in the table
+    const PawnEntry& probe(const core::Position& pos);
+
+    void clear();
+
+    uint64_t hits() const { return hit_count; }
+    uint64_t lookups() const { return lookup_count; }
+    double hit_rate() const { return lookup_count ? 100.0 * hit_count / lookup_count : 0.0; } // in percent
+    void reset_stats() { hit_count = lookup_count = 0; }
+
+private:
+    std::vector<PawnEntry> entries;
+    size_t mask;
+    uint64_t hit_count = 0;
+    uint64_t lookup_count = 0;
+};
+
+// Computes a PawnEntry from scratch, the slow path behind PawnHashTable::probe
+void analyze_pawns(const core::Position& pos, PawnEntry& entry);
+
+// The calling thread's pawn hash table, used by static_evaluate
+PawnHashTable& thread_pawn_table();
+
+} // namespace engine
+} // namespace hyperion
+
+#endif // HYPERION_ENGINE_PAWN_HASH_HPP
@@ -0,0 +1,81 @@
+#ifndef HYPERION_ENGINE_RNG_HPP
+#define HYPERION_ENGINE_RNG_HPP
+
+#include <cstdint>
+#include <limits>
+
+namespace hyperion {
+namespace engine {
+
+//--
+/* splitmix64 */
+//--
+// Turns a counter or seed into a well mixed 64 bit value, used to fill the generator's state
+// (xoshiro must not start from all zeros, and close seeds must not give close sequences)
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//--
+/* class Rng */
+//--
+// xoshiro256** (Blackman & Vigna): 32 bytes of state and a handful of shifts/rotates per number,
+// against mt19937's 2.5 KB. Every search thread owns one, so nothing is shared
+// It is a UniformRandomBitGenerator, so it still works with the <random> distributions where speed doesn't matter
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    explicit Rng(uint64_t seed = 0) { seed_with(seed); }
+
+    void seed_with(uint64_t seed) {
+        for (auto& word : state) word = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, range), without the bias of x % range (Lemire, "Fast Random Integer Generation in an Interval")
+    // The 32x32 -> 64 bit multiply maps x onto [0, range) and the rare retry only happens for the low part that
+    // would make some values one count more likely. range must be > 0
+    uint32_t bounded(uint32_t range) {
+        uint64_t m = static_cast<uint64_t>(next32()) * range;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < range) {
+            const uint32_t threshold = static_cast<uint32_t>(-range) % range;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(next32()) * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+private:
+    uint64_t state[4];
+
+    // the high bits are the best ones
+    uint32_t next32() { return static_cast<uint32_t>((*this)() >> 32); }
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+} // namespace engine
+} // namespace hyperion
+
+#endif // HYPERION_ENGINE_RNG_HPP
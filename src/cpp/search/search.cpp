@@ -1,32 +1,45 @@
 #include "search.hpp"
 #include "eval.hpp"
 #include "../core/movegen.hpp"
+#include "../core/bitboard.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <limits>
+#include <random>
 #include <iostream>
+#include <thread>
 
 namespace hyperion { 
 namespace engine {
 
-// Ive included both the tracitional MCTS and a hand crafted evalutation MCTS. THe handcrafted evaluation is a side project, but it is effective at seeing
-// what a traditional nn-mcts would get. I did include the handcrafted evaluation below. You much just comment / uncomment everything shown below
-
-// UCT exploration constant. Higher values favor exploring lessvisited nodes
-constexpr double UCT_C = 1.414; // sqrt(2)
-// constexpr double UCT_C = 3.14; // pi
-// you kinda just need to try around these values and see what works
-// to be honest ive changed this number so much and it is SUPPOSED to do something, but doesnt really do much :/
-// possible bug maybe?
-// constexpr double UCT_C = .6; // number I pulled out of my ass
+// The leaf evaluation (random playouts, truncated playouts + the hand crafted evaluation, the static evaluation alone,
+// or the network) is picked at runtime with set_leaf_evaluator, see eval.hpp
 
+// How often the time manager looks at the root
+constexpr std::chrono::milliseconds TIME_CHECK_INTERVAL(5);
+// The centipawn score shown for a Q that isn't a proven result stays below this
+constexpr int MAX_SCORE_CP = 10000;
 
 //--
 /* Search::Search */
 //--
 // Constructs a Search object, initializing the random number generator
 // The random generator is used for the simulation (playout) phase of MCTS
-Search::Search() : random_generator(std::random_device{}()) {
+Search::Search() {
+    set_seed(0);
+}
+
+//--
+/* Search::set_seed */
+//--
+void Search::set_seed(uint64_t seed) {
+    master_seed = seed;
+    if (seed == 0) {
+        std::random_device device;
+        seed = (static_cast<uint64_t>(device()) << 32) | device();
+    }
+    random_generator.seed_with(seed);
 }
 
 
@@ -39,112 +52,549 @@ Search::Search() : random_generator(std::random_device{}()) {
     //  time_limit_ms: The maximum time in milliseconds to run the search
     // The best core::Move found for the root_pos
 core::Move Search::find_best_move(core::Position& root_pos, int time_limit_ms) {
+    SearchLimits search_limits;
+    search_limits.time.soft_ms = search_limits.time.hard_ms = time_limit_ms;
+    return find_best_move(root_pos, search_limits);
+}
+
+core::Move Search::find_best_move(core::Position& root_pos, const SearchLimits& search_limits) {
+    clear_stop();
+    set_limits(search_limits);
+    return run(root_pos);
+}
+
+//--
+/* Search::set_limits */
+//--
+// A mate search without any other limit gets mate * MATE_TIME_PER_MOVE_MS, it can't count on the root being proven
+void Search::set_limits(const SearchLimits& search_limits) {
+    limits = search_limits;
+    if (limits.mate > 0 && limits.nodes <= 0 && limits.depth <= 0 && !limits.time.is_limited()) {
+        limits.time.soft_ms = limits.time.hard_ms = limits.mate * MATE_TIME_PER_MOVE_MS;
+    }
+    set_time_limits(limits.infinite ? TimeLimits() : limits.time);
+}
+
+//--
+/* Search::set_time_limit */
+//--
+// Stored as an atomic tick count, so a running search picks up the new deadline (UCI ponderhit)
+void Search::set_time_limit(int time_limit_ms) {
+    TimeLimits limits;
+    limits.soft_ms = limits.hard_ms = time_limit_ms;
+    set_time_limits(limits);
+}
+
+//--
+/* Search::set_time_limits */
+//--
+// The hard limit is the deadline every thread checks, the soft one is up to the time manager (check_time)
+void Search::set_time_limits(const TimeLimits& limits) {
+    const Clock::time_point now = Clock::now();
+    const Clock::time_point deadline = limits.is_limited() ? now + std::chrono::milliseconds(limits.hard_ms)
+                                                           : Clock::time_point::max();
+    std::lock_guard<std::mutex> guard(tree_mutex);
+    time_manager.start(limits, now);
+    time_up = false;
+    deadline_ticks.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+//--
+/* Search::should_stop */
+//--
+// Until the first simulation is done only a proven root ends the search: a stop or a deadline that comes before
+// it (a queued job that starts late, a stop right after go) still gets a move with at least one visit
+bool Search::should_stop() const {
+    if (root_proven.load(std::memory_order_relaxed)) return true;
+    if (iterations.load(std::memory_order_relaxed) == 0) return false;
+    if (stop_requested.load(std::memory_order_relaxed) || time_up.load(std::memory_order_relaxed)) return true;
+    if (!limits.infinite) {
+        if (limits.nodes > 0 && iterations.load(std::memory_order_relaxed) >= limits.nodes) return true;
+        if (limits.depth > 0 && max_depth.load(std::memory_order_relaxed) >= limits.depth) return true;
+    }
+    return Clock::now().time_since_epoch().count() >= deadline_ticks.load(std::memory_order_relaxed);
+}
+
+//--
+/* Search::check_time */
+//--
+// Whichever thread passes the next check time first claims it, the others go on searching
+// The info line is built under the tree lock but written after it's released, so the sink never holds up the tree
+void Search::check_time() {
+    const Clock::rep now = Clock::now().time_since_epoch().count();
+    Clock::rep next = next_time_check.load(std::memory_order_relaxed);
+    if (now < next) return;
+    const Clock::rep interval = std::chrono::duration_cast<Clock::duration>(TIME_CHECK_INTERVAL).count();
+    if (!next_time_check.compare_exchange_strong(next, now + interval, std::memory_order_relaxed)) return;
+
+    std::vector<std::string> lines;
+    {
+        std::lock_guard<std::mutex> guard(tree_mutex);
+        const Clock::time_point time = Clock::now();
+        if (time_manager.should_stop(root_stats(), time)) time_up = true;
+        if (info_interval_ms > 0 && time >= next_info) {
+            next_info = time + std::chrono::milliseconds(info_interval_ms);
+            lines = info_lines(time);
+        }
+    }
+    for (const auto& line : lines) info(line);
+}
+
+//--
+/* Search::root_stats */
+//--
+RootStats Search::root_stats() const {
+    RootStats stats;
+    if (!root_node) return stats;
+    for (size_t i = 0; i < root_node->children.size(); ++i) {
+        const int visits = root_node->children[i]->visits;
+        stats.total_visits += visits;
+        if (stats.best_index < 0 || visits > stats.best_visits) {
+            stats.second_visits = stats.best_index < 0 ? 0 : stats.best_visits;
+            stats.best_visits = visits;
+            stats.best_index = static_cast<int>(i);
+        } else if (visits > stats.second_visits) {
+            stats.second_visits = visits;
+        }
+    }
+    return stats;
+}
+
+//--
+/* Search::record_depth */
+//--
+// Called under the tree lock, the atomics are for should_stop and the statistics getters
+void Search::record_depth(const Node* leaf) {
+    int depth = 0;
+    for (const Node* node = leaf; node->parent; node = node->parent) depth++;
+    total_depth.fetch_add(depth, std::memory_order_relaxed);
+    if (depth > max_depth.load(std::memory_order_relaxed)) max_depth.store(depth, std::memory_order_relaxed);
+}
+
+//--
+/* Search::filter_root_moves */
+//--
+// priors (one per legal move, in the same order) are filtered along with the moves and rescaled to sum to 1
+void Search::filter_root_moves(const Node* node, std::vector<core::Move>& legal_moves, std::vector<float>* priors) const {
+    if (node != root_node.get() || limits.search_moves.empty()) return;
+    auto allowed = [this](const core::Move& move) {
+        for (const auto& search_move : limits.search_moves) {
+            if (search_move.from_sq == move.from_sq && search_move.to_sq == move.to_sq && search_move.flags == move.flags) return true;
+        }
+        return false;
+    };
+    const bool with_priors = priors && priors->size() == legal_moves.size();
+    size_t kept = 0;
+    float sum = 0.0f;
+    for (size_t i = 0; i < legal_moves.size(); ++i) {
+        if (!allowed(legal_moves[i])) continue;
+        legal_moves[kept] = legal_moves[i];
+        if (with_priors) {
+            (*priors)[kept] = (*priors)[i];
+            sum += (*priors)[i];
+        }
+        ++kept;
+    }
+    legal_moves.resize(kept);
+    if (!with_priors) return;
+    priors->resize(kept);
+    if (sum > 0.0f) {
+        for (float& prior : *priors) prior /= sum;
+    }
+}
+
+//--
+/* q_to_centipawns */
+//--
+// The curve Leela Chess Zero uses: Q 0.5 is about a pawn, and the score grows quickly as Q gets close to a win
+int q_to_centipawns(double q) {
+    const double cp = 111.714640912 * std::tan(1.5620688421 * std::max(-1.0, std::min(1.0, q)));
+    return static_cast<int>(std::lround(std::max<double>(-MAX_SCORE_CP, std::min<double>(MAX_SCORE_CP, cp))));
+}
+
+//--
+/* Search::info_lines */
+//--
+// depth is the average leaf depth and seldepth the deepest, nodes are this search's simulations, hashfull is the
+// evaluation cache (the Hash option, 0 without one). A move's score is its Q, or the mate distance once it's proven
+std::vector<std::string> Search::info_lines(Clock::time_point now) {
+    using ms = std::chrono::duration<double, std::milli>;
+    const double elapsed = ms(now - search_start).count();
+    const int nodes = iterations.load(std::memory_order_relaxed);
+    const int64_t nps = elapsed > 0.0 ? static_cast<int64_t>(nodes * 1000.0 / elapsed) : 0;
+    const std::string head = "info depth " + std::to_string(std::lround(get_average_depth())) +
+                             " seldepth " + std::to_string(max_depth.load(std::memory_order_relaxed));
+    const std::string tail = " nodes " + std::to_string(nodes) + " nps " + std::to_string(nps) +
+                             " hashfull " + std::to_string(eval_cache ? eval_cache->hashfull() : 0) +
+                             " time " + std::to_string(static_cast<int64_t>(elapsed));
+
+    std::vector<std::string> lines;
+    const std::vector<RootMove> moves = get_root_moves(multi_pv);
+    if (moves.empty()) {
+        // no legal moves: mated, or a draw
+        lines.push_back(head + " score " + (root_node->proof == Proof::Win ? "mate 0" : "cp 0") + tail);
+        return lines;
+    }
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const RootMove& move = moves[i];
+        std::string score = "cp " + std::to_string(q_to_centipawns(move.q));
+        if (move.proof == Proof::Win) score = "mate " + std::to_string((move.mate_plies + 1) / 2);
+        else if (move.proof == Proof::Loss) score = "mate -" + std::to_string((move.mate_plies + 1) / 2);
+        else if (move.proof == Proof::Draw) score = "cp 0";
+
+        std::string line = head + " multipv " + std::to_string(i + 1) + " score " + score + tail + " pv";
+        for (const auto& pv_move : move.pv) line += " " + core::move_to_uci_string(pv_move);
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+//--
+/* Search::get_principal_variation */
+//--
+std::vector<core::Move> Search::get_principal_variation() const {
+    std::vector<core::Move> pv;
+    if (root_node) append_principal_variation(root_node.get(), pv);
+    return pv;
+}
+
+void Search::append_principal_variation(const Node* node, std::vector<core::Move>& pv) {
+    while (node) {
+        const Node* best = nullptr;
+        for (const auto& child : node->children) {
+            if (child->visits > 0 && (!best || child->visits > best->visits)) best = child.get();
+        }
+        if (best) pv.push_back(best->move);
+        node = best;
+    }
+}
+
+//--
+/* Search::info */
+//--
+void Search::info(const std::string& line) const {
+    if (info_sink) info_sink(line);
+    else std::cout << line << std::endl;
+}
+
+//--
+/* Search::run */
+//--
+// The search itself, see find_best_move
+core::Move Search::run(core::Position& root_pos) {
     // --- Setup ---
-    // Initialize the search tree with a root node
-    root_node = std::make_unique<Node>();
-    
+    // Start from the root position's node in the previous tree, or from a new root node
+    // A root restricted to some moves is missing children, so it's never reused and never reuses another tree
+    if (!limits.search_moves.empty() || root_filtered) clear_tree();
+    root_filtered = !limits.search_moves.empty();
+    reuse_tree(root_pos);
+
     // Clear the transposition table from any previous search
     tt.clear();
     // Store the root node in the transposition table
     tt.store(root_pos.current_hash, root_node.get());
 
-    auto start_time = std::chrono::steady_clock::now();
-    int iterations = 0;
+    iterations = 0;
+    max_depth = 0;
+    total_depth = 0;
+    cache_lookups = 0;
+    cache_hits = 0;
+    next_time_check = 0;
+    search_start = Clock::now();
+    next_info = search_start + std::chrono::milliseconds(info_interval_ms);
+    // a reused root can already be proven (a mate found during the previous search)
+    root_proven = root_node->proof != Proof::None;
+
+    // every thread gets its own playout generator, seeded from the main one
+    std::vector<uint64_t> seeds(num_threads);
+    for (auto& seed : seeds) seed = random_generator();
+
+    // The queue (and its evaluator thread) only lives for this search, every leaf is back before it's destroyed
+    // A shared queue outlives all the searches
+    std::unique_ptr<EvalQueue> own_queue;
+    EvalQueue* queue = nullptr;
+    if (leaf_evaluator == LeafEvaluatorKind::Network) {
+        if (shared_queue) {
+            queue = shared_queue;
+        } else if (batch_evaluator) {
+            own_queue = std::make_unique<EvalQueue>(*batch_evaluator, eval_queue_config);
+            queue = own_queue.get();
+        }
+    }
+
+    // The cache belongs to the evaluator (and is shared with other searches when the queue is), so the hits are
+    // counted here from the evaluations, not read from the cache
+    eval_cache = queue ? queue->get_evaluator().get_cache() : nullptr;
+
+    if (leaf_evaluator == LeafEvaluatorKind::Network && !queue) {
+        info("info string no network loaded, using random playouts");
+    }
+    if (reused_visits > 0) {
+        info("info string reused tree with " + std::to_string(reused_visits) + " visits");
+    }
 
     // --- Main MCTS Loop ---
-    // The loop continues until the time limit is exceeded
-    while (true) {
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count() >= time_limit_ms) {
-            break;
+    // Helper threads are started for threads 1..n-1, this thread is search thread 0
+    // The evaluator is picked here, once, each worker is compiled for its evaluator
+    auto run = [&](int thread_id) {
+        if (queue) {
+            search_worker_batched(root_pos, *queue);
+            return;
         }
-
-        // Create a copy of the position to modify during this iteration's traversal
-        core::Position search_pos = root_pos; 
-        
-        // MCTS consists of four main phases per iteration:
-        // 1. Selection: Traverse the tree to find a promising leaf node
-        Node* node = select(root_node.get(), search_pos);
-        // 2. Expansion: Add a new child to the selected node
-        node = expand(node, search_pos);
-        // 2. Expansion
-        /*
-        if (!is_terminal(search_pos)) { // Only expand if not a terminal node
-            node = expand(node, search_pos);
+        switch (leaf_evaluator) {
+            case LeafEvaluatorKind::TruncatedPlayout:
+                search_worker(root_pos, seeds[thread_id], TruncatedPlayoutEvaluator{playout_plies});
+                break;
+            case LeafEvaluatorKind::StaticEval:
+                search_worker(root_pos, seeds[thread_id], StaticEvaluator{});
+                break;
+            default:
+                search_worker(root_pos, seeds[thread_id], RandomPlayoutEvaluator{});
+                break;
         }
-        */
-        // 3. Simulation: Run a random playout from the new node
-        double result = simulate(search_pos);
-        // 4. Backpropagation: Update node statistics back up the tree
-        backpropagate(node, result);
-        
-        iterations++;
-    }
-    
+    };
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < num_threads; ++i) helpers.emplace_back(run, i);
+    run(0);
+    for (auto& helper : helpers) helper.join();
+
     // Output search statistics
-    std::cout << "info depth " << iterations << " nodes " << tt.size() << std::endl;
+    for (const auto& line : info_lines(Clock::now())) info(line);
+    if (root_node->proof != Proof::None) {
+        // the root's proof is from the previous mover, the side to move here has the opposite result
+        const char* result = root_node->proof == Proof::Loss ? "win" : root_node->proof == Proof::Win ? "loss" : "draw";
+        const int mate_in = get_mate_in();
+        info(std::string("info string root proven ") + result + " for the side to move" +
+             (mate_in > 0 ? ", mate in " + std::to_string(mate_in) : std::string()));
+    }
+    if (eval_cache) {
+        const int64_t lookups = cache_lookups.load(), hits = cache_hits.load();
+        info("info string evalcache hits " + std::to_string(hits) + " lookups " + std::to_string(lookups) +
+             " hitrate " + std::to_string(lookups > 0 ? static_cast<int>(hits * 100 / lookups) : 0) + "%");
+    }
+    if (own_queue) {
+        info("info string evalqueue batches " + std::to_string(own_queue->batches()) + " avgbatch " +
+             std::to_string(own_queue->average_batch_size()));
+    }
 
     // After the search, determine the best move from the root
     return get_best_move_from_root();
 }
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-/*
-core::Move Search::find_best_move(core::Position& root_pos, int time_limit_ms) {
-    // --- Setup ---
-    // Initialize the search tree with a root node
-    root_node = std::make_unique<Node>();
-    
-    // Clear the transposition table from any previous search
-    tt.clear();
-    // Store the root node in the transposition table
-    tt.store(root_pos.current_hash, root_node.get());
 
-    auto start_time = std::chrono::steady_clock::now();
-    int iterations = 0;
+//--
+/* Search::clear_tree */
+//--
+void Search::clear_tree() {
+    root_node.reset();
+    spare_tree.reset();
+}
 
-    // --- Main MCTS Loop ---
-    // The loop continues until the time limit is exceeded
-    while (true) {
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time).count() >= time_limit_ms) {
-            break;
+//--
+/* Search::reuse_tree */
+//--
+// The current tree is looked at first, then the spare. When the new root is below the root of a tree, it's cut
+// out of it and the rest of that tree becomes the spare. A terminal node (proven, no children) is never reused,
+// the root of a search needs moves
+void Search::reuse_tree(const core::Position& root_pos) {
+    std::unique_ptr<Node>* trees[2] = {&root_node, &spare_tree};
+    const core::Position* positions[2] = {&tree_pos, &spare_pos};
+
+    std::unique_ptr<Node> new_root;
+    for (int i = 0; i < 2 && !new_root; ++i) {
+        if (!*trees[i]) continue;
+        core::Position pos = *positions[i];
+        Node* node = find_node(trees[i]->get(), pos, root_pos.current_hash, MAX_REUSE_PLIES);
+        if (!node || (node->proof != Proof::None && node->children.empty())) continue;
+
+        if (node == trees[i]->get()) {
+            new_root = std::move(*trees[i]);
+            continue;
+        }
+        auto& siblings = node->parent->children;
+        auto slot = std::find_if(siblings.begin(), siblings.end(),
+                                 [node](const std::unique_ptr<Node>& child) { return child.get() == node; });
+        new_root = std::move(*slot);
+        siblings.erase(slot);
+        new_root->parent = nullptr;
+        if (i == 0) {
+            spare_tree = std::move(root_node);
+            spare_pos = tree_pos;
         }
+    }
+
+    if (new_root) {
+        reused_visits = new_root->visits;
+    } else {
+        // nothing to reuse, the old trees belong to another game
+        new_root = std::make_unique<Node>();
+        spare_tree.reset();
+        reused_visits = 0;
+    }
+    root_node = std::move(new_root);
+    tree_pos = root_pos;
+}
 
+//--
+/* Search::find_node */
+//--
+Node* Search::find_node(Node* node, core::Position& pos, core::zobrist_key_t hash, int plies) {
+    if (pos.current_hash == hash) return node;
+    if (plies == 0) return nullptr;
+    for (const auto& child : node->children) {
+        pos.make_move(child->move);
+        Node* found = find_node(child.get(), pos, hash, plies - 1);
+        pos.unmake_move(child->move);
+        if (found) return found;
+    }
+    return nullptr;
+}
+
+//--
+/* Search::search_worker */
+//--
+// One iteration is the usual select -> expand -> simulate -> backpropagate. The tree is only locked while
+// selecting/expanding and while backpropagating, the playout itself runs in parallel with the other threads
+// While a thread is playing out, its path carries a virtual loss so the other threads spread out
+// Proven nodes have an exact value and skip the simulation, and the search ends early once the root is proven
+template <typename Evaluator>
+void Search::search_worker(const core::Position& root_pos, uint64_t seed, const Evaluator& evaluator) {
+    Rng gen(seed);
+
+    while (!should_stop()) {
+        check_time();
         // Create a copy of the position to modify during this iteration's traversal
-        core::Position search_pos = root_pos; 
-        
-        // MCTS consists of four main phases per iteration:
-        // 1. Selection: Traverse the tree to find a promising leaf node
-        Node* node = select(root_node.get(), search_pos);
-        // 2. Expansion: Add a new child to the selected node
-        node = expand(node, search_pos);
-        // 2. Expansion
-        if (!is_terminal(search_pos)) { // Only expand if not a terminal node
+        core::Position search_pos = root_pos;
+
+        Node* node;
+        {
+            std::lock_guard<std::mutex> guard(tree_mutex);
+            // 1. Selection: Traverse the tree to find a promising leaf node
+            node = select(root_node.get(), search_pos);
+            // 2. Expansion: Add a new child to the selected node
             node = expand(node, search_pos);
+            record_depth(node);
+            if (node->proof != Proof::None) {
+                backpropagate(node, proven_result(node));
+                iterations++;
+                continue;
+            }
+            apply_virtual_loss(node, 1);
+        }
+
+        // 3. Simulation: Score the new node with the leaf evaluator
+        double result = evaluator.evaluate(search_pos, gen);
+
+        {
+            std::lock_guard<std::mutex> guard(tree_mutex);
+            apply_virtual_loss(node, -1);
+            // 4. Backpropagation: Update node statistics back up the tree
+            backpropagate(node, result);
         }
-        // 3. Simulation: Run a random playout from the new node
-        double result = simulate(search_pos);
-        // 4. Backpropagation: Update node statistics back up the tree
-        backpropagate(node, result);
-        
         iterations++;
     }
-    
-    // Output search statistics
-    std::cout << "info depth " << iterations << " nodes " << tt.size() << std::endl;
+}
 
-    // After the search, determine the best move from the root
-    return get_best_move_from_root();
+//--
+/* Search::search_worker_batched */
+//--
+// Selection keeps going while leaves are being evaluated: every submitted leaf adds a virtual loss to its path,
+// which pushes the next selections towards other leaves. Up to 2 * B / threads leaves per thread are in flight,
+// so the evaluator can fill a batch while the previous one is still running
+// Terminal and proven leaves never go to the queue, they are scored right away
+void Search::search_worker_batched(const core::Position& root_pos, EvalQueue& queue) {
+    const int client = queue.register_client();
+    const int batch = queue.config().max_batch_size;
+    const int max_in_flight = std::max(1, 2 * ((batch + num_threads - 1) / num_threads));
+
+    std::vector<EvalQueue::Completion> completed;
+    int in_flight = 0;
+
+    auto backpropagate_completed = [&]() {
+        std::lock_guard<std::mutex> guard(tree_mutex);
+        for (const auto& done : completed) {
+            Node* leaf = static_cast<Node*>(done.user_data);
+            // the leaf was expanded with heuristic priors when it was queued, now the real ones are here
+            if (selection.mode == SelectionMode::PUCT) set_child_priors(leaf, done.result.priors);
+            apply_virtual_loss(leaf, -1);
+            backpropagate(leaf, done.result.value);
+            if (done.result.cached) cache_hits++;
+        }
+        cache_lookups += static_cast<int64_t>(completed.size());
+        in_flight -= static_cast<int>(completed.size());
+        iterations += static_cast<int>(completed.size());
+        completed.clear();
+    };
+
+    while (!should_stop()) {
+        check_time();
+        if (queue.poll(client, completed) > 0) backpropagate_completed();
+
+        if (in_flight >= max_in_flight) {
+            // short waits, so the deadline and a stop are noticed quickly
+            if (queue.wait(client, completed, std::chrono::microseconds(1000)) > 0) backpropagate_completed();
+            continue;
+        }
+
+        core::Position search_pos = root_pos;
+        Node* node;
+        {
+            std::lock_guard<std::mutex> guard(tree_mutex);
+            node = select(root_node.get(), search_pos);
+            node = expand(node, search_pos);
+            record_depth(node);
+            if (node->proof != Proof::None) {
+                backpropagate(node, proven_result(node));
+                iterations++;
+                continue;
+            }
+            apply_virtual_loss(node, 1);
+        }
+
+        queue.submit(client, search_pos, node);
+        in_flight++;
+    }
+
+    // the tree has to stay valid until every submitted leaf is back
+    while (in_flight > 0) {
+        if (queue.wait(client, completed, std::chrono::microseconds(1000)) > 0) backpropagate_completed();
+    }
+    queue.release_client(client);
+}
+
+//--
+/* Search::set_num_threads */
+//--
+void Search::set_num_threads(int threads) {
+    num_threads = std::max(1, threads);
+}
+
+//--
+/* Search::set_batch_evaluator */
+//--
+// The evaluator isn't owned by the search and has to outlive it
+void Search::set_batch_evaluator(BatchEvaluator* evaluator, const EvalQueueConfig& config) {
+    batch_evaluator = evaluator;
+    eval_queue_config = config;
+    if (evaluator) {
+        shared_queue = nullptr;
+        leaf_evaluator = LeafEvaluatorKind::Network;
+    } else if (leaf_evaluator == LeafEvaluatorKind::Network) {
+        leaf_evaluator = LeafEvaluatorKind::RandomPlayout;
+    }
+}
+
+//--
+/* Search::set_eval_queue */
+//--
+void Search::set_eval_queue(EvalQueue* queue) {
+    shared_queue = queue;
+    if (queue) {
+        batch_evaluator = nullptr;
+        leaf_evaluator = LeafEvaluatorKind::Network;
+    } else if (leaf_evaluator == LeafEvaluatorKind::Network) {
+        leaf_evaluator = LeafEvaluatorKind::RandomPlayout;
+    }
 }
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
 
 //--
 /* Search::select */
@@ -156,10 +606,27 @@ core::Move Search::find_best_move(core::Position& root_pos, int time_limit_ms) {
     //  pos: The board position, which is updated as the selection traverses the tree
     // A pointer to the selected leaf Node
 Node* Search::select(Node* node, core::Position& pos) {
+    // PUCT: an expanded node has all of its children, so the first node without children is the leaf
+    // (and there's no need to generate moves on the way down)
+    // In both modes the descent stops at a proven node, its subtree doesn't need any more work
+    if (selection.mode == SelectionMode::PUCT) {
+        while (!node->children.empty() && node->proof == Proof::None) {
+            Node* child = select_child_puct(node);
+            if (!child) break;
+            node = child;
+            pos.make_move(node->move);
+        }
+        return node;
+    }
+
     core::MoveGenerator move_gen;
     std::vector<core::Move> legal_moves;
     while (true) {
+        if (node->proof != Proof::None) {
+            return node;
+        }
         move_gen.generate_legal_moves(pos, legal_moves);
+        filter_root_moves(node, legal_moves);
 
         // If the node is terminal (no legal moves) or not yet fully expanded,
         // we have found our leaf node and stop the selection phase
@@ -173,7 +640,9 @@ Node* Search::select(Node* node, core::Position& pos) {
 
         // Iterate through all children to find the one with the highest UCT score
         for (const auto& child : node->children) {
-            double score = uct_score(child.get(), node->visits);
+            // a proven loss is never worth another look
+            if (child->proof == Proof::Loss) continue;
+            double score = uct_score(child.get(), node->visits + node->virtual_loss);
             if (score > max_score) {
                 max_score = score;
                 best_child = child.get();
@@ -193,58 +662,8 @@ Node* Search::select(Node* node, core::Position& pos) {
         legal_moves.clear();
         
     }
-    // ======================================================================================
-    // ======================================================================================
-    // ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-    // ======================================================================================
-    // ======================================================================================
-}/*
-     while (true) {
-        // If the node is not fully expanded, we must expand it first. Selection ends.
-        if (!node->is_fully_expanded()) {
-            return node;
-        }
-
-        // If it's a leaf node (no children after being fully expanded), it's terminal.
-        if (node->children.empty()) {
-            return node;
-        }
-
-        // --- Find the best child using UCT ---
-        Node* best_child = nullptr;
-        double max_score = -std::numeric_limits<double>::infinity();
-
-        for (const auto& child : node->children) {
-            double score = uct_score(child.get(), node->visits);
-            if (score > max_score) {
-                max_score = score;
-                best_child = child.get();
-            }
-        }
-        
-        // This case should not be reached if node has children.
-        if (!best_child) { 
-            return node;
-        }
-
-        // Descend to the best child
-        pos.make_move(best_child->move);
-        node = best_child;
-    }
 }
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
 
-*/
 //--
 // Search::expand
 //--
@@ -253,54 +672,31 @@ Node* Search::select(Node* node, core::Position& pos) {
 // corresponding to the next unexplored move from this position
     //  node: The leaf node to expand
     //  pos: The board position corresponding to the leaf node
-    // A pointer to the newly created child node. If the node is terminal, returns the original node
-/*
+    // A pointer to the newly created child node. If the node is terminal or proven, returns the original node
 Node* Search::expand(Node* node, core::Position& pos) {
-    // Generate moves for this node IF they haven't been generated yet.
-    if (!node->moves_generated) {
-        core::MoveGenerator move_gen;
-        // The expensive legal move generation is now called only ONCE per node.
-        move_gen.generate_legal_moves(pos, node->untried_moves);
-        node->moves_generated = true;
-        // Optional: Shuffle untried_moves to add randomness
-        // std::shuffle(node->untried_moves.begin(), node->untried_moves.end(), random_generator);
-    }
-    
-    // If there are still untried moves, expand one.
-    if (!node->untried_moves.empty()) {
-        core::Move move_to_expand = node->untried_moves.back();
-        node->untried_moves.pop_back();
-
-        pos.make_move(move_to_expand);
-
-        // Create the new child node
-        node->children.push_back(std::make_unique<Node>(node, move_to_expand));
-        Node* new_child = node->children.back().get();
-
-        // Check the transposition table. If we've seen this position before,
-        // we should ideally use the existing node. This is a more advanced optimization.
-        // For now, we'll just store it.
-        tt.store(pos.current_hash, new_child);
-        
-        return new_child;
+    if (node->proof != Proof::None) {
+        return node;
     }
 
-    // This can happen if the node is terminal (no legal moves).
-    return node;
-}
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-Node* Search::expand(Node* node, core::Position& pos) {
     core::MoveGenerator move_gen;
     std::vector<core::Move> legal_moves;
     move_gen.generate_legal_moves(pos, legal_moves);
 
-    // If the node is terminal (a checkmate or stalemate), we can't expand it further
-    if (legal_moves.empty()) {
+    // If the node is terminal (a checkmate, stalemate or draw), we can't expand it further,
+    // its value is known for good. The root still needs a move when it's a draw (say a repetition
+    // with the game history), so only having no moves at all ends the search there
+    double result;
+    if (game_result(pos, legal_moves, result) && (node != root_node.get() || legal_moves.empty())) {
+        set_proof(node, result < 0.0 ? Proof::Win : Proof::Draw);
+        return node;
+    }
+    // after the terminal check, a root without any of the search moves is not a checkmate
+    filter_root_moves(node, legal_moves);
+    if (legal_moves.empty()) return node;
+
+    // PUCT: the leaf gets all its children now and is evaluated itself, so pos stays where it is
+    if (selection.mode == SelectionMode::PUCT) {
+        if (node->children.empty()) expand_all(node, pos, legal_moves, nullptr);
         return node;
     }
 
@@ -313,6 +709,7 @@ Node* Search::expand(Node* node, core::Position& pos) {
     // Create a new child node representing the new position
     node->children.push_back(std::make_unique<Node>(node, move_to_expand));
     Node* new_child = node->children.back().get();
+    node->expanded = node->children.size() == legal_moves.size();
 
     // Store the new node in the transposition table for future lookups
     tt.store(pos.current_hash, new_child);
@@ -320,76 +717,72 @@ Node* Search::expand(Node* node, core::Position& pos) {
     // Return the newly created node for the simulation phase
     return new_child;
 }
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-//--
-/* Search::simulate */
-//--
-// Performs the simulation (playout) phase of MCTS
-// From the given position, it plays a random game to its conclusion
-    //  pos: The starting position for the simulation
-    // The result of the game from the perspective of the current player (+1 for win, -1 loss, 0 draw)
-/*
-double Search::simulate(core::Position& pos) {
-    core::Position sim_pos = pos;
-    return limited_depth_playout(sim_pos, this->random_generator);
-}
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-
-double Search::simulate(core::Position& pos) {
-    // Delegate the simulation to a random playout function
-    return random_playout(pos, this->random_generator);
-}
-
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
+
+//--
+/* Search::expand_all */
+//--
+// Adds a child for every legal move (in MoveGenerator order, so priors[i] belongs to children[i])
+// The priors may cover every legal move of pos while legal_moves was cut down to the search moves,
+// then the priors of the kept moves are picked out
+// Without priors (or with the wrong number of them) the heuristic priors are used
+void Search::expand_all(Node* node, const core::Position& pos, const std::vector<core::Move>& legal_moves,
+                        const std::vector<float>* priors) {
+    std::vector<float> gathered;
+    if (priors && priors->size() != legal_moves.size() && gather_root_priors(node, pos, *priors, gathered)) {
+        priors = &gathered;
+    }
+    std::vector<float> fallback;
+    if (!priors || priors->size() != legal_moves.size()) {
+        heuristic_priors(pos, legal_moves, fallback);
+        priors = &fallback;
+    }
+    node->children.reserve(legal_moves.size());
+    for (size_t i = 0; i < legal_moves.size(); ++i) {
+        node->children.push_back(std::make_unique<Node>(node, legal_moves[i]));
+        node->children.back()->prior = (*priors)[i];
+    }
+    node->expanded = true;
+    // the children's positions are never made, so the tt holds the expanded nodes
+    tt.store(pos.current_hash, node);
+}
+
+//--
+/* Search::set_child_priors */
+//--
+// Used when the network's priors come back for a leaf that was expanded with heuristic priors
+// The network scores every legal move, so at a root cut down to the search moves its priors are gathered by move
+void Search::set_child_priors(Node* node, const std::vector<float>& priors) {
+    const std::vector<float>* child_priors = &priors;
+    std::vector<float> gathered;
+    if (priors.size() != node->children.size() && gather_root_priors(node, tree_pos, priors, gathered)) {
+        child_priors = &gathered;
+    }
+    if (child_priors->size() != node->children.size()) return;
+    for (size_t i = 0; i < child_priors->size(); ++i) node->children[i]->prior = (*child_priors)[i];
+}
+
+//--
+/* Search::gather_root_priors */
+//--
+// Picks the priors of the search moves out of priors for every legal move of the root (whose position is pos)
+bool Search::gather_root_priors(const Node* node, const core::Position& pos, const std::vector<float>& priors,
+                                std::vector<float>& gathered) const {
+    if (node != root_node.get() || limits.search_moves.empty()) return false;
+    core::MoveGenerator move_gen;
+    std::vector<core::Move> legal_moves;
+    move_gen.generate_legal_moves(pos, legal_moves);
+    if (legal_moves.size() != priors.size()) return false;
+    gathered = priors;
+    filter_root_moves(node, legal_moves, &gathered);
+    return true;
+}
+
 //--
 /* Search::backpropagate */
 //--
 // Performs the backpropagation phase of MCTS
 // It updates the visit counts and outcome statistics of all nodes from the simulation's start node up to the root
-//  result The result of the simulation
-/*
-void Search::backpropagate(Node* node, double result) {
-    while (node != nullptr) {
-        // Atomically increment the visit count (this is fine for integers)
-        node->visits.fetch_add(1, std::memory_order_relaxed);
-
-        // Use a compare-and-swap (CAS) loop for atomic floating-point addition
-        double current_value = node->value.load(std::memory_order_relaxed);
-        double new_value;
-        do {
-            new_value = current_value + result;
-        } while (!node->value.compare_exchange_weak(current_value, new_value, 
-                                                     std::memory_order_release, 
-                                                     std::memory_order_relaxed));
-        // `current_value` is automatically updated by compare_exchange_weak on failure,
-        // so the loop retries with the latest value
-
-        // Invert the result for the parent node
-        result = -result;
-        
-        // Move up to the parent
-        node = node->parent;
-    }
-}
-    */
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABVOE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
+//  result The result of the simulation, from the perspective of the side to move at 'node'
 void Search::backpropagate(Node* node, double result) {
     // The simulation result is from the perspective of the player who just moved to 'node'
     // We traverse up the tree to the root
@@ -404,36 +797,60 @@ void Search::backpropagate(Node* node, double result) {
         node = node->parent;
     }
 }
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
+
 //--
-/* Search::uct_score */
+/* Search::set_proof */
 //--
-/*
-double Search::uct_score(const Node* node, int parent_visits) const {
-    if (node->visits == 0) {
-        return std::numeric_limits<double>::infinity();
+// Proves node, then walks up as long as the parents become proven too:
+// a parent is lost for its mover as soon as the side to move there has a winning move, and once every move
+// is proven (and none of them wins) it is a draw if one of them draws, otherwise a win
+void Search::set_proof(Node* node, Proof proof) {
+    node->proof = proof;
+    while (Node* parent = node->parent) {
+        if (parent->proof != Proof::None) break;
+
+        Proof parent_proof = Proof::None;
+        if (node->proof == Proof::Win) {
+            parent_proof = Proof::Loss;
+        } else if (parent->expanded) {
+            bool all_proven = true, any_draw = false;
+            for (const auto& child : parent->children) {
+                if (child->proof == Proof::None) {
+                    all_proven = false;
+                    break;
+                }
+                any_draw = any_draw || child->proof == Proof::Draw;
+            }
+            if (all_proven) parent_proof = any_draw ? Proof::Draw : Proof::Win;
+        }
+        if (parent_proof == Proof::None) break;
+
+        parent->proof = parent_proof;
+        node = parent;
+    }
+    if (root_node->proof != Proof::None) root_proven = true;
+}
+
+//--
+/* Search::proven_result */
+//--
+double Search::proven_result(const Node* node) {
+    switch (node->proof) {
+        case Proof::Win:  return -1.0; // the side to move at node has lost
+        case Proof::Loss: return 1.0;
+        default:          return 0.0;
+    }
+}
+
+//--
+/* Search::apply_virtual_loss */
+//--
+void Search::apply_virtual_loss(Node* node, int amount) {
+    while (node != nullptr) {
+        node->virtual_loss += amount;
+        node = node->parent;
     }
-    // Exploitation term: Average value of the node from its own perspective
-    // The parent wants to choose the move that is best for it, which means
-    // choosing the child node with the lowest value (since the child's value
-    // represents the opponent's advantage)
-    double exploitation_term = -node->value / node->visits;
-    
-    // Exploration term
-    double exploration_term = UCT_C * std::sqrt(std::log(static_cast<double>(parent_visits)) / node->visits);
-    
-    return exploitation_term + exploration_term;
 }
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
 
 //--
 /* Search::uct_score */
@@ -445,61 +862,151 @@ double Search::uct_score(const Node* node, int parent_visits) const {
     // The calculated UCT score as a double
 
 double Search::uct_score(const Node* node, int parent_visits) const {
+    // Pending visits count as visits that were lost, so other threads (and other pending leaves) look elsewhere
+    const int visits = node->visits + node->virtual_loss;
     // If a node has not been visited, prioritize it by giving it an infinite score
-    if (node->visits == 0) {
+    if (visits == 0) {
         return std::numeric_limits<double>::infinity();
     }
     // Exploitation term: the average value of the node from the parent's perspective
-    double q_value = node->value / node->visits;
+    double q_value = (node->value - node->virtual_loss) / visits;
     // Exploration term: encourages visiting less-explored nodes
-    double u_value = UCT_C * std::sqrt(std::log(parent_visits) / node->visits);
+    double u_value = selection.c_uct * std::sqrt(std::log(parent_visits) / visits);
     
     // The final score is the sum of the exploitation and exploration terms
     // The node's value is already stored from the parent's perspective, so no negation is needed here
     return q_value + u_value;
 }
+//--
+/* Search::select_child_puct */
+//--
+// score = Q + c_puct * P * sqrt(N) / (1 + n), with virtual loss counted like in uct_score
+// Unvisited children get the first play urgency value instead of a Q: the parent's own Q, reduced by
+// fpu_reduction * sqrt(the prior mass already visited), so the more of the policy has been looked at,
+// the less attractive the moves the policy didn't like become
+Node* Search::select_child_puct(const Node* node) const {
+    const int parent_visits = node->visits + node->virtual_loss;
+    const double sqrt_parent = std::sqrt(static_cast<double>(std::max(1, parent_visits)));
+    // node->value is from the grandparent's point of view, the children's values are from node's
+    const double parent_q = node->visits > 0 ? -node->value / node->visits : 0.0;
+
+    double visited_prior = 0.0;
+    for (const auto& child : node->children) {
+        if (child->visits + child->virtual_loss > 0) visited_prior += child->prior;
+    }
+    const double fpu_value = parent_q - selection.fpu_reduction * std::sqrt(visited_prior);
+
+    Node* best_child = nullptr;
+    double max_score = -std::numeric_limits<double>::infinity();
+    for (const auto& child : node->children) {
+        if (child->proof == Proof::Loss) continue;
+        const int visits = child->visits + child->virtual_loss;
+        const double q_value = visits > 0 ? (child->value - child->virtual_loss) / visits : fpu_value;
+        const double u_value = selection.c_puct * child->prior * sqrt_parent / (1 + visits);
+        if (q_value + u_value > max_score) {
+            max_score = q_value + u_value;
+            best_child = child.get();
+        }
+    }
+    return best_child;
+}
+
 //--
 /* Search::get_best_move_from_root */
 //--
 // Determines the best move from the root node after the MCTS search is complete
 // The most robust move is the one that was explored the most times
-    // The core::Move corresponding to the most visited child of the root node
+// A proven win is always played (the fastest mate), and a proven loss only if every move loses
+    // The core::Move of the first of get_root_moves
 core::Move Search::get_best_move_from_root() {
-    int max_visits = -1;
-    core::Move best_move; // Default-constructs a "null" move
+    const std::vector<RootMove> moves = get_root_moves(1);
+    // A null move when the root has no children
+    return moves.empty() ? core::Move() : moves[0].move;
+}
 
-    // A sanity check to ensure the root node exists
-    if (!root_node) {
-        return best_move;
+//--
+/* Search::get_root_moves */
+//--
+// Only reads the root's children and their most visited descendants, nothing is searched for it
+std::vector<RootMove> Search::get_root_moves(int max_moves) const {
+    std::vector<RootMove> moves;
+    if (!root_node) return moves;
+
+    for (const auto& child : root_node->children) {
+        RootMove move;
+        move.move = child->move;
+        move.visits = child->visits;
+        move.q = child->visits > 0 ? child->value / child->visits : 0.0;
+        move.prior = child->prior;
+        move.proof = child->proof;
+        if (child->proof == Proof::Win || child->proof == Proof::Loss) move.mate_plies = proven_plies(child.get()) + 1;
+        move.pv.push_back(child->move);
+        append_principal_variation(child.get(), move.pv);
+        moves.push_back(std::move(move));
     }
 
-    // The best move is the one corresponding to the most visited child
+    // wins first, then everything that isn't lost, then the losses
+    auto rank = [](const RootMove& move) { return move.proof == Proof::Win ? 0 : move.proof == Proof::Loss ? 2 : 1; };
+    std::stable_sort(moves.begin(), moves.end(), [&rank](const RootMove& a, const RootMove& b) {
+        if (rank(a) != rank(b)) return rank(a) < rank(b);
+        if (a.proof == Proof::Win) return a.mate_plies < b.mate_plies;
+        if (a.proof == Proof::Loss && a.mate_plies != b.mate_plies) return a.mate_plies > b.mate_plies;
+        return a.visits > b.visits;
+    });
+    if (max_moves > 0 && moves.size() > static_cast<size_t>(max_moves)) moves.resize(max_moves);
+    return moves;
+}
+
+//--
+/* Search::get_mate_in */
+//--
+int Search::get_mate_in() const {
+    if (!root_node || root_node->proof != Proof::Loss) return 0;
+    return (proven_plies(root_node.get()) + 1) / 2;
+}
+
+//--
+/* Search::proven_plies */
+//--
+// Only follows proven children, which is all of them for a lost node (see set_proof). A checkmated node is the
+// only proven Win without children
+int Search::proven_plies(const Node* node) {
+    if (node->children.empty()) return 0;
+    int plies = -1;
+    for (const auto& child : node->children) {
+        if (node->proof == Proof::Loss) {
+            // the side to move wins: the fastest winning move
+            if (child->proof != Proof::Win) continue;
+            const int child_plies = proven_plies(child.get());
+            if (plies < 0 || child_plies < plies) plies = child_plies;
+        } else {
+            // the side to move loses: the longest defence
+            plies = std::max(plies, proven_plies(child.get()));
+        }
+    }
+    return plies + 1;
+}
+
+//--
+/* Search::get_ponder_move */
+//--
+core::Move Search::get_ponder_move(const core::Move& best_move) const {
+    if (!root_node) return core::Move();
     for (const auto& child : root_node->children) {
-        if (child->visits > max_visits) {
-            max_visits = child->visits;
-            best_move = child->move;
+        if (child->move.from_sq != best_move.from_sq || child->move.to_sq != best_move.to_sq ||
+            child->move.flags != best_move.flags) continue;
+
+        core::Move reply;
+        int max_visits = 0;
+        for (const auto& grandchild : child->children) {
+            if (grandchild->visits > max_visits) {
+                max_visits = grandchild->visits;
+                reply = grandchild->move;
+            }
         }
+        return reply;
     }
-    return best_move;
+    return core::Move();
 }
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-/*
-// herlper function to check for terminal nodes in the search
-bool Search::is_terminal(core::Position& pos) {
-    core::MoveGenerator move_gen;
-    std::vector<core::Move> legal_moves;
-    move_gen.generate_legal_moves(pos, legal_moves);
-    return legal_moves.empty() || pos.halfmove_clock >= 100;
-}
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
 } // namespace engine
 } // namespace hyperion
\ No newline at end of file
@@ -4,112 +4,299 @@
 #include "../core/position.hpp"
 #include "../core/move.hpp"
 #include "tt.hpp"
+#include "eval_cache.hpp"
+#include "eval_queue.hpp"
+#include "eval.hpp"
+#include "rng.hpp"
+#include "time_manager.hpp"
 
 #include <vector>
 #include <memory>
-#include <random>
+#include <cstdint>
 #include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <string>
 
 namespace hyperion {
 namespace engine {
 
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-// New node stucture
-/*
-struct Node {
-    Node* parent = nullptr;
-    core::Move move; // The move that led to this node
-    std::vector<std::unique_ptr<Node>> children;
-    std::atomic<int> visits = 0;
-    std::atomic<double> value = 0.0;
-    std::vector<core::Move> untried_moves;
-    bool moves_generated = false; // Flag to check if weve generated moves for this node
-
-    Node() = default;
-    Node(Node* p, core::Move m) : parent(p), move(m) {}
-
-    bool is_fully_expanded() const {
-        return moves_generated && untried_moves.empty();
-    }
-};
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
+//--
+/* enum class Proof */
+//--
+// MCTS-Solver: a node whose game theoretic value is known. Like Node::value it is from the point of view of the
+// player who made the move into the node, so Win means that move wins by force
+// A checkmate or draw in the tree is proven right away, and a node is proven once one of its moves is a proven
+// win for the side to move, or every move is proven (then it's a draw if any move draws, else a loss)
+enum class Proof : int8_t { None, Win, Loss, Draw };
 
-*/
 //--
 /* struct Node */
 //--
-
 struct Node {
     Node* parent = nullptr;
     std::vector<std::unique_ptr<Node>> children;
     core::Move move;
     int visits = 0;
     double value = 0.0;
+    int virtual_loss = 0; // visits that are still being evaluated, counted as losses until they come back
+    float prior = 0.0f;   // PUCT only: the policy's probability for the move that led here
+    Proof proof = Proof::None;
+    bool expanded = false; // every legal move has a child
     Node() = default;
     Node(Node* p, core::Move m) : parent(p), move(m) {}
     bool is_fully_expanded(size_t num_legal_moves) const {
         return children.size() >= num_legal_moves;
     }
 };
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT BELOW FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
-/*
-class Search {
-public:
-    Search();
-    core::Move find_best_move(core::Position& root_pos, int time_limit_ms);
+//--
+/* struct RootMove */
+//--
+// One root move's statistics, straight from its child node (MultiPV output and analysis)
+struct RootMove {
+    core::Move move;
+    int visits = 0;
+    double q = 0.0;             // average result for the side to move at the root, in [-1, 1]
+    float prior = 0.0f;         // PUCT only
+    Proof proof = Proof::None;  // like Node::proof, Win: this move wins by force
+    int mate_plies = 0;         // plies from the root to the end of the game when the move is proven
+    std::vector<core::Move> pv; // starts with move
+};
 
-private:
-    std::unique_ptr<Node> root_node;
-    TranspositionTable tt;
-    std::mt19937 random_generator;
+//--
+/* SelectionConfig */
+//--
+// UCT: plain UCB1, children are added one per visit
+// PUCT: AlphaZero style, a node gets all its children at once, each with a prior from the network's policy
+// (or from heuristic_priors when there is no network), and
+//     score = Q + c_puct * prior * sqrt(parent visits) / (1 + visits)
+// Children that were never visited use the parent's Q minus fpu_reduction * sqrt(prior of the visited children)
+// (first play urgency), so unexplored moves with a low prior aren't all tried before the good ones get deeper
+enum class SelectionMode { UCT, PUCT };
 
-    Node* select(Node* node, core::Position& pos);
-    Node* expand(Node* node, core::Position& pos);
-    double simulate(core::Position& pos);
-    void backpropagate(Node* node, double result);
-    double uct_score(const Node* node, int parent_visits) const;
-    core::Move get_best_move_from_root();
-    bool is_terminal(core::Position& pos);
+struct SelectionConfig {
+    SelectionMode mode = SelectionMode::UCT;
+    double c_uct = 1.414; // UCT exploration constant, sqrt(2). Higher explores more, 3.14 and 0.6 were tried too
+    double c_puct = 1.5;
+    double fpu_reduction = 0.3;
 };
-*/
-// ======================================================================================
-// ======================================================================================
-// ====================UNCOMENT ABOVE FOR MCTS WITH STATIC EVALUATION====================
-// ======================================================================================
-// ======================================================================================
+
+// How often a running search writes its info line, see Search::set_info_interval
+constexpr int DEFAULT_INFO_INTERVAL_MS = 500;
+
+// Converts a Q value (the expected result in [-1, 1]) to centipawns for the UCI score
+int q_to_centipawns(double q);
+
+// A mate search (SearchLimits::mate) without a time, node or depth limit gets this much time per move of the mate,
+// so it also ends in a position without one
+constexpr int MATE_TIME_PER_MOVE_MS = 2000;
+
+//--
+/* struct SearchLimits */
+//--
+// When a search ends, everything a UCI "go" can ask for. Whichever limit is hit first ends it, and the search
+// always ends once the root is proven (or on stop())
+struct SearchLimits {
+    TimeLimits time;                      // wall clock, see time_manager.hpp
+    int64_t nodes = 0;                    // simulations (leaf evaluations), 0 = no limit
+    int depth = 0;                        // stop once a leaf this many plies below the root was expanded, 0 = no limit
+    int mate = 0;                         // looking for a mate in this many moves: the search ends when the root
+                                          // is proven, without another limit after mate * MATE_TIME_PER_MOVE_MS
+    bool infinite = false;                // ignore all the limits above, search until stop()
+    std::vector<core::Move> search_moves; // only these root moves are searched, empty = all of them
+};
+
 class Search {
 public:
     Search();
 
-    // The main function to find the best move
+    // The main function to find the best move, a negative time limit searches until stop()
     core::Move find_best_move(core::Position& root_pos, int time_limit_ms);
-    
+    core::Move find_best_move(core::Position& root_pos, const SearchLimits& limits);
+
+    // --- Control from another thread (the UCI front-end) ---
+    // run() searches until the time limit set with set_time_limit, or until stop(). Unlike find_best_move it
+    // doesn't reset either of them, so a stop() that comes before the search has started still ends it
+    core::Move run(core::Position& root_pos);
+    // The deadline becomes now + time_limit_ms (a negative limit means no deadline), also while searching
+    void set_time_limit(int time_limit_ms);
+    // Soft and hard limits from the time manager, they count from now. Also while searching (UCI ponderhit)
+    void set_time_limits(const TimeLimits& limits);
+    // All the limits for the next run(), including the time limits. Not while searching
+    void set_limits(const SearchLimits& limits);
+
+    // Statistics of the last (or the running) search
+    int get_iterations() const { return iterations; }
+    int get_max_depth() const { return max_depth; }
+    double get_average_depth() const { return iterations > 0 ? static_cast<double>(total_depth) / iterations : 0.0; }
+    // Moves until mate when the root is proven a win for the side to move, 0 otherwise
+    int get_mate_in() const;
+    void stop() { stop_requested.store(true, std::memory_order_relaxed); }
+    void clear_stop() { stop_requested.store(false, std::memory_order_relaxed); }
+
+    // Where the info lines go (one line per call, without the newline), std::cout by default
+    // The sink is called from the search threads, it should hand the line off rather than wait on the output
+    using InfoSink = std::function<void(const std::string&)>;
+    void set_info_sink(InfoSink sink) { info_sink = std::move(sink); }
+    // Every interval_ms one of the search threads writes the info lines, one per MultiPV move
+    //   depth (average) seldepth multipv score nodes nps hashfull time pv
+    // and they are written once more when the search ends. 0: only the ones at the end
+    void set_info_interval(int interval_ms) { info_interval_ms = interval_ms < 0 ? 0 : interval_ms; }
+    // How many root moves the info lines show (UCI MultiPV). It's only output, the search is the same
+    void set_multi_pv(int count) { multi_pv = count < 1 ? 1 : count; }
+    int get_multi_pv() const { return multi_pv; }
+    // Most visited child after most visited child from the root, the search's expected line. Not while searching
+    std::vector<core::Move> get_principal_variation() const;
+    // The root moves, best first: proven wins (fastest mate first), then by visits, proven losses last (longest
+    // defence first). The first one is the best move. At most max_moves of them, 0 = all. Not while searching
+    std::vector<RootMove> get_root_moves(int max_moves = 0) const;
+
+    // --- Tree reuse ---
+    // The tree is kept after a search. If the next root position is in it (at most MAX_REUSE_PLIES moves below
+    // its root: our move and the reply, or the ponder move of "go ponder"), run() goes on from that node instead of
+    // starting cold. The rest of the old tree is kept as a spare for one more search, so after a ponder miss the
+    // move that was really played is usually still found in it
+    void clear_tree();
+    // Visits of the tree the last search started with, 0 after a cold start
+    int get_reused_visits() const { return reused_visits; }
+    // The reply the search expects to best_move (its most visited child), a null move if there is none
+    core::Move get_ponder_move(const core::Move& best_move) const;
+
+    // Number of threads searching the same tree
+    void set_num_threads(int threads);
+    int get_num_threads() const { return num_threads; }
+
+    // With a batch evaluator, leaves are queued and evaluated in batches on a dedicated thread instead of
+    // being played out on the search threads. Setting one also selects LeafEvaluatorKind::Network,
+    // nullptr goes back to random playouts
+    void set_batch_evaluator(BatchEvaluator* evaluator, const EvalQueueConfig& config = EvalQueueConfig());
+    // Instead of a queue of its own per search, the leaves go to this one, which other searches share (the
+    // multi-session host: one batcher for every session). Also selects LeafEvaluatorKind::Network, nullptr goes
+    // back to random playouts. The queue has to outlive the searches
+    void set_eval_queue(EvalQueue* queue);
+
+    // How new leaves are scored. Network needs a batch evaluator, without one the search falls back to playouts
+    void set_leaf_evaluator(LeafEvaluatorKind kind) { leaf_evaluator = kind; }
+    LeafEvaluatorKind get_leaf_evaluator() const { return leaf_evaluator; }
+    // Plies played before the static evaluation with LeafEvaluatorKind::TruncatedPlayout
+    void set_playout_plies(int plies) { playout_plies = plies < 1 ? 1 : plies; }
+
+    // Seeds the playout generators (the UCI Seed option). Every search draws one seed per thread from the
+    // master generator, so with the same seed, one thread and a fixed amount of work the search is repeatable
+    // 0 picks a random seed
+    void set_seed(uint64_t seed);
+    uint64_t get_seed() const { return master_seed; }
+
+    // UCT or PUCT selection, and the PUCT constants
+    // A tree from the other mode can't be searched (UCT adds children one at a time), so a mode change clears it
+    void set_selection(const SelectionConfig& config) {
+        if (config.mode != selection.mode) clear_tree();
+        selection = config;
+    }
+    const SelectionConfig& get_selection() const { return selection; }
 
 private:
+    // How deep below the old root run() looks for the new root position
+    static constexpr int MAX_REUSE_PLIES = 2;
+
     std::unique_ptr<Node> root_node;
+    core::Position tree_pos;          // the position at root_node
+    std::unique_ptr<Node> spare_tree; // what was left of the previous tree, see clear_tree
+    core::Position spare_pos;
+    int reused_visits = 0;
+    bool root_filtered = false;       // the tree's root only has the search moves' children
     TranspositionTable tt;
-    std::mt19937 random_generator;
+    uint64_t master_seed = 0;
+    Rng random_generator; // only hands out the per thread seeds
+
+    int num_threads = 1;
+    BatchEvaluator* batch_evaluator = nullptr;
+    EvalQueue* shared_queue = nullptr;
+    EvalQueueConfig eval_queue_config;
+    SelectionConfig selection;
+    LeafEvaluatorKind leaf_evaluator = LeafEvaluatorKind::RandomPlayout;
+    int playout_plies = DEFAULT_PLAYOUT_PLIES;
+    std::mutex tree_mutex;          // guards the tree and the tt while several threads search
+    std::atomic<int> iterations{0}; // finished simulations (evaluations) this search
+    std::atomic<int> max_depth{0};  // plies from the root to the deepest leaf this search
+    std::atomic<int64_t> total_depth{0}; // sum of the leaf depths, for the average
+    EvalCache* eval_cache = nullptr;     // the batch evaluator's cache this search, for hashfull
+    std::atomic<int64_t> cache_lookups{0}; // leaves evaluated through the queue this search
+    std::atomic<int64_t> cache_hits{0};    // those of them that came from the evaluator's cache
+    SearchLimits limits;            // set_limits, only the time limits may change during a search
+    std::atomic<bool> root_proven{false}; // the search can stop, the root's result is known
+    std::atomic<bool> stop_requested{false};
+    InfoSink info_sink;
 
-    // The four core MCTS steps
+    using Clock = std::chrono::steady_clock;
+    std::atomic<Clock::rep> deadline_ticks{0}; // Clock::time_point of the deadline, as a count since the epoch
+    TimeManager time_manager;                  // guarded by tree_mutex
+    std::atomic<bool> time_up{false};          // the time manager decided to stop
+    std::atomic<Clock::rep> next_time_check{0};
+    int info_interval_ms = DEFAULT_INFO_INTERVAL_MS;
+    int multi_pv = 1;
+    Clock::time_point search_start;
+    Clock::time_point next_info; // guarded by tree_mutex
+
+    // True once the deadline has passed, the time manager stopped the search, the search was stopped
+    // or the root is proven. Never before the first simulation, unless the root is proven
+    bool should_stop() const;
+    // Every few ms one of the search threads shows the root to the time manager, and writes the info line when
+    // it's due
+    void check_time();
+    // The info lines as of now, under the tree lock while searching
+    std::vector<std::string> info_lines(Clock::time_point now);
+    // Appends the most visited children below node to pv
+    static void append_principal_variation(const Node* node, std::vector<core::Move>& pv);
+    RootStats root_stats() const;
+    // Counts the leaf's depth in the depth statistics
+    void record_depth(const Node* leaf);
+    // Drops the moves that aren't in limits.search_moves when node is the root (and their priors, if given)
+    void filter_root_moves(const Node* node, std::vector<core::Move>& legal_moves,
+                           std::vector<float>* priors = nullptr) const;
+    // At a root cut down to the search moves: the priors of the search moves, out of one prior per legal move of pos
+    bool gather_root_priors(const Node* node, const core::Position& pos, const std::vector<float>& priors,
+                            std::vector<float>& gathered) const;
+    // Plies until the game ends for a proven node, with the winner mating as fast and the loser as slow as possible
+    static int proven_plies(const Node* node);
+    void info(const std::string& line) const;
+
+    // Makes the node of root_pos from the kept trees the new root_node, or a fresh one if it isn't in them
+    void reuse_tree(const core::Position& root_pos);
+    // The node of the position with the given hash, at most plies moves below node (whose position is pos)
+    static Node* find_node(Node* node, core::Position& pos, core::zobrist_key_t hash, int plies);
+
+    // One search thread, doing select -> expand -> simulate -> backpropagate until the deadline
+    // Evaluator is one of the leaf evaluator structs from eval.hpp
+    template <typename Evaluator>
+    void search_worker(const core::Position& root_pos, uint64_t seed, const Evaluator& evaluator);
+    // Same, but the leaves go to the evaluation queue and the thread keeps selecting while they are pending
+    void search_worker_batched(const core::Position& root_pos, EvalQueue& queue);
+
+    // The core MCTS steps, the simulation is done by the leaf evaluator
     Node* select(Node* node, core::Position& pos);
     Node* expand(Node* node, core::Position& pos);
-    double simulate(core::Position& pos);
     void backpropagate(Node* node, double result);
 
+    // MCTS-Solver: marks a node proven and updates its ancestors, see Proof
+    void set_proof(Node* node, Proof proof);
+    // Value of a proven node for backpropagate, from the side to move at the node
+    static double proven_result(const Node* node);
+
+    // Adds (or with a negative amount, removes) virtual loss on the path from node to the root
+    void apply_virtual_loss(Node* node, int amount);
+
+    // PUCT: adds a child for every legal move, with the given priors (or heuristic ones if priors is nullptr)
+    void expand_all(Node* node, const core::Position& pos, const std::vector<core::Move>& legal_moves,
+                    const std::vector<float>* priors);
+    // PUCT: replaces the priors of an expanded node's children, in the same order they were added
+    void set_child_priors(Node* node, const std::vector<float>& priors);
+
     // Helper to calculate the UCT score for a node
     double uct_score(const Node* node, int parent_visits) const;
+    // The child with the highest PUCT score
+    Node* select_child_puct(const Node* node) const;
 
     // Helper to pick the final move after the search is complete
     core::Move get_best_move_from_root();
@@ -0,0 +1,181 @@
+// hyperion/src/cpp/search/test_eval_queue.cpp
+#include "core/position.hpp"
+#include "core/movegen.hpp"
+#include "core/zobrist.hpp"
+#include "core/bitboard.hpp"
+#include "search/eval_queue.hpp"
+#include "search/search.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+---
+* Checks that the evaluation queue forms full batches, flushes partial batches after the wait time (or when a
+* client waits), hands every result back to the client that submitted it, and that a multithreaded search
+* feeding the queue finishes with a legal move
+
+* Build target: TestEvalQueue
+* Run it:
+    *./bin/TestEvalQueue*
+---
+*/
+
+using namespace hyperion;
+using engine::EvalQueue;
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+// Scores a position by its halfmove clock (so results can be matched to positions) and records batch sizes
+class RecordingEvaluator : public engine::BatchEvaluator {
+public:
+    std::vector<int> batch_sizes;
+    std::chrono::microseconds delay{0};
+
+    void evaluate_batch(const core::Position* positions, int count, engine::LeafEvaluation* results) override {
+        batch_sizes.push_back(count);
+        if (delay.count() > 0) std::this_thread::sleep_for(delay);
+        for (int i = 0; i < count; ++i) results[i].value = static_cast<float>(positions[i].halfmove_clock);
+    }
+};
+
+void test_full_batches() {
+    std::cout << "Running test_full_batches..." << std::endl;
+    RecordingEvaluator evaluator;
+    std::vector<EvalQueue::Completion> done;
+    std::vector<int> tags(8);
+    {
+        engine::EvalQueueConfig config;
+        config.max_batch_size = 4;
+        config.max_wait_us = 2000000; // long enough that only full batches get sent
+        EvalQueue queue(evaluator, config);
+        const int client = queue.register_client();
+
+        core::Position pos;
+        for (int i = 0; i < 8; ++i) {
+            pos.halfmove_clock = i;
+            tags[i] = i;
+            queue.submit(client, pos, &tags[i]);
+        }
+        while (done.size() < 8) queue.wait(client, done, std::chrono::microseconds(100000));
+        check(queue.batches() == 2, "8 positions with a batch size of 4 should be 2 batches");
+    }
+    check(evaluator.batch_sizes == std::vector<int>({4, 4}), "batches were not full");
+    for (const auto& c : done) {
+        check(c.result.value == static_cast<float>(*static_cast<int*>(c.user_data)), "result went to the wrong leaf");
+    }
+}
+
+void test_partial_batch_timeout() {
+    std::cout << "Running test_partial_batch_timeout..." << std::endl;
+    RecordingEvaluator evaluator;
+    engine::EvalQueueConfig config;
+    config.max_batch_size = 64;
+    config.max_wait_us = 2000;
+    EvalQueue queue(evaluator, config);
+    const int client = queue.register_client();
+
+    core::Position pos;
+    int tag = 0;
+    queue.submit(client, pos, &tag);
+    queue.submit(client, pos, &tag);
+
+    // nobody waits, so the 2 positions go out once the first one has waited 2ms
+    std::vector<EvalQueue::Completion> done;
+    auto start = std::chrono::steady_clock::now();
+    while (done.size() < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+        queue.poll(client, done);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    check(done.size() == 2, "a partial batch was never sent");
+    check(queue.batches() == 1, "the 2 positions should have been 1 batch");
+}
+
+void test_clients_get_their_own_results() {
+    std::cout << "Running test_clients_get_their_own_results..." << std::endl;
+    RecordingEvaluator evaluator;
+    engine::EvalQueueConfig config;
+    config.max_batch_size = 8;
+    config.max_wait_us = 500;
+    EvalQueue queue(evaluator, config);
+
+    const int num_clients = 4, per_client = 50;
+    std::atomic<int> wrong{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_clients; ++t) {
+        threads.emplace_back([&, t]() {
+            const int client = queue.register_client();
+            std::vector<int> tags(per_client, t);
+            core::Position pos;
+            pos.halfmove_clock = t;
+            for (int i = 0; i < per_client; ++i) queue.submit(client, pos, &tags[i]);
+
+            std::vector<EvalQueue::Completion> done;
+            while (static_cast<int>(done.size()) < per_client) queue.wait(client, done, std::chrono::microseconds(100000));
+            for (const auto& c : done) {
+                if (*static_cast<int*>(c.user_data) != t || c.result.value != static_cast<float>(t)) wrong++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    check(wrong == 0, "a client got a result for another client's position");
+    check(queue.evaluations() == static_cast<uint64_t>(num_clients * per_client), "not every position was evaluated");
+}
+
+void test_search_with_queue() {
+    std::cout << "Running test_search_with_queue..." << std::endl;
+    // a slow evaluator: the search threads have to keep several leaves in flight to fill the batches
+    RecordingEvaluator evaluator;
+    evaluator.delay = std::chrono::microseconds(300);
+
+    engine::Search search;
+    engine::EvalQueueConfig config;
+    config.max_batch_size = 16;
+    config.max_wait_us = 1000;
+    search.set_batch_evaluator(&evaluator, config);
+    search.set_num_threads(2);
+
+    core::Position pos;
+    core::Move best = search.find_best_move(pos, 300);
+
+    core::MoveGenerator move_gen;
+    std::vector<core::Move> legal_moves;
+    move_gen.generate_legal_moves(pos, legal_moves);
+    bool legal = std::any_of(legal_moves.begin(), legal_moves.end(), [&](const core::Move& m) {
+        return m.from_sq == best.from_sq && m.to_sq == best.to_sq && m.flags == best.flags;
+    });
+    check(legal, "the search with the queue returned an illegal move");
+
+    int biggest = evaluator.batch_sizes.empty() ? 0 : *std::max_element(evaluator.batch_sizes.begin(), evaluator.batch_sizes.end());
+    std::cout << "  " << evaluator.batch_sizes.size() << " batches, largest " << biggest << std::endl;
+    check(biggest > 1, "the search never had more than one leaf in flight");
+}
+
+int main() {
+    std::cout << "---===--- Eval queue test ---===---" << std::endl;
+    core::Zobrist::initialize_keys();
+    core::initialize_attack_tables();
+
+    test_full_batches();
+    test_partial_batch_timeout();
+    test_clients_get_their_own_results();
+    test_search_with_queue();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "All eval queue tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,597 @@
+// hyperion/src/cpp/search/test_search.cpp
+#include "core/position.hpp"
+#include "core/movegen.hpp"
+#include "core/zobrist.hpp"
+#include "core/bitboard.hpp"
+#include "nn_inference/encoder.hpp"
+#include "search/eval.hpp"
+#include "search/nn_evaluator.hpp"
+#include "search/pawn_hash.hpp"
+#include "search/search.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+---
+* Checks the MCTS search itself: PUCT selection with heuristic and evaluator priors, the leaf evaluators,
+  the playout generator, the MCTS-Solver, draw detection,
+  the incremental position keys, the pawn hash table and the periodic info lines
+
+* Build target: TestSearch
+* Run it:
+    *./bin/TestSearch*
+---
+*/
+
+using namespace hyperion;
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+static bool same_move(const core::Move& a, const core::Move& b) {
+    return a.from_sq == b.from_sq && a.to_sq == b.to_sq && a.flags == b.flags;
+}
+
+static std::vector<core::Move> legal_moves_of(const core::Position& pos) {
+    core::MoveGenerator move_gen;
+    std::vector<core::Move> moves;
+    move_gen.generate_legal_moves(pos, moves);
+    return moves;
+}
+
+// Every position is a dead draw, and the policy puts 90% on the first legal move
+class FirstMoveEvaluator : public engine::BatchEvaluator {
+public:
+    void evaluate_batch(const core::Position* positions, int count, engine::LeafEvaluation* results) override {
+        for (int i = 0; i < count; ++i) {
+            const size_t n = legal_moves_of(positions[i]).size();
+            results[i].value = 0.0f;
+            results[i].priors.assign(n, n > 1 ? 0.1f / static_cast<float>(n - 1) : 1.0f);
+            if (n > 1) results[i].priors[0] = 0.9f;
+        }
+    }
+};
+
+void test_heuristic_priors() {
+    std::cout << "Running test_heuristic_priors..." << std::endl;
+    core::Position pos;
+    // white can take the queen on d5 with the pawn or the knight, or play a quiet move
+    pos.set_from_fen("4k3/8/8/3q4/4P3/2N5/8/4K3 w - - 0 1");
+    std::vector<core::Move> moves = legal_moves_of(pos);
+    std::vector<float> priors;
+    engine::heuristic_priors(pos, moves, priors);
+
+    check(priors.size() == moves.size(), "one prior per move");
+    double sum = 0.0, pawn_takes = 0.0, knight_takes = 0.0, best_quiet = 0.0;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        sum += priors[i];
+        if (moves[i].is_capture() && moves[i].piece_moved == core::P_PAWN) pawn_takes = priors[i];
+        else if (moves[i].is_capture() && moves[i].piece_moved == core::P_KNIGHT) knight_takes = priors[i];
+        else best_quiet = std::max(best_quiet, static_cast<double>(priors[i]));
+    }
+    check(std::fabs(sum - 1.0) < 1e-5, "heuristic priors don't sum to 1");
+    check(pawn_takes > knight_takes && knight_takes > best_quiet, "captures should be ordered by MVV-LVA, above quiet moves");
+}
+
+void test_puct_finds_mate() {
+    std::cout << "Running test_puct_finds_mate..." << std::endl;
+    core::Position pos;
+    pos.set_from_fen("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"); // Ra8#
+
+    engine::Search search;
+    engine::SelectionConfig config;
+    config.mode = engine::SelectionMode::PUCT;
+    search.set_selection(config);
+    core::Move best = search.find_best_move(pos, 300);
+
+    check(best.from_sq == core::square_e::SQ_A1 && best.to_sq == core::square_e::SQ_A8, "PUCT missed the mate in 1");
+}
+
+void test_puct_follows_evaluator_priors() {
+    std::cout << "Running test_puct_follows_evaluator_priors..." << std::endl;
+    core::Position pos;
+    FirstMoveEvaluator evaluator;
+
+    engine::Search search;
+    engine::SelectionConfig config;
+    config.mode = engine::SelectionMode::PUCT;
+    search.set_selection(config);
+    search.set_batch_evaluator(&evaluator);
+    core::Move best = search.find_best_move(pos, 200);
+
+    // every value is 0, so the visits follow the priors
+    check(same_move(best, legal_moves_of(pos)[0]), "PUCT didn't follow the evaluator's priors");
+
+    // with searchmoves the root has fewer children than the network has priors, they still have to line up
+    const std::vector<core::Move> legal_moves = legal_moves_of(pos);
+    engine::SearchLimits limits;
+    limits.nodes = 200;
+    limits.search_moves = {legal_moves[5], legal_moves[0], legal_moves[10]};
+    best = search.find_best_move(pos, limits);
+    check(same_move(best, legal_moves[0]), "PUCT didn't follow the evaluator's priors under searchmoves");
+    const std::vector<engine::RootMove> root_moves = search.get_root_moves();
+    check(root_moves.size() == 3, "only the search moves should be at the root");
+    double sum = 0.0;
+    float first_prior = 0.0f;
+    for (const auto& root_move : root_moves) {
+        sum += root_move.prior;
+        if (same_move(root_move.move, legal_moves[0])) first_prior = root_move.prior;
+    }
+    check(first_prior > 0.95f && std::abs(sum - 1.0) < 1e-4, "the search moves should keep their network priors");
+}
+
+void test_leaf_evaluators() {
+    std::cout << "Running test_leaf_evaluators..." << std::endl;
+    engine::Rng gen(1);
+    core::Position mated;
+    mated.set_from_fen("R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 1 1"); // black is checkmated
+    check(engine::RandomPlayoutEvaluator{}.evaluate(mated, gen) == -1.0, "random playout: mate should be -1");
+    check(engine::TruncatedPlayoutEvaluator{}.evaluate(mated, gen) == -1.0, "truncated playout: mate should be -1");
+    check(engine::StaticEvaluator{}.evaluate(mated, gen) == -1.0, "static eval: mate should be -1");
+
+    core::Position up_a_queen;
+    up_a_queen.set_from_fen("4k3/8/8/8/8/8/8/3QK3 w - - 0 1");
+    const double value = engine::StaticEvaluator{}.evaluate(up_a_queen, gen);
+    check(value > 0.9 && value < 1.0, "static eval: a queen up should be close to 1 for the side to move");
+    up_a_queen.set_from_fen("4k3/8/8/8/8/8/8/3QK3 b - - 0 1");
+    check(engine::StaticEvaluator{}.evaluate(up_a_queen, gen) < -0.9, "static eval: should be from the side to move's view");
+
+    core::Position pos;
+    const std::vector<core::Move> root_moves = legal_moves_of(pos);
+    for (engine::LeafEvaluatorKind kind : {engine::LeafEvaluatorKind::RandomPlayout, engine::LeafEvaluatorKind::TruncatedPlayout,
+                                           engine::LeafEvaluatorKind::StaticEval}) {
+        engine::Search search;
+        search.set_leaf_evaluator(kind);
+        core::Move best = search.find_best_move(pos, 100);
+        bool legal = false;
+        for (const auto& m : root_moves) legal = legal || same_move(m, best);
+        check(legal, std::string("illegal move with leaf evaluator ") + engine::leaf_evaluator_name(kind));
+    }
+}
+
+void test_solver_stops_on_mate() {
+    std::cout << "Running test_solver_stops_on_mate..." << std::endl;
+    for (engine::SelectionMode mode : {engine::SelectionMode::UCT, engine::SelectionMode::PUCT}) {
+        core::Position pos;
+        pos.set_from_fen("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"); // Ra8#
+        engine::Search search;
+        engine::SelectionConfig config;
+        config.mode = mode;
+        search.set_selection(config);
+
+        const auto start = std::chrono::steady_clock::now();
+        core::Move best = search.find_best_move(pos, 5000);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        const std::string name = mode == engine::SelectionMode::UCT ? "UCT" : "PUCT";
+        check(best.from_sq == core::square_e::SQ_A1 && best.to_sq == core::square_e::SQ_A8, name + " missed the proven mate");
+        check(elapsed.count() < 1000, name + " didn't stop once the root was proven");
+    }
+}
+
+// Plays a move given in UCI notation, the move has to be legal
+static void play(core::Position& pos, const std::string& uci) {
+    for (const auto& m : legal_moves_of(pos)) {
+        if (core::square_to_algebraic(static_cast<int>(m.from_sq)) + core::square_to_algebraic(static_cast<int>(m.to_sq)) == uci) {
+            pos.make_move(m);
+            return;
+        }
+    }
+    check(false, "illegal test move " + uci);
+}
+
+void test_draw_detection() {
+    std::cout << "Running test_draw_detection..." << std::endl;
+    core::Position pos;
+    for (const char* uci : {"g1f3", "g8f6", "f3g1"}) play(pos, uci);
+    check(!pos.is_repetition(), "no repetition yet");
+    play(pos, "f6g8");
+    check(pos.is_repetition(), "the start position came back");
+    double result = 1.0;
+    check(engine::game_result(pos, legal_moves_of(pos), result) && result == 0.0, "a repetition is a draw");
+    play(pos, "e2e3");
+    for (const char* uci : {"g8f6", "g1f3", "f6g8", "f3g1"}) play(pos, uci);
+    check(pos.is_repetition(), "the position after e2e3 came back");
+    play(pos, "d7d6");
+    check(!pos.is_repetition(), "a pawn move makes a new position");
+
+    const char* dead[] = {"8/8/4k3/8/8/3K4/8/8 w - - 0 1", "8/8/4k3/8/8/3KN3/8/8 w - - 0 1",
+                          "8/8/4k3/8/8/3KB3/8/8 b - - 0 1", "8/2b5/4k3/8/8/3KB3/8/8 w - - 0 1"};
+    for (const char* fen : dead) {
+        pos.set_from_fen(fen);
+        check(pos.is_insufficient_material(), std::string("nobody can mate in ") + fen);
+    }
+    const char* alive[] = {"8/8/4k3/8/8/3KNN2/8/8 w - - 0 1", "8/3b4/4k3/8/8/3KB3/8/8 w - - 0 1",
+                           "8/8/4k3/8/8/3K4/4P3/8 w - - 0 1", "8/8/4k3/8/8/3KR3/8/8 w - - 0 1"};
+    for (const char* fen : alive) {
+        pos.set_from_fen(fen);
+        check(!pos.is_insufficient_material(), std::string("mate is still possible in ") + fen);
+    }
+}
+
+// Random games with captures, promotions, castling and en passant; after every make_move and unmake_move the
+// incremental pawn hash and material key must match the ones computed from scratch from the FEN
+void test_incremental_keys() {
+    std::cout << "Running test_incremental_keys..." << std::endl;
+    engine::Rng rng(5);
+    const char* fens[] = {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                          "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+                          "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
+    bool keys_match = true, restored = true;
+    for (const char* fen : fens) {
+        for (int game = 0; game < 20; ++game) {
+            core::Position pos;
+            pos.set_from_fen(fen);
+            std::vector<core::Move> played;
+            for (int ply = 0; ply < 120; ++ply) {
+                std::vector<core::Move> moves = legal_moves_of(pos);
+                if (moves.empty()) break;
+                played.push_back(moves[rng.bounded(static_cast<uint32_t>(moves.size()))]);
+                pos.make_move(played.back());
+
+                core::Position fresh;
+                fresh.set_from_fen(pos.to_fen());
+                keys_match = keys_match && pos.pawn_hash == fresh.pawn_hash && pos.material_key == fresh.material_key;
+            }
+            while (!played.empty()) {
+                pos.unmake_move(played.back());
+                played.pop_back();
+            }
+            core::Position start;
+            start.set_from_fen(fen);
+            restored = restored && pos.pawn_hash == start.pawn_hash && pos.material_key == start.material_key;
+        }
+    }
+    check(keys_match, "the incremental pawn hash or material key differs from the one computed from scratch");
+    check(restored, "unmake_move didn't restore the pawn hash or material key");
+
+    core::Position pos;
+    check(pos.get_piece_count(core::P_PAWN, core::WHITE) == 8 && pos.get_piece_count(core::P_KNIGHT, core::BLACK) == 2 &&
+          pos.get_piece_count(core::P_KING, core::BLACK) == 1, "wrong piece counts at the start");
+    core::Position moved_knight = pos;
+    play(moved_knight, "g1f3");
+    check(moved_knight.pawn_hash == pos.pawn_hash, "a knight move changed the pawn hash");
+}
+
+void test_pawn_structure() {
+    std::cout << "Running test_pawn_structure..." << std::endl;
+    using core::square_to_bitboard;
+    using core::square_e;
+    core::Position pos;
+    // white: d5 is passed and isolated, g2/g3 are doubled, f2 g2 g3 shield a king on g1
+    // black: a5 is passed and isolated, f7 g7 h7 shield a king on g8
+    pos.set_from_fen("6k1/5ppp/8/p2P4/8/6P1/5PP1/6K1 w - - 0 1");
+    engine::PawnEntry entry;
+    engine::analyze_pawns(pos, entry);
+
+    check(entry.passed[core::WHITE] == square_to_bitboard(square_e::SQ_D5), "d5 is white's only passed pawn");
+    check(entry.passed[core::BLACK] == square_to_bitboard(square_e::SQ_A5), "a5 is black's only passed pawn");
+    check(entry.doubled[core::WHITE] == square_to_bitboard(square_e::SQ_G3), "g3 is doubled (g2 is behind it)");
+    check(entry.isolated[core::WHITE] == square_to_bitboard(square_e::SQ_D5), "d5 is white's only isolated pawn");
+    check(entry.isolated[core::BLACK] == square_to_bitboard(square_e::SQ_A5), "a5 is black's only isolated pawn");
+    check(entry.shield[core::WHITE][6] == 10 * 2 + 5 * 1, "king on g1: f2 g2 close, g3 one rank up");
+    check(entry.shield[core::BLACK][6] == 10 * 3, "king on g8: f7 g7 h7");
+    check(entry.shield[core::WHITE][0] == 0, "nothing in front of a king on a1");
+
+    // the pawn structure changes rarely inside a search, so nearly every probe hits
+    engine::PawnHashTable& table = engine::thread_pawn_table();
+    table.reset_stats();
+    engine::Search search;
+    search.set_leaf_evaluator(engine::LeafEvaluatorKind::StaticEval);
+    core::Position middlegame;
+    middlegame.set_from_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    search.find_best_move(middlegame, 300);
+    check(table.lookups() > 100, "the static evaluation didn't use the pawn hash table");
+    check(table.hit_rate() > 80.0, "pawn hash hit rate only " + std::to_string(table.hit_rate()) + "%");
+}
+
+void test_rng() {
+    std::cout << "Running test_rng..." << std::endl;
+    engine::Rng a(42), b(42), c(43);
+    bool same = true, differs = false;
+    for (int i = 0; i < 100; ++i) {
+        const uint64_t x = a();
+        same = same && x == b();
+        differs = differs || x != c();
+    }
+    check(same, "the same seed should give the same sequence");
+    check(differs, "different seeds should give different sequences");
+
+    // every value of a small range shows up about equally often, and nothing falls outside it
+    const uint32_t range = 37;
+    const int draws = 37000;
+    std::vector<int> counts(range, 0);
+    bool in_range = true;
+    for (int i = 0; i < draws; ++i) {
+        const uint32_t v = a.bounded(range);
+        in_range = in_range && v < range;
+        if (v < range) counts[v]++;
+    }
+    check(in_range, "bounded returned a value outside the range");
+    double chi_square = 0.0;
+    for (int count : counts) chi_square += (count - 1000.0) * (count - 1000.0) / 1000.0;
+    check(chi_square < 80.0, "bounded isn't uniform (chi square " + std::to_string(chi_square) + ")"); // 36 dof, p ~ 1e-5
+    check(a.bounded(1) == 0, "bounded(1) should always be 0");
+}
+
+void test_tree_reuse() {
+    std::cout << "Running test_tree_reuse..." << std::endl;
+    engine::Search search;
+    search.set_leaf_evaluator(engine::LeafEvaluatorKind::StaticEval);
+    core::Position start;
+    const core::Move best = search.find_best_move(start, 300);
+    const core::Move ponder = search.get_ponder_move(best);
+    check(ponder.from_sq != core::square_e::NO_SQ, "there should be a reply to ponder on");
+    check(search.get_reused_visits() == 0, "the first search starts cold");
+
+    // ponderhit: the position after the expected reply is two plies below the old root
+    core::Position after_best = start;
+    after_best.make_move(best);
+    core::Position expected = after_best;
+    expected.make_move(ponder);
+    search.find_best_move(expected, 50);
+    check(search.get_reused_visits() > 0, "the ponder position should reuse the tree");
+
+    // ponder miss: another reply is found in what was left of the first tree
+    core::Move other;
+    for (const auto& m : legal_moves_of(after_best)) {
+        if (!same_move(m, ponder)) {
+            other = m;
+            break;
+        }
+    }
+    core::Position missed = after_best;
+    missed.make_move(other);
+    search.find_best_move(missed, 50);
+    check(search.get_reused_visits() > 0, "a ponder miss should reuse the rest of the old tree");
+
+    core::Position unrelated;
+    unrelated.set_from_fen("4k3/8/8/8/8/8/8/3QK3 w - - 0 1");
+    search.find_best_move(unrelated, 20);
+    check(search.get_reused_visits() == 0, "an unrelated position starts cold");
+}
+
+void test_time_manager() {
+    std::cout << "Running test_time_manager..." << std::endl;
+    engine::TimeControl sudden_death;
+    sudden_death.time_left_ms = 60000;
+    const engine::TimeLimits base = engine::compute_time_limits(sudden_death);
+    check(base.adaptive && base.soft_ms > 0 && base.soft_ms < base.hard_ms && base.hard_ms < 60000, "soft < hard < time left");
+
+    engine::TimeControl with_increment = sudden_death;
+    with_increment.increment_ms = 1000;
+    check(engine::compute_time_limits(with_increment).soft_ms > base.soft_ms, "an increment should give more time per move");
+
+    engine::TimeControl last_move = sudden_death;
+    last_move.time_left_ms = 1000;
+    last_move.moves_to_go = 1;
+    const engine::TimeLimits before_control = engine::compute_time_limits(last_move);
+    check(before_control.hard_ms < 1000 - last_move.move_overhead_ms, "the last move before the control must not flag");
+    check(before_control.soft_ms > 500, "the last move before the control can use most of the time");
+
+    engine::TimeControl fixed;
+    fixed.move_time_ms = 500;
+    const engine::TimeLimits exact = engine::compute_time_limits(fixed);
+    check(!exact.adaptive && exact.hard_ms == 500 - fixed.move_overhead_ms, "movetime is exact, minus the overhead");
+    check(!engine::compute_time_limits(engine::TimeControl()).is_limited(), "no clock, no limit");
+
+    using ms = std::chrono::milliseconds;
+    engine::TimeLimits limits;
+    limits.soft_ms = 1000;
+    limits.hard_ms = 4000;
+    limits.adaptive = true;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // a lead that can't be caught up before the soft limit stops the search early
+    engine::TimeManager decided;
+    decided.start(limits, t0);
+    check(!decided.should_stop({0, 10, 5, 20}, t0), "nothing is decided at the start");
+    check(!decided.should_stop({0, 600, 500, 1100}, t0 + ms(200)), "a close race goes on");
+    check(decided.should_stop({0, 10000, 10, 10100}, t0 + ms(900)), "an unassailable lead should stop the search");
+
+    // at the soft limit a best move with a small share of the visits gets more time, but never past the hard limit
+    engine::TimeManager unstable;
+    unstable.start(limits, t0);
+    unstable.should_stop({0, 10, 5, 20}, t0);
+    check(!unstable.should_stop({0, 400, 390, 1000}, t0 + ms(1000)), "an unstable best move should extend the search");
+    check(unstable.should_stop({0, 4000, 3900, 10000}, t0 + ms(4000)), "the hard limit always stops");
+
+    engine::TimeManager stable;
+    stable.start(limits, t0);
+    stable.should_stop({0, 10, 5, 20}, t0);
+    check(stable.should_stop({0, 800, 150, 1000}, t0 + ms(1000)), "a stable best move stops at the soft limit");
+}
+
+void test_search_limits() {
+    std::cout << "Running test_search_limits..." << std::endl;
+    core::Position start;
+
+    // a fixed number of simulations with a fixed seed is the same search on every machine
+    engine::SearchLimits nodes;
+    nodes.nodes = 500;
+    core::Move first_best;
+    for (int run = 0; run < 2; ++run) {
+        engine::Search search;
+        search.set_seed(7);
+        search.set_leaf_evaluator(engine::LeafEvaluatorKind::StaticEval);
+        const core::Move best = search.find_best_move(start, nodes);
+        check(search.get_iterations() == 500, "a node limited search should run exactly that many simulations");
+        if (run == 0) first_best = best;
+        else check(same_move(best, first_best), "the same seed and node count should give the same move");
+    }
+
+    engine::Search search;
+    search.set_leaf_evaluator(engine::LeafEvaluatorKind::StaticEval);
+    engine::SearchLimits depth;
+    depth.depth = 3;
+    search.find_best_move(start, depth);
+    check(search.get_max_depth() == 3, "a depth limited search should stop at that tree depth");
+
+    engine::SearchLimits only_a3;
+    only_a3.nodes = 200;
+    for (const auto& m : legal_moves_of(start)) {
+        if (m.from_sq == core::square_e::SQ_A2 && m.to_sq == core::square_e::SQ_A3) only_a3.search_moves.push_back(m);
+    }
+    check(same_move(search.find_best_move(start, only_a3), only_a3.search_moves[0]), "searchmoves should restrict the root");
+    check(!same_move(search.find_best_move(start, nodes), only_a3.search_moves[0]), "the next search sees every move again");
+
+    core::Position mate_in_two;
+    mate_in_two.set_from_fen("7k/8/8/8/8/8/R7/1R5K w - - 0 1"); // 1.Ra7 Kg8 2.Rb8# (or 1.Rb7 Kg8 2.Ra8#)
+    engine::SearchLimits mate;
+    mate.mate = 2;
+    search.find_best_move(mate_in_two, mate);
+    check(search.get_mate_in() == 2, "the solver should prove the mate in 2");
+    // without a mate to find the search still ends, on its time budget
+    mate.mate = 1;
+    const auto mate_start = std::chrono::steady_clock::now();
+    search.find_best_move(start, mate);
+    const auto mate_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mate_start);
+    check(search.get_mate_in() == 0 && mate_ms.count() >= engine::MATE_TIME_PER_MOVE_MS - 50 &&
+          mate_ms.count() < engine::MATE_TIME_PER_MOVE_MS + 500, "a mate search without a mate should end on its time budget");
+}
+
+void test_network_evaluator() {
+    std::cout << "Running test_network_evaluator..." << std::endl;
+    engine::NetworkEvaluator evaluator(1);
+    engine::EvalCache& cache = *evaluator.get_cache();
+    nn::NetworkShape shape;
+    shape.num_blocks = 1;
+    shape.num_filters = 16;
+    evaluator.init_random(shape, 3);
+
+    core::Position positions[2];
+    positions[1].set_from_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    engine::LeafEvaluation results[2];
+    evaluator.evaluate_batch(positions, 2, results);
+    for (int i = 0; i < 2; ++i) {
+        double sum = 0.0;
+        for (float p : results[i].priors) sum += p;
+        check(results[i].priors.size() == legal_moves_of(positions[i]).size(), "one prior per legal move");
+        check(std::fabs(sum - 1.0) < 1e-4, "network priors don't sum to 1");
+        check(results[i].value >= -1.0f && results[i].value <= 1.0f, "network value out of range");
+    }
+
+    // the second time both come from the cache
+    engine::LeafEvaluation cached[2];
+    evaluator.evaluate_batch(positions, 2, cached);
+    check(cache.hits() == 2 && cached[0].cached && !results[0].cached, "the second evaluation should hit the cache");
+    check(std::fabs(cached[1].value - results[1].value) < 1e-6, "cached value differs");
+
+    // INT8 needs the calibration, and changing the precision drops the cached FP32 evaluations
+    check(!evaluator.set_precision(nn::Precision::INT8) && evaluator.get_precision() == nn::Precision::FP32,
+          "INT8 without a calibration should be refused");
+    std::vector<float> planes(nn::INPUT_FLOATS * 2);
+    nn::encode_position(positions[0], planes.data());
+    nn::encode_position(positions[1], planes.data() + nn::INPUT_FLOATS);
+    evaluator.get_network().calibrate(planes.data(), 2);
+    check(evaluator.set_precision(nn::Precision::INT8) && evaluator.get_precision() == nn::Precision::INT8,
+          "a calibrated network should switch to INT8");
+    engine::LeafEvaluation int8_results[2];
+    evaluator.evaluate_batch(positions, 2, int8_results);
+    check(!int8_results[0].cached && !int8_results[1].cached, "the precision change should clear the cache");
+    check(evaluator.set_precision(nn::Precision::FP32), "back to FP32");
+    evaluator.evaluate_batch(positions, 2, results);
+
+    engine::Search search;
+    engine::SelectionConfig config;
+    config.mode = engine::SelectionMode::PUCT;
+    search.set_selection(config);
+    search.set_batch_evaluator(&evaluator);
+    check(search.get_leaf_evaluator() == engine::LeafEvaluatorKind::Network, "a batch evaluator should select the network");
+    std::vector<std::string> lines;
+    search.set_info_sink([&lines](const std::string& line) { lines.push_back(line); });
+    core::Position pos;
+    core::Move best = search.find_best_move(pos, 200);
+    bool reported = false;
+    for (const auto& line : lines) {
+        // the start position was evaluated above, so at least the root comes from the evaluator's cache
+        reported = reported || (line.rfind("info string evalcache hits ", 0) == 0 && line.find(" hits 0 ") == std::string::npos);
+    }
+    check(reported, "the search should report the evaluator's cache");
+    bool legal = false;
+    for (const auto& m : legal_moves_of(pos)) legal = legal || same_move(m, best);
+    check(legal, "the network search returned an illegal move");
+}
+
+void test_info_output() {
+    std::cout << "Running test_info_output..." << std::endl;
+    check(engine::q_to_centipawns(0.0) == 0, "an even Q should be 0 cp");
+    check(engine::q_to_centipawns(0.5) > 50 && engine::q_to_centipawns(0.5) < 200, "Q 0.5 should be about a pawn");
+    check(engine::q_to_centipawns(-0.5) == -engine::q_to_centipawns(0.5), "the score should be symmetric");
+    check(engine::q_to_centipawns(1.0) > engine::q_to_centipawns(0.9), "the score should grow with Q");
+
+    std::vector<std::string> lines;
+    engine::Search search;
+    search.set_leaf_evaluator(engine::LeafEvaluatorKind::StaticEval);
+    search.set_info_sink([&lines](const std::string& line) { lines.push_back(line); });
+    search.set_info_interval(50);
+    core::Position start;
+    search.find_best_move(start, 300);
+
+    int depth_lines = 0;
+    for (const auto& line : lines) {
+        if (line.rfind("info depth ", 0) != 0) continue;
+        depth_lines++;
+        check(line.find(" nps ") != std::string::npos && line.find(" hashfull ") != std::string::npos &&
+              line.find(" score cp ") != std::string::npos && line.find(" pv ") != std::string::npos,
+              "an info line should have nps, hashfull, score and pv: " + line);
+    }
+    check(depth_lines >= 4, "a 300 ms search should write an info line every 50 ms and one at the end");
+    const std::vector<core::Move> pv = search.get_principal_variation();
+    bool legal = false;
+    for (const auto& m : legal_moves_of(start)) legal = legal || (!pv.empty() && same_move(m, pv[0]));
+    check(legal, "the pv should start with a root move");
+
+    // MultiPV only changes the output: the ranked root moves, best first
+    lines.clear();
+    search.set_info_interval(0);
+    search.set_multi_pv(3);
+    engine::SearchLimits nodes;
+    nodes.nodes = 500;
+    const core::Move best = search.find_best_move(start, nodes);
+    const std::vector<engine::RootMove> root_moves = search.get_root_moves(3);
+    check(root_moves.size() == 3 && same_move(root_moves[0].move, best), "the first root move should be the best move");
+    check(root_moves.size() == 3 && root_moves[0].visits >= root_moves[1].visits && root_moves[1].visits >= root_moves[2].visits,
+          "the root moves should be ranked by visits");
+    check(search.get_root_moves().size() == legal_moves_of(start).size(), "every root move should be listed");
+    int multipv_lines = 0;
+    for (const auto& line : lines) multipv_lines += line.find(" multipv ") != std::string::npos;
+    check(multipv_lines == 3, "the final info should have a line per MultiPV move");
+}
+
+int main() {
+    std::cout << "---===--- Search test ---===---" << std::endl;
+    core::Zobrist::initialize_keys();
+    core::initialize_attack_tables();
+
+    test_heuristic_priors();
+    test_puct_finds_mate();
+    test_puct_follows_evaluator_priors();
+    test_leaf_evaluators();
+    test_solver_stops_on_mate();
+    test_draw_detection();
+    test_incremental_keys();
+    test_pawn_structure();
+    test_rng();
+    test_tree_reuse();
+    test_time_manager();
+    test_search_limits();
+    test_info_output();
+    test_network_evaluator();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "All search tests passed" << std::endl;
+    return 0;
+}
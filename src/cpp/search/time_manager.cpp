@@ -0,0 +1,109 @@
+#include "time_manager.hpp"
+#include <algorithm>
+
+namespace hyperion {
+namespace engine {
+
+// Moves the remaining time is spread over when the time control doesn't say (sudden death, increment)
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+// A larger movestogo isn't trusted further than this, the time after the control is still needed
+constexpr int MAX_MOVES_TO_GO = 50;
+// The hard limit is this many soft limits, but never more than this share of the usable time
+constexpr int HARD_LIMIT_FACTOR = 4;
+constexpr double MAX_SHARE_OF_TIME_LEFT = 0.75;
+// Used of the increment, the rest builds a small reserve
+constexpr double INCREMENT_SHARE = 0.75;
+
+// Nothing is decided before this share of the soft limit has passed, the visit rate isn't known yet
+constexpr double MIN_SHARE_BEFORE_EARLY_STOP = 0.1;
+// At the soft limit the best move is unstable if it has less than this share of the visits,
+// or if it became the best move during the last STABLE_SHARE_OF_ELAPSED of the search
+constexpr double STABLE_VISIT_SHARE = 0.5;
+constexpr double STABLE_SHARE_OF_ELAPSED = 0.25;
+// Each extension adds half the original soft limit, up to the hard limit
+constexpr int MAX_EXTENSIONS = 3;
+
+//--
+/* compute_time_limits */
+//--
+//   usable = time left - move overhead
+//   soft   = usable / moves to go + 3/4 of the increment
+//   hard   = min(4 * soft, 3/4 of usable)
+// With movetime both limits are movetime - move overhead and nothing adaptive happens
+TimeLimits compute_time_limits(const TimeControl& control) {
+    TimeLimits limits;
+    if (control.move_time_ms >= 0) {
+        limits.hard_ms = limits.soft_ms = std::max(1, control.move_time_ms - control.move_overhead_ms);
+        return limits;
+    }
+    if (control.time_left_ms < 0) return limits;
+
+    const int usable = std::max(1, control.time_left_ms - control.move_overhead_ms);
+    const int moves_to_go = control.moves_to_go > 0 ? std::min(control.moves_to_go, MAX_MOVES_TO_GO) : DEFAULT_MOVES_TO_GO;
+    const int max_time = std::max(1, static_cast<int>(usable * MAX_SHARE_OF_TIME_LEFT));
+
+    const int soft = usable / moves_to_go + static_cast<int>(control.increment_ms * INCREMENT_SHARE);
+    limits.hard_ms = std::min(HARD_LIMIT_FACTOR * soft, max_time);
+    limits.soft_ms = std::max(1, std::min(soft, limits.hard_ms));
+    limits.adaptive = true;
+    return limits;
+}
+
+//--
+/* TimeManager::start */
+//--
+void TimeManager::start(const TimeLimits& limits, Clock::time_point now) {
+    current = limits;
+    start_time = now;
+    soft_deadline = now + std::chrono::milliseconds(limits.soft_ms);
+    hard_deadline = now + std::chrono::milliseconds(limits.hard_ms);
+    extensions = 0;
+    has_baseline = false;
+    last_best_index = -1;
+}
+
+//--
+/* TimeManager::should_stop */
+//--
+// Stops early when the best move's lead is larger than the visits the search can still make before the soft
+// limit, so no other move can overtake it. At the soft limit it extends (up to the hard limit) when the best move
+// is unstable: it has too small a share of the visits, or it only just took over
+bool TimeManager::should_stop(const RootStats& root, Clock::time_point now) {
+    if (!current.is_limited()) return false;
+    if (now >= hard_deadline) return true;
+    if (!current.adaptive) return false;
+
+    if (!has_baseline) {
+        has_baseline = true;
+        baseline_time = now;
+        baseline_visits = root.total_visits;
+    }
+    if (root.best_index != last_best_index) {
+        last_best_index = root.best_index;
+        last_best_change = now;
+    }
+    if (root.best_index < 0) return false;
+
+    using ms = std::chrono::duration<double, std::milli>;
+    const double elapsed = ms(now - start_time).count();
+    if (elapsed >= current.soft_ms * MIN_SHARE_BEFORE_EARLY_STOP && now < soft_deadline) {
+        const double measured = ms(now - baseline_time).count();
+        const double visits_per_ms = measured > 0.0 ? (root.total_visits - baseline_visits) / measured : 0.0;
+        const double visits_left = visits_per_ms * ms(soft_deadline - now).count();
+        if (visits_per_ms > 0.0 && root.best_visits - root.second_visits > visits_left) return true;
+    }
+
+    if (now < soft_deadline) return false;
+
+    const bool small_share = root.best_visits < STABLE_VISIT_SHARE * root.total_visits;
+    const bool recent_change = ms(now - last_best_change).count() < STABLE_SHARE_OF_ELAPSED * elapsed;
+    if ((small_share || recent_change) && extensions < MAX_EXTENSIONS && soft_deadline < hard_deadline) {
+        extensions++;
+        soft_deadline = std::min(hard_deadline, soft_deadline + std::chrono::milliseconds(current.soft_ms / 2));
+        return false;
+    }
+    return true;
+}
+
+} // namespace engine
+} // namespace hyperion
@@ -0,0 +1,88 @@
+#ifndef HYPERION_ENGINE_TIME_MANAGER_HPP
+#define HYPERION_ENGINE_TIME_MANAGER_HPP
+
+#include <chrono>
+
+namespace hyperion {
+namespace engine {
+
+// Default for the UCI "Move Overhead" option: time lost per move to the GUI and the connection, in ms
+constexpr int DEFAULT_MOVE_OVERHEAD_MS = 30;
+
+//--
+/* struct TimeControl */
+//--
+// The clock fields of a UCI "go", for the side to move. -1 means the field wasn't sent
+struct TimeControl {
+    int time_left_ms = -1; // wtime / btime
+    int increment_ms = 0;  // winc / binc
+    int moves_to_go = 0;   // moves until the next time control, 0 = the rest of the game
+    int move_time_ms = -1; // movetime: exactly this long
+    int move_overhead_ms = DEFAULT_MOVE_OVERHEAD_MS;
+
+    bool has_clock() const { return time_left_ms >= 0 || move_time_ms >= 0; }
+};
+
+//--
+/* struct TimeLimits */
+//--
+// soft: the time the search plans to use. It stops earlier when the best move is decided, and goes on past it
+// when the best move is unstable
+// hard: never searched past, whatever the root looks like
+struct TimeLimits {
+    int soft_ms = -1; // < 0: no limit
+    int hard_ms = -1;
+    bool adaptive = false; // false: stop at the hard limit exactly (movetime)
+
+    bool is_limited() const { return hard_ms >= 0; }
+};
+
+// Splits the remaining time over the moves still to play, see time_manager.cpp
+TimeLimits compute_time_limits(const TimeControl& control);
+
+//--
+/* struct RootStats */
+//--
+// What the time manager looks at: the root's children by visits
+struct RootStats {
+    int best_index = -1; // the most visited child, -1 if the root has no children yet
+    int best_visits = 0;
+    int second_visits = 0;
+    int total_visits = 0; // of all children together
+};
+
+//--
+/* class TimeManager */
+//--
+// Decides when a search with TimeLimits is done. The search calls should_stop every few ms with its root
+// Not thread safe, the search only calls it under its tree lock
+class TimeManager {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // The limits count from now
+    void start(const TimeLimits& limits, Clock::time_point now);
+    bool should_stop(const RootStats& root, Clock::time_point now);
+
+    const TimeLimits& limits() const { return current; }
+
+private:
+    TimeLimits current;
+    Clock::time_point start_time;
+    Clock::time_point soft_deadline;
+    Clock::time_point hard_deadline;
+    int extensions = 0;
+
+    // The visit rate is measured from the first call on, the tree may have been reused with visits from before
+    bool has_baseline = false;
+    Clock::time_point baseline_time;
+    int baseline_visits = 0;
+
+    int last_best_index = -1;
+    Clock::time_point last_best_change;
+};
+
+} // namespace engine
+} // namespace hyperion
+
+#endif // HYPERION_ENGINE_TIME_MANAGER_HPP
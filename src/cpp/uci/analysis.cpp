@@ -0,0 +1,46 @@
+#include "analysis.hpp"
+#include "core/bitboard.hpp"
+
+#include <cstdio>
+
+namespace hyperion {
+namespace uci {
+
+// Fixed notation with a '.', whatever the locale's number format would be
+static std::string json_number(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.4f", value);
+    return text;
+}
+
+//--
+/* analysis_to_json */
+//--
+// The FEN and the UCI moves never contain a '"' or a '\\', so nothing needs escaping
+std::string analysis_to_json(const core::Position& pos, const engine::Search& search) {
+    std::string json = "{\"fen\":\"" + pos.to_fen() + "\",\"nodes\":" + std::to_string(search.get_iterations()) +
+                       ",\"depth\":" + json_number(search.get_average_depth()) +
+                       ",\"seldepth\":" + std::to_string(search.get_max_depth()) + ",\"moves\":[";
+
+    const std::vector<engine::RootMove> moves = search.get_root_moves(search.get_multi_pv());
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const engine::RootMove& move = moves[i];
+        std::string score = "{\"cp\":" + std::to_string(engine::q_to_centipawns(move.q)) + "}";
+        if (move.proof == engine::Proof::Win) score = "{\"mate\":" + std::to_string((move.mate_plies + 1) / 2) + "}";
+        else if (move.proof == engine::Proof::Loss) score = "{\"mate\":-" + std::to_string((move.mate_plies + 1) / 2) + "}";
+        else if (move.proof == engine::Proof::Draw) score = "{\"cp\":0}";
+
+        json += i > 0 ? ",{" : "{";
+        json += "\"move\":\"" + core::move_to_uci_string(move.move) + "\",\"visits\":" + std::to_string(move.visits) +
+                ",\"q\":" + json_number(move.q) + ",\"prior\":" + json_number(move.prior) + ",\"score\":" + score +
+                ",\"pv\":[";
+        for (size_t j = 0; j < move.pv.size(); ++j) {
+            json += (j > 0 ? ",\"" : "\"") + core::move_to_uci_string(move.pv[j]) + "\"";
+        }
+        json += "]}";
+    }
+    return json + "]}";
+}
+
+} // namespace uci
+} // namespace hyperion
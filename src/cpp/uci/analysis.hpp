@@ -0,0 +1,21 @@
+#ifndef HYPERION_UCI_ANALYSIS_HPP
+#define HYPERION_UCI_ANALYSIS_HPP
+
+#include "core/position.hpp"
+#include "search/search.hpp"
+
+#include <string>
+
+namespace hyperion {
+namespace uci {
+
+// The finished search's MultiPV moves as one line of JSON, for batch consumers (the AnalysisJSON option):
+//   {"fen":..., "nodes":..., "depth":..., "seldepth":...,
+//    "moves":[{"move":"e2e4", "visits":..., "q":..., "prior":..., "score":{"cp":...} or {"mate":...}, "pv":[...]}]}
+// The moves are get_root_moves(search.get_multi_pv()), best first. pos is the root of the search
+std::string analysis_to_json(const core::Position& pos, const engine::Search& search);
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_ANALYSIS_HPP
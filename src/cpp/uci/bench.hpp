@@ -0,0 +1,50 @@
+#ifndef HYPERION_UCI_BENCH_HPP
+#define HYPERION_UCI_BENCH_HPP
+
+#include "search/eval.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+// Simulations per bench position when "bench" doesn't say
+constexpr int DEFAULT_BENCH_NODES = 1000;
+
+//--
+/* struct BenchConfig */
+//--
+// What the bench searches with. Everything else is fixed (one thread, UCT, seed 1, a fresh tree per position),
+// so the same build with the same config always gives the same signature
+struct BenchConfig {
+    int nodes = DEFAULT_BENCH_NODES;
+    engine::LeafEvaluatorKind leaf_evaluator = engine::LeafEvaluatorKind::StaticEval;
+};
+
+//--
+/* struct BenchResult */
+//--
+struct BenchResult {
+    uint64_t nodes = 0;     // simulations over all positions
+    uint64_t signature = 0; // hash of every position's best move, simulations and depth
+    int64_t time_ms = 0;
+};
+
+// The built-in positions: openings, middlegames, endgames and short mates
+const std::vector<std::string>& bench_positions();
+
+// "bench [nodes] [leafeval]", false (with the reason in error) if an argument doesn't fit
+bool parse_bench_args(std::istream& args, BenchConfig& config, std::string& error);
+
+// Searches every bench position and writes a line per position, then the totals:
+//   Nodes searched, Nodes/second and the Signature. A change to the signature means the search behaves differently
+BenchResult run_bench(const BenchConfig& config, const std::function<void(const std::string&)>& output);
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_BENCH_HPP
@@ -1 +1,281 @@
+#include "engine.hpp"
+#include "uci.hpp"
+#include "analysis.hpp"
+#include "core/bitboard.hpp"
 
+namespace hyperion {
+namespace uci {
+
+//--
+/* SharedResources::SharedResources */
+//--
+SharedResources::SharedResources(int workers, size_t eval_cache_mb)
+    : pool(workers), network(eval_cache_mb), eval_queue(network, engine::EvalQueueConfig()) {}
+
+//--
+/* Engine::Engine */
+//--
+// A session of a host doesn't need a network (and evaluation cache) of its own, it uses the shared one
+Engine::Engine(OutputFn out, SharedResources* shared_resources)
+    : output(std::move(out)), shared(shared_resources),
+      own_network(shared_resources ? 0 : engine::DEFAULT_EVAL_CACHE_MB),
+      network(shared_resources ? &shared_resources->network : &own_network),
+      own_pool(shared_resources ? nullptr : std::make_unique<WorkerPool>(1)),
+      pool(shared_resources ? &shared_resources->pool : own_pool.get()) {
+    search.set_info_sink(output);
+    register_options();
+}
+
+Engine::~Engine() {
+    stop_and_wait();
+}
+
+//--
+/* Engine::register_options */
+//--
+// Every option starts out at its default, which is also what the search starts with
+//   Hash: the network evaluation cache in MB, the table the search's memory goes to (the node transposition table
+//         only indexes the tree, it grows with it). Threads: search threads sharing the tree
+//   MultiPV: how many root moves the info lines show. AnalysisJSON: after every search, those moves with their
+//   visits, Q, prior and pv as one "info string analysis {...}" line. Seed: playout generators, 0 = random
+//   Move Overhead: time the GUI and the connection lose per move, taken off every time limit
+//   Selection/CUct/CPuct/FPUReduction: the selection rule and its constants. LeafEval/PlayoutDepth: how leaves
+//   are scored. WeightsFile: the network for LeafEval NN. NNPrecision: FP32, or INT8 when the weight file has the
+//   calibration. Ponder: only tells us the GUI may send "go ponder"
+// Hash, Threads, WeightsFile and NNPrecision are the host's with shared resources: every session searches on one
+// thread
+void Engine::register_options() {
+    if (!shared) {
+        options.add_spin("Hash", static_cast<int>(engine::DEFAULT_EVAL_CACHE_MB), 1, 65536,
+                         [this](const Option& o) { own_network.get_cache()->resize(static_cast<size_t>(o.as_int())); });
+        options.add_spin("Threads", 1, 1, 256, [this](const Option& o) { search.set_num_threads(o.as_int()); });
+    }
+    options.add_spin("MultiPV", 1, 1, 256, [this](const Option& o) { search.set_multi_pv(o.as_int()); });
+    options.add_check("AnalysisJSON", false, [this](const Option& o) { analysis_json = o.as_bool(); });
+    options.add_spin("Seed", 0, 0, 2147483647, [this](const Option& o) { search.set_seed(static_cast<uint64_t>(o.as_int())); });
+    options.add_spin("Move Overhead", engine::DEFAULT_MOVE_OVERHEAD_MS, 0, 5000,
+                     [this](const Option& o) { move_overhead_ms = o.as_int(); });
+    options.add_check("Ponder", false);
+
+    const engine::SelectionConfig defaults;
+    auto number = [](double value) {
+        std::string text = std::to_string(value);
+        text.erase(text.find_last_not_of('0') + 1);
+        if (text.back() == '.') text.pop_back();
+        return text;
+    };
+    options.add_combo("Selection", "UCT", {"UCT", "PUCT"}, [this](const Option& o) {
+        engine::SelectionConfig selection = search.get_selection();
+        selection.mode = o.value == "PUCT" ? engine::SelectionMode::PUCT : engine::SelectionMode::UCT;
+        search.set_selection(selection);
+    });
+    options.add_string("CUct", number(defaults.c_uct), [this](const Option& o) {
+        engine::SelectionConfig selection = search.get_selection();
+        selection.c_uct = o.as_double();
+        search.set_selection(selection);
+    });
+    options.add_string("CPuct", number(defaults.c_puct), [this](const Option& o) {
+        engine::SelectionConfig selection = search.get_selection();
+        selection.c_puct = o.as_double();
+        search.set_selection(selection);
+    });
+    options.add_string("FPUReduction", number(defaults.fpu_reduction), [this](const Option& o) {
+        engine::SelectionConfig selection = search.get_selection();
+        selection.fpu_reduction = o.as_double();
+        search.set_selection(selection);
+    });
+
+    options.add_combo("LeafEval", engine::leaf_evaluator_name(engine::LeafEvaluatorKind::RandomPlayout),
+                      {"Playout", "TruncatedPlayout", "StaticEval", "NN"}, [this](const Option& o) {
+        engine::LeafEvaluatorKind kind;
+        engine::parse_leaf_evaluator(o.value, kind);
+        search.set_batch_evaluator(nullptr);
+        search.set_eval_queue(nullptr);
+        search.set_leaf_evaluator(kind);
+        if (kind != engine::LeafEvaluatorKind::Network) return;
+        if (!network->is_loaded()) output(shared ? "info string the host has no network loaded" : "info string no network loaded yet, set WeightsFile");
+        else if (shared) search.set_eval_queue(&shared->eval_queue);
+        else search.set_batch_evaluator(network);
+    });
+    options.add_spin("PlayoutDepth", engine::DEFAULT_PLAYOUT_PLIES, 1, 200,
+                     [this](const Option& o) { search.set_playout_plies(o.as_int()); });
+    if (shared) return;
+    options.add_string("WeightsFile", "", [this](const Option& o) {
+        if (o.value.empty()) return;
+        if (network->load(o.value)) {
+            output("info string loaded network " + o.value);
+            if (!network->error().empty()) output("info string " + network->error());
+            if (search.get_leaf_evaluator() == engine::LeafEvaluatorKind::Network) {
+                search.set_batch_evaluator(network);
+            }
+        } else {
+            output("info string could not load network: " + network->error());
+        }
+    });
+    options.add_combo("NNPrecision", "FP32", {"FP32", "INT8"}, [this](const Option& o) {
+        const nn::Precision precision = o.value == "INT8" ? nn::Precision::INT8 : nn::Precision::FP32;
+        if (!network->set_precision(precision)) output("info string " + network->error());
+    });
+}
+
+//--
+/* Engine::print_id_and_options */
+//--
+void Engine::print_id_and_options() const {
+    output("id name Hyperion 0.1.0-beta");
+    output("id author Tom and LJ");
+    for (const auto& option : options.all()) output(option.to_uci());
+    output("uciok");
+}
+
+//--
+/* Engine::set_option */
+//--
+bool Engine::set_option(const std::string& name, const std::string& value) {
+    stop_and_wait();
+
+    std::string error;
+    if (options.set(name, value, error)) return true;
+    output("info string " + error);
+    return false;
+}
+
+//--
+/* Engine::new_game / set_position */
+//--
+void Engine::new_game() {
+    stop_and_wait();
+    position = core::Position();
+    search.clear_tree();
+}
+
+void Engine::set_position(const core::Position& pos) {
+    stop_and_wait();
+    position = pos;
+}
+
+//--
+/* Engine::go */
+//--
+// The time limits are set here and not in the search job, so they count from the go command (not from when a
+// worker is free), and a stop or ponderhit that arrives before the job has started is not lost
+void Engine::go(const SearchRequest& new_request) {
+    stop_and_wait();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    request = new_request;
+    request.clock.move_overhead_ms = move_overhead_ms;
+    request.limits.time = engine::compute_time_limits(request.clock);
+    stop_requested = false;
+    pondering = request.ponder;
+    search.clear_stop();
+
+    // the clock only starts with the ponderhit
+    engine::SearchLimits search_limits = request.limits;
+    if (request.ponder) search_limits.time = engine::TimeLimits();
+    search.set_limits(search_limits);
+
+    const engine::TimeLimits& time = search_limits.time;
+    if (!search_limits.infinite && time.is_limited()) {
+        output("info string search started with time limits soft " + std::to_string(time.soft_ms) + "ms hard " +
+               std::to_string(time.hard_ms) + "ms");
+    }
+    searching = true;
+    finished = false;
+    pool->post([this] { run_search(); });
+}
+
+//--
+/* Engine::stop */
+//--
+void Engine::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!searching) return;
+    stop_requested = true;
+    search.stop();
+    if (finished) write_bestmove();
+}
+
+//--
+/* Engine::ponderhit */
+//--
+void Engine::ponderhit() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!searching || !pondering) return;
+    pondering = false;
+    if (request.limits.infinite) return;
+    search.set_time_limits(request.limits.time);
+    if (finished) write_bestmove();
+}
+
+//--
+/* Engine::wait / finish / stop_unbounded / is_searching */
+//--
+void Engine::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    state_changed.wait(lock, [this] { return !searching; });
+}
+
+void Engine::finish() {
+    stop_unbounded();
+    wait();
+}
+
+void Engine::stop_unbounded() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (searching && (request.limits.infinite || pondering)) {
+        stop_requested = true;
+        search.stop();
+        if (finished) write_bestmove();
+    }
+}
+
+bool Engine::is_searching() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return searching;
+}
+
+void Engine::stop_and_wait() {
+    stop();
+    wait();
+}
+
+//--
+/* Engine::run_search */
+//--
+// Searches, and writes the bestmove with the expected reply to ponder on. The search keeps its tree, so the next
+// go (after a ponderhit, or the reply that was really played) starts from the right subtree. UCI doesn't allow a
+// bestmove during "go infinite" or before the ponderhit of "go ponder", so when such a search ends early (the root
+// is proven) the job leaves the bestmove to stop() or ponderhit() instead of holding a worker until then
+void Engine::run_search() {
+    core::Position root;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        root = position;
+    }
+    const core::Move best_move = search.run(root);
+    const core::Move ponder_move = search.get_ponder_move(best_move);
+    if (analysis_json) output("info string analysis " + analysis_to_json(root, search));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // a null move (0000) only when the root has no legal moves: mate or stalemate
+    bestmove = "bestmove " + core::move_to_uci_string(best_move);
+    if (ponder_move.from_sq != core::square_e::NO_SQ) bestmove += " ponder " + core::move_to_uci_string(ponder_move);
+    finished = true;
+    if (stop_requested || (!request.limits.infinite && !pondering)) write_bestmove();
+}
+
+//--
+/* Engine::write_bestmove */
+//--
+// Once searching is false the engine may be destroyed, so this is the last thing the job does with it
+void Engine::write_bestmove() {
+    output(bestmove);
+    searching = false;
+    finished = false;
+    state_changed.notify_all();
+    if (search_end_callback) search_end_callback();
+}
+
+} // namespace uci
+} // namespace hyperion
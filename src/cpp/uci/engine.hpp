@@ -1 +1,130 @@
+#ifndef HYPERION_UCI_ENGINE_HPP
+#define HYPERION_UCI_ENGINE_HPP
 
+#include "core/position.hpp"
+#include "search/search.hpp"
+#include "search/nn_evaluator.hpp"
+#include "search/time_manager.hpp"
+#include "options.hpp"
+#include "worker_pool.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace hyperion {
+namespace uci {
+
+// Where the engine's output lines go (one line per call, without the newline)
+using OutputFn = std::function<void(const std::string&)>;
+
+//--
+/* struct SearchRequest */
+//--
+// What a "go" asked for
+struct SearchRequest {
+    engine::TimeControl clock;   // the side to move's clock, the move overhead comes from the engine's option
+    engine::SearchLimits limits; // nodes, depth, mate, searchmoves. limits.time is filled in from clock by go()
+                                 // limits.infinite: search until "stop", even if the root is proven
+    bool ponder = false;         // like infinite until "ponderhit", then the time limits count from the ponderhit
+};
+
+//--
+/* struct SharedResources */
+//--
+// What the sessions of a multi-session host (host.hpp) share instead of each having their own: the threads the
+// searches run on, and one network (one copy of the weights) with its evaluation cache and its batcher
+// The network is loaded before the sessions start, it's only ever used from the batcher's thread
+struct SharedResources {
+    SharedResources(int workers, size_t eval_cache_mb);
+
+    WorkerPool pool;
+    engine::NetworkEvaluator network; // with the evaluation cache
+    engine::EvalQueue eval_queue;
+};
+
+//--
+/* class Engine */
+//--
+// The engine behind the UCI front-end: the position, the options, and the search
+// go() returns right away, the search runs as a job on a worker pool and writes "bestmove" when it's done, so
+// the reader can answer isready, stop and ponderhit while the engine thinks
+// On its own the engine has a pool of one thread. With shared resources it uses the host's pool and network, and
+// the options that belong to the host (Hash, Threads, WeightsFile) aren't offered
+// Everything that changes the position or the options stops a running search first
+class Engine {
+public:
+    explicit Engine(OutputFn output, SharedResources* shared = nullptr);
+    ~Engine();
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    // "uci": the id and option lines, then uciok
+    void print_id_and_options() const;
+    // "setoption", an unknown option or a value that doesn't fit is reported with an info string (and false)
+    bool set_option(const std::string& name, const std::string& value);
+    const OptionRegistry& get_options() const { return options; }
+    // The last search's tree and statistics. Not while searching
+    const engine::Search& get_search() const { return search; }
+
+    void new_game();
+    void set_position(const core::Position& pos);
+    const core::Position& get_position() const { return position; }
+
+    // Starts a search on the worker pool
+    void go(const SearchRequest& request);
+    // Ends the running search, its bestmove comes from the search job (or from here, when the job already finished)
+    void stop();
+    // The opponent played the ponder move: the ponder search goes on as a normal timed search
+    void ponderhit();
+    // Blocks until no search is running (its bestmove has been written)
+    void wait();
+    // At the end of the input: a timed search may finish, an infinite or ponder search is stopped, then wait()
+    void finish();
+    // The first half of finish(), without the wait
+    void stop_unbounded();
+    bool is_searching() const;
+    // Called each time a search has written its bestmove, under the engine's lock (so it must not call the
+    // engine). Set it before the first go
+    void set_search_end_callback(std::function<void()> callback) { search_end_callback = std::move(callback); }
+
+private:
+    OutputFn output;
+    SharedResources* shared;
+    core::Position position;
+    engine::Search search;
+    engine::NetworkEvaluator own_network;
+    engine::NetworkEvaluator* network; // own_network, or the shared one
+    OptionRegistry options;
+
+    mutable std::mutex mutex;
+    std::condition_variable state_changed;
+    SearchRequest request;
+    int move_overhead_ms = engine::DEFAULT_MOVE_OVERHEAD_MS;
+    bool analysis_json = false;
+    bool searching = false;      // from go() until bestmove is written
+    bool finished = false;       // the search job is done, its bestmove waits for stop or ponderhit
+    bool stop_requested = false; // stop() during the current search
+    bool pondering = false;      // a ponder search that hasn't had its ponderhit yet
+    std::string bestmove;        // the finished search's bestmove line
+    std::function<void()> search_end_callback;
+    std::unique_ptr<WorkerPool> own_pool; // last, so it's joined before anything its job uses goes away
+    WorkerPool* pool;
+
+    // Announces every option and wires it to the search, see engine.cpp for the list
+    void register_options();
+    // The job go() posts: searches, then writes the bestmove unless it has to wait
+    void run_search();
+    // Writes the bestmove of the finished search and ends it. Under the lock
+    void write_bestmove();
+    // stop() + wait(), for everything that can't change under a running search
+    void stop_and_wait();
+};
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_ENGINE_HPP
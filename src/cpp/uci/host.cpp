@@ -0,0 +1,222 @@
+#include "host.hpp"
+#include "engine.hpp"
+#include "output_writer.hpp"
+#include "uci.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+// The commands that stop and wait for the session's search (see Session::handle_command)
+static bool waits_for_search(const std::string& command) {
+    std::string word;
+    std::istringstream(command) >> word;
+    return word == "position" || word == "setoption" || word == "ucinewgame" || word == "go" || word == "bench" ||
+           word == "quit";
+}
+
+//--
+/* class HostedSession */
+//--
+// A session whose commands run in order, but without a thread of its own. Commands are run by whoever finds the
+// session idle: the reader when a command comes in, a job on the shared pool when a search ends. A command that
+// has to wait for the session's search stops it and parks the session instead of blocking, the end of the search
+// posts the rest of its commands to the pool. So neither the reader nor a worker ever waits for a search (which
+// may be queued behind other sessions' go infinite, whose stop still has to be read), and a bench runs on the pool
+class HostedSession {
+public:
+    HostedSession(OutputFn output, SharedResources& shared_resources)
+        : session(std::move(output), &shared_resources), shared(shared_resources) {
+        session.get_engine().set_search_end_callback([this] { resume(); });
+    }
+
+    // From the reader
+    void post(const std::string& command) { add({command, false}); }
+    // At the end of the input, see Engine::finish
+    void finish() { add({std::string(), true}); }
+    // Its quit is done and its search finished, it can be destroyed
+    bool is_closed() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed;
+    }
+    // Until the session has quit or finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return closed || finished; });
+    }
+
+private:
+    struct Command {
+        std::string line;
+        bool end_of_input;
+    };
+
+    Session session;
+    SharedResources& shared;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::deque<Command> commands;
+    bool running = false;  // someone is running its commands
+    bool parked = false;   // a command waits for the search to end
+    bool closed = false;
+    bool finished = false;
+
+    void add(Command command) {
+        bool start = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            commands.push_back(std::move(command));
+            if (!running && !parked) start = running = true;
+        }
+        if (start) run();
+    }
+
+    // The search end callback: the parked command can go on, on the pool
+    void resume() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!parked) return;
+        parked = false;
+        running = true;
+        shared.pool.post([this] { run(); });
+    }
+
+    // Stops the search for the command at the front, false if the session parked until the search ends
+    bool stop_search(const Command& command) {
+        Engine& engine = session.get_engine();
+        if (!engine.is_searching()) return true;
+        if (command.end_of_input) engine.stop_unbounded(); else engine.stop();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            parked = true;
+        }
+        // the search may have ended before the session parked, then resume() didn't see it
+        if (engine.is_searching()) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!parked) return false; // it did, and posted run()
+        parked = false;
+        running = true;
+        return true;
+    }
+
+    // Runs the queued commands until there are none left or one has to wait. Nothing of the session may be
+    // touched once closed or finished is set, the reader destroys it then
+    void run() {
+        while (true) {
+            Command command;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (commands.empty()) {
+                    running = false;
+                    return;
+                }
+                command = commands.front();
+            }
+            if ((command.end_of_input || waits_for_search(command.line)) && !stop_search(command)) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                commands.pop_front();
+            }
+
+            if (command.end_of_input) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished = true;
+                done.notify_all();
+                return;
+            }
+            std::string word;
+            std::istringstream(command.line) >> word;
+            if (word == "bench") {
+                // a few seconds of searching, so on a worker
+                shared.pool.post([this, command] {
+                    session.handle_command(command.line);
+                    run();
+                });
+                return;
+            }
+            if (!session.handle_command(command.line)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+                done.notify_all();
+                return;
+            }
+        }
+    }
+};
+
+//--
+/* host_loop */
+//--
+// The sessions are read one line at a time on this thread, which runs their commands unless one has to wait for
+// its search (see HostedSession). A session that quits is destroyed once its quit has run
+void host_loop(std::istream& in, std::ostream& out, const HostConfig& config) {
+    // declared in this order so the sessions go first, then what they share, then the writer with their last lines
+    OutputWriter writer(out);
+    SharedResources shared(config.workers, config.eval_cache_mb);
+    std::map<std::string, std::unique_ptr<HostedSession>> sessions;
+    std::vector<std::unique_ptr<HostedSession>> closing; // quit, but maybe not done yet
+
+    const OutputFn host_output = [&writer](const std::string& line) { writer.write("host " + line); };
+    if (config.int8) shared.network.set_precision(nn::Precision::INT8);
+    if (!config.weights_file.empty()) {
+        if (shared.network.load(config.weights_file)) {
+            host_output("info string loaded network " + config.weights_file);
+            if (!shared.network.error().empty()) host_output("info string " + shared.network.error());
+        } else {
+            host_output("info string could not load network: " + shared.network.error());
+        }
+    }
+    host_output("info string " + std::to_string(shared.pool.size()) + " workers");
+
+    std::string line;
+    while (std::getline(in, line)) {
+        closing.erase(std::remove_if(closing.begin(), closing.end(),
+                                     [](const std::unique_ptr<HostedSession>& session) { return session->is_closed(); }),
+                      closing.end());
+
+        std::istringstream iss(line);
+        std::string tag;
+        if (!(iss >> tag)) continue;
+        if (tag == "quit") break;
+        if (tag == "host") {
+            host_output("info string host is not a session name");
+            continue;
+        }
+
+        std::string command;
+        std::getline(iss >> std::ws, command);
+        auto session = sessions.find(tag);
+        if (session == sessions.end()) {
+            auto output = [&writer, tag](const std::string& text) { writer.write(tag + " " + text); };
+            session = sessions.emplace(tag, std::make_unique<HostedSession>(output, shared)).first;
+        }
+        session->second->post(command);
+
+        // quit ends only this session, its search is stopped and its bestmove written. A later command with the
+        // same name starts a new session
+        std::string word;
+        std::istringstream(command) >> word;
+        if (word == "quit") {
+            closing.push_back(std::move(session->second));
+            sessions.erase(session);
+        }
+    }
+
+    // every session finishes at the same time
+    for (auto& session : sessions) session.second->finish();
+    for (auto& session : sessions) session.second->wait();
+    for (auto& session : closing) session->wait();
+    sessions.clear();
+    closing.clear();
+}
+
+} // namespace uci
+} // namespace hyperion
@@ -0,0 +1,35 @@
+#ifndef HYPERION_UCI_HOST_HPP
+#define HYPERION_UCI_HOST_HPP
+
+#include "search/eval_cache.hpp"
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace hyperion {
+namespace uci {
+
+//--
+/* struct HostConfig */
+//--
+// What the sessions of a host share, set on the command line (HyperionEngine --host ...)
+struct HostConfig {
+    int workers = 1;                                     // searches running at the same time
+    size_t eval_cache_mb = engine::DEFAULT_EVAL_CACHE_MB; // the shared network's evaluation cache
+    std::string weights_file;                            // the shared network, empty = none
+    bool int8 = false;                                   // run it in INT8, needs a calibrated weight file
+};
+
+// Runs many independent UCI sessions (games) in one process, over tagged lines:
+//   in:  "<session> <uci command>"   a session is created by its first command and closed by "<session> quit"
+//   out: "<session> <uci output>"    lines from the host itself are tagged "host"
+// "quit" on its own ends every session and the host. Each session has its own position, search tree and options,
+// they share the worker pool, the network and its batcher (SharedResources). A session has no thread of its own:
+// a command that waits for its search (or a bench) is put off to the pool, so it doesn't hold up the others
+void host_loop(std::istream& in, std::ostream& out, const HostConfig& config);
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_HOST_HPP
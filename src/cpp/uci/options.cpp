@@ -0,0 +1,159 @@
+#include "options.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace hyperion {
+namespace uci {
+
+static bool equals_ignore_case(const std::string& a, const std::string& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+//--
+/* Option::to_uci */
+//--
+std::string Option::to_uci() const {
+    std::string line = "option name " + name + " type ";
+    switch (type) {
+        case OptionType::Check:
+            line += "check default " + default_value;
+            break;
+        case OptionType::Spin:
+            line += "spin default " + default_value + " min " + std::to_string(min) + " max " + std::to_string(max);
+            break;
+        case OptionType::Combo:
+            line += "combo default " + default_value;
+            for (const auto& var : vars) line += " var " + var;
+            break;
+        case OptionType::String:
+            line += "string default " + (default_value.empty() ? std::string("<empty>") : default_value);
+            break;
+    }
+    return line;
+}
+
+//--
+/* OptionRegistry::add_* */
+//--
+void OptionRegistry::add_check(const std::string& name, bool default_value, Option::OnChange on_change) {
+    Option option;
+    option.name = name;
+    option.type = OptionType::Check;
+    option.default_value = default_value ? "true" : "false";
+    option.on_change = std::move(on_change);
+    add(std::move(option));
+}
+
+void OptionRegistry::add_spin(const std::string& name, int default_value, int min, int max, Option::OnChange on_change) {
+    Option option;
+    option.name = name;
+    option.type = OptionType::Spin;
+    option.default_value = std::to_string(default_value);
+    option.min = min;
+    option.max = max;
+    option.on_change = std::move(on_change);
+    add(std::move(option));
+}
+
+void OptionRegistry::add_combo(const std::string& name, const std::string& default_value,
+                               const std::vector<std::string>& vars, Option::OnChange on_change) {
+    Option option;
+    option.name = name;
+    option.type = OptionType::Combo;
+    option.default_value = default_value;
+    option.vars = vars;
+    option.on_change = std::move(on_change);
+    add(std::move(option));
+}
+
+void OptionRegistry::add_string(const std::string& name, const std::string& default_value, Option::OnChange on_change) {
+    Option option;
+    option.name = name;
+    option.type = OptionType::String;
+    option.default_value = default_value;
+    option.on_change = std::move(on_change);
+    add(std::move(option));
+}
+
+// The default is the current value, the callback isn't run for it: the engine already starts with the defaults
+void OptionRegistry::add(Option option) {
+    option.value = option.default_value;
+    options.push_back(std::move(option));
+}
+
+//--
+/* OptionRegistry::find */
+//--
+const Option* OptionRegistry::find(const std::string& name) const {
+    for (const auto& option : options) {
+        if (equals_ignore_case(option.name, name)) return &option;
+    }
+    return nullptr;
+}
+
+Option* OptionRegistry::find_mutable(const std::string& name) {
+    return const_cast<Option*>(find(name));
+}
+
+//--
+/* OptionRegistry::set */
+//--
+bool OptionRegistry::set(const std::string& name, const std::string& value, std::string& error) {
+    Option* option = find_mutable(name);
+    if (!option) {
+        error = "Unknown option " + name;
+        return false;
+    }
+
+    std::string new_value = value;
+    switch (option->type) {
+        case OptionType::Check:
+            if (equals_ignore_case(value, "true")) new_value = "true";
+            else if (equals_ignore_case(value, "false")) new_value = "false";
+            else new_value.clear();
+            break;
+        case OptionType::Spin:
+            try {
+                size_t used = 0;
+                const long long number = std::stoll(value, &used);
+                if (used != value.size() || number < option->min || number > option->max) new_value.clear();
+                else new_value = std::to_string(number);
+            } catch (const std::exception&) {
+                new_value.clear();
+            }
+            break;
+        case OptionType::Combo: {
+            auto var = std::find_if(option->vars.begin(), option->vars.end(),
+                                    [&value](const std::string& v) { return equals_ignore_case(v, value); });
+            new_value = var != option->vars.end() ? *var : std::string();
+            break;
+        }
+        case OptionType::String:
+            if (value == "<empty>") new_value.clear();
+            break;
+    }
+    if (new_value.empty() && option->type != OptionType::String) {
+        error = "Invalid value " + value + " for option " + option->name;
+        return false;
+    }
+
+    const std::string old_value = option->value;
+    option->value = new_value;
+    if (option->on_change) {
+        try {
+            option->on_change(*option);
+        } catch (const std::exception&) {
+            option->value = old_value;
+            error = "Invalid value " + value + " for option " + option->name;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace uci
+} // namespace hyperion
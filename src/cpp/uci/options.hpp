@@ -0,0 +1,69 @@
+#ifndef HYPERION_UCI_OPTIONS_HPP
+#define HYPERION_UCI_OPTIONS_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+// The UCI option types we use ("button" has no value, nothing needs one yet)
+enum class OptionType { Check, Spin, Combo, String };
+
+//--
+/* struct Option */
+//--
+// One UCI option: how it's announced, its current value, and what happens when it changes
+// The value is always kept as the string setoption sent, the as_* helpers convert it
+struct Option {
+    using OnChange = std::function<void(const Option&)>;
+
+    std::string name;
+    OptionType type = OptionType::String;
+    std::string default_value;
+    std::string value;
+    int min = 0, max = 0;          // Spin only
+    std::vector<std::string> vars; // Combo only
+    OnChange on_change;
+
+    bool as_bool() const { return value == "true"; }
+    int as_int() const { return std::stoi(value); }
+    double as_double() const { return std::stod(value); }
+
+    // The "option name ... type ..." line of the uci reply
+    std::string to_uci() const;
+};
+
+//--
+/* class OptionRegistry */
+//--
+// The engine's options, in the order they are announced. Names are matched case insensitively, like UCI says
+// set() checks the value against the option's type first, so the callbacks only ever see valid values. A callback
+// can still reject a value by throwing (a string option that has to be a number), then the old value is kept
+class OptionRegistry {
+public:
+    void add_check(const std::string& name, bool default_value, Option::OnChange on_change = {});
+    void add_spin(const std::string& name, int default_value, int min, int max, Option::OnChange on_change = {});
+    void add_combo(const std::string& name, const std::string& default_value, const std::vector<std::string>& vars,
+                   Option::OnChange on_change = {});
+    void add_string(const std::string& name, const std::string& default_value, Option::OnChange on_change = {});
+
+    // Stores the value and runs the option's callback. False, with the reason in error, if there is no such
+    // option or the value doesn't fit it
+    bool set(const std::string& name, const std::string& value, std::string& error);
+
+    const Option* find(const std::string& name) const;
+    const std::vector<Option>& all() const { return options; }
+
+private:
+    std::vector<Option> options;
+
+    Option* find_mutable(const std::string& name);
+    void add(Option option);
+};
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_OPTIONS_HPP
@@ -0,0 +1,53 @@
+#include "output_writer.hpp"
+
+namespace hyperion {
+namespace uci {
+
+//--
+/* OutputWriter::OutputWriter */
+//--
+OutputWriter::OutputWriter(std::ostream& stream) : out(stream) {
+    writer_thread = std::thread(&OutputWriter::writer_thread_main, this);
+}
+
+OutputWriter::~OutputWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    has_lines.notify_one();
+    writer_thread.join();
+}
+
+//--
+/* OutputWriter::write */
+//--
+void OutputWriter::write(const std::string& line) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back(line);
+    }
+    has_lines.notify_one();
+}
+
+//--
+/* OutputWriter::writer_thread_main */
+//--
+// The stream is written without the lock, the batch is swapped out first so write() can go on queueing
+void OutputWriter::writer_thread_main() {
+    std::vector<std::string> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            has_lines.wait(lock, [this] { return exiting || !queued.empty(); });
+            if (queued.empty()) return;
+            batch.swap(queued);
+        }
+        for (const auto& line : batch) out << line << '\n';
+        out.flush();
+        batch.clear();
+    }
+}
+
+} // namespace uci
+} // namespace hyperion
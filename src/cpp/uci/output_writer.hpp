@@ -0,0 +1,46 @@
+#ifndef HYPERION_UCI_OUTPUT_WRITER_HPP
+#define HYPERION_UCI_OUTPUT_WRITER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+//--
+/* class OutputWriter */
+//--
+// Writes the engine's output lines to a stream on its own thread. write() only queues the line, so a search thread
+// never waits on the GUI reading its output. The writer takes everything queued so far, writes it in order and
+// flushes once for the whole batch
+class OutputWriter {
+public:
+    explicit OutputWriter(std::ostream& out);
+    // Writes whatever is still queued before returning
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // One line, without the newline. Any thread
+    void write(const std::string& line);
+
+private:
+    std::ostream& out;
+    std::mutex mutex;
+    std::condition_variable has_lines;
+    std::vector<std::string> queued;
+    bool exiting = false;
+    std::thread writer_thread;
+
+    void writer_thread_main();
+};
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_OUTPUT_WRITER_HPP
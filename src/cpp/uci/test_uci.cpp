@@ -0,0 +1,479 @@
+// hyperion/src/cpp/uci/test_uci.cpp
+#include "core/position.hpp"
+#include "core/movegen.hpp"
+#include "core/zobrist.hpp"
+#include "core/bitboard.hpp"
+#include "uci/bench.hpp"
+#include "uci/engine.hpp"
+#include "uci/host.hpp"
+#include "uci/options.hpp"
+#include "uci/uci.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+---
+* Checks the asynchronous UCI front-end: go returns right away, stop and ponderhit are handled while the search
+* thread is thinking, every go gets exactly one bestmove (and none early during go infinite / go ponder), and
+* a whole session through uci_loop answers isready in the middle of a search and plays only the new moves of a
+* position command that extends the previous one. MultiPV and AnalysisJSON show the ranked root moves, the
+* bench positions are all playable and the bench signature is the same on every run. The host keeps its
+* sessions apart while they share the workers and the network, without a thread per session
+
+* Build target: TestUCI
+* Run it:
+    *./bin/TestUCI*
+---
+*/
+
+using namespace hyperion;
+using Clock = std::chrono::steady_clock;
+
+static int failures = 0;
+
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Check failed: " << message << std::endl;
+        failures++;
+    }
+}
+
+// Collects the engine's output lines, they come from the search thread too
+class Output {
+public:
+    uci::OutputFn fn() {
+        return [this](const std::string& line) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.push_back(line);
+        };
+    }
+
+    int count_bestmoves() {
+        std::lock_guard<std::mutex> lock(mutex);
+        int count = 0;
+        for (const auto& line : lines) count += line.rfind("bestmove ", 0) == 0;
+        return count;
+    }
+
+    std::string last_bestmove() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+            if (it->rfind("bestmove ", 0) == 0) return it->substr(9);
+        }
+        return "";
+    }
+
+    bool has_line_containing(const std::string& text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& line : lines) {
+            if (line.find(text) != std::string::npos) return true;
+        }
+        return false;
+    }
+
+    bool has_line_starting(const std::string& prefix) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& line : lines) {
+            if (line.rfind(prefix, 0) == 0) return true;
+        }
+        return false;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> lines;
+};
+
+static double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static bool is_legal(const core::Position& pos, const std::string& uci_move) {
+    core::Move move;
+    return uci::parse_uci_move(pos, uci_move, move);
+}
+
+void test_move_strings() {
+    std::cout << "Running test_move_strings..." << std::endl;
+    core::Position pos;
+    pos.set_from_fen("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+    core::Move move;
+    check(uci::parse_uci_move(pos, "b7b8n", move), "b7b8n should be legal");
+    check(core::move_to_uci_string(move) == "b7b8n", "underpromotion should round trip");
+    check(!uci::parse_uci_move(pos, "b7b8", move), "a promotion needs its piece");
+    check(!uci::parse_uci_move(pos, "e1e3", move), "e1e3 is not a king move");
+
+    // every from/to/promotion string has to parse to exactly the move the generator makes, or fail if it
+    // makes none: castling (with an attacked path), en passant, promotions by capture, pinned pieces
+    const char* fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq a3 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "8/8/8/KPp4r/8/8/8/7k w - c6 0 1",
+        "r3k2r/8/8/8/8/8/8/R3K1r1 w Qkq - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    };
+    const char promotions[] = {'\0', 'q', 'r', 'b', 'n'};
+    core::MoveGenerator move_gen;
+    for (const char* fen : fens) {
+        pos.set_from_fen(fen);
+        std::vector<core::Move> legal_moves;
+        move_gen.generate_legal_moves(pos, legal_moves);
+        size_t parsed = 0;
+        bool all_match = true;
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                for (char promotion : promotions) {
+                    std::string uci_move = core::square_to_algebraic(from) + core::square_to_algebraic(to);
+                    if (promotion) uci_move += promotion;
+                    if (!uci::parse_uci_move(pos, uci_move, move)) continue;
+                    ++parsed;
+                    bool generated = false;
+                    for (const auto& legal_move : legal_moves) {
+                        generated |= legal_move.from_sq == move.from_sq && legal_move.to_sq == move.to_sq &&
+                                     legal_move.piece_moved == move.piece_moved &&
+                                     legal_move.piece_captured == move.piece_captured && legal_move.flags == move.flags;
+                    }
+                    all_match &= generated;
+                }
+            }
+        }
+        check(all_match && parsed == legal_moves.size(),
+              std::string("parsed moves should be the legal moves of ") + fen);
+    }
+}
+
+void test_option_registry() {
+    std::cout << "Running test_option_registry..." << std::endl;
+    uci::OptionRegistry options;
+    int threads = 1;
+    double c = 1.5;
+    options.add_spin("Threads", 1, 1, 64, [&threads](const uci::Option& o) { threads = o.as_int(); });
+    options.add_combo("Selection", "UCT", {"UCT", "PUCT"});
+    options.add_check("Ponder", false);
+    options.add_string("CPuct", "1.5", [&c](const uci::Option& o) { c = o.as_double(); });
+
+    check(options.find("Threads")->to_uci() == "option name Threads type spin default 1 min 1 max 64", "spin announcement");
+    check(options.find("Selection")->to_uci() == "option name Selection type combo default UCT var UCT var PUCT",
+          "combo announcement");
+
+    std::string error;
+    check(options.set("threads", "8", error) && threads == 8, "names are case insensitive, the callback runs");
+    check(!options.set("Threads", "65", error) && threads == 8, "a spin out of range is rejected");
+    check(!options.set("Threads", "4x", error), "a spin has to be a number");
+    check(options.set("Selection", "puct", error) && options.find("Selection")->value == "PUCT", "combo values are matched");
+    check(!options.set("Selection", "Random", error), "a combo value has to be one of its vars");
+    check(!options.set("Ponder", "maybe", error) && options.set("Ponder", "true", error), "check values");
+    check(!options.set("CPuct", "abc", error) && options.find("CPuct")->value == "1.5" && c == 1.5,
+          "a value the callback rejects is not kept");
+    check(!options.set("NoSuchOption", "1", error) && error.find("Unknown") != std::string::npos, "unknown options");
+}
+
+void test_timed_search() {
+    std::cout << "Running test_timed_search..." << std::endl;
+    Output out;
+    uci::Engine engine(out.fn());
+    engine.set_option("LeafEval", "StaticEval"); // random playouts from the start position barely build a tree in 100ms
+    engine.set_position(core::Position());
+
+    const auto start = Clock::now();
+    uci::SearchRequest request;
+    request.clock.move_time_ms = 100;
+    engine.go(request);
+    check(elapsed_ms(start) < 20.0, "go should return right away");
+    check(engine.is_searching(), "the search should be running");
+
+    engine.wait();
+    check(out.count_bestmoves() == 1, "a timed search should write one bestmove");
+    check(out.last_bestmove().find(" ponder ") != std::string::npos, "the bestmove should come with a move to ponder on");
+    const std::string bestmove = out.last_bestmove();
+    check(is_legal(core::Position(), bestmove.substr(0, bestmove.find(' '))), "the bestmove should be legal");
+}
+
+void test_multipv_analysis() {
+    std::cout << "Running test_multipv_analysis..." << std::endl;
+    Output out;
+    uci::Engine engine(out.fn());
+    engine.set_option("LeafEval", "StaticEval");
+    engine.set_option("MultiPV", "3");
+    engine.set_option("AnalysisJSON", "true");
+    engine.set_position(core::Position());
+
+    uci::SearchRequest request;
+    request.limits.nodes = 500;
+    engine.go(request);
+    engine.wait();
+    check(out.has_line_starting("info depth") && out.has_line_containing(" multipv 3 "), "MultiPV 3 should show three moves");
+    check(!out.has_line_containing(" multipv 4 "), "MultiPV 3 should show no more than three moves");
+    check(out.has_line_starting("info string analysis {\"fen\":"), "AnalysisJSON should write the analysis");
+    const std::string bestmove = out.last_bestmove();
+    check(out.has_line_containing("\"moves\":[{\"move\":\"" + bestmove.substr(0, bestmove.find(' ')) + "\""),
+          "the first analysed move should be the bestmove");
+}
+
+void test_stop_infinite() {
+    std::cout << "Running test_stop_infinite..." << std::endl;
+    Output out;
+    uci::Engine engine(out.fn());
+    engine.set_position(core::Position());
+
+    uci::SearchRequest request;
+    request.clock.move_time_ms = 10; // ignored, the search is infinite
+    request.limits.infinite = true;
+    engine.go(request);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    check(out.count_bestmoves() == 0, "go infinite should not write a bestmove before stop");
+
+    auto start = Clock::now();
+    engine.stop();
+    check(elapsed_ms(start) < 5.0, "stop should return right away");
+    engine.wait();
+    check(elapsed_ms(start) < 200.0, "the search should end soon after stop");
+    check(out.count_bestmoves() == 1, "stop should give exactly one bestmove");
+
+    // stop with no search running does nothing
+    engine.stop();
+    check(out.count_bestmoves() == 1, "a stop without a search should not write a bestmove");
+
+    // a stop right after go still gets a real move, and a root without moves gets the null move
+    engine.go(request);
+    engine.stop();
+    engine.wait();
+    const std::string reply = out.last_bestmove();
+    check(is_legal(core::Position(), reply.substr(0, reply.find(' '))), "a search stopped at once should still give a legal move");
+    core::Position stalemate;
+    stalemate.set_from_fen("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+    engine.set_position(stalemate);
+    engine.go(request);
+    engine.stop();
+    engine.wait();
+    check(out.last_bestmove() == "0000", "a position without legal moves should give bestmove 0000");
+}
+
+void test_ponderhit() {
+    std::cout << "Running test_ponderhit..." << std::endl;
+    Output out;
+    uci::Engine engine(out.fn());
+    engine.set_option("Move Overhead", "0");
+    engine.set_position(core::Position());
+
+    uci::SearchRequest request;
+    request.clock.move_time_ms = 100;
+    request.ponder = true;
+    engine.go(request);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    check(out.count_bestmoves() == 0, "a ponder search should not end before ponderhit");
+
+    auto start = Clock::now();
+    engine.ponderhit();
+    engine.wait();
+    check(elapsed_ms(start) >= 90.0, "after ponderhit the time limit should count from the ponderhit");
+    check(elapsed_ms(start) < 400.0, "after ponderhit the search should end on its time limit");
+    check(out.count_bestmoves() == 1, "a ponder search should give exactly one bestmove");
+}
+
+void test_uci_session() {
+    std::cout << "Running test_uci_session..." << std::endl;
+    std::istringstream in("uci\nposition startpos moves e2e4\ngo infinite\nisready\nstop\ngo movetime 50\nisready\n");
+    std::ostringstream out;
+    uci::uci_loop(in, out);
+
+    const std::string output = out.str();
+    const size_t first_bestmove = output.find("bestmove");
+    check(output.find("uciok") != std::string::npos, "uci should answer uciok");
+    check(output.find("readyok") < first_bestmove, "isready should be answered during go infinite");
+    check(first_bestmove != std::string::npos && output.find("bestmove", first_bestmove + 1) != std::string::npos,
+          "both searches should write a bestmove");
+}
+
+// The process's threads (from /proc, so Linux only), 0 where they can't be counted
+static int thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("Threads:", 0) == 0) return std::atoi(line.c_str() + 8);
+    }
+    return 0;
+}
+
+// Input that counts the threads when the reader gets to its end, while every session it started is still there
+class ThreadCountingInput : public std::stringbuf {
+public:
+    explicit ThreadCountingInput(const std::string& text) : std::stringbuf(text, std::ios_base::in) {}
+    int threads_at_end = 0;
+
+protected:
+    int_type underflow() override {
+        const int_type c = std::stringbuf::underflow();
+        if (traits_type::eq_int_type(c, traits_type::eof()) && threads_at_end == 0) threads_at_end = thread_count();
+        return c;
+    }
+};
+
+void test_host() {
+    std::cout << "Running test_host..." << std::endl;
+    // two games on one worker: each keeps its own position, and b's search waits for a's
+    std::istringstream in("a setoption name LeafEval value StaticEval\n"
+                          "b setoption name LeafEval value StaticEval\n"
+                          "a position startpos moves f2f3 e7e5 g2g4\n"
+                          "b position fen 7k/8/8/8/8/8/R7/1R5K w - - 0 1\n"
+                          "a go nodes 3000\n"
+                          "b go mate 2\n"
+                          "c isready\n"
+                          "c quit\n"
+                          "c isready\n");
+    std::ostringstream out;
+    uci::HostConfig config;
+    config.workers = 1;
+    config.eval_cache_mb = 1;
+    uci::host_loop(in, out, config);
+
+    const std::string output = out.str();
+    check(output.find("\na bestmove d8h4") != std::string::npos, "session a should search its own position");
+    check(output.find("\nb bestmove ") != std::string::npos, "session b should get its bestmove too");
+    check(output.find("c readyok") != output.rfind("c readyok"), "a session that quit should start over on its next command");
+
+    // a command that waits for its session's search (b's position, its search queued behind a's go infinite) must
+    // not keep a's stop from being read
+    std::istringstream blocked_in("a go infinite\n"
+                                  "b go wtime 1000 btime 1000\n"
+                                  "b stop\n"
+                                  "b position startpos moves e2e4\n"
+                                  "b isready\n"
+                                  "a stop\n");
+    std::ostringstream blocked_out;
+    uci::host_loop(blocked_in, blocked_out, config);
+    const std::string blocked = blocked_out.str();
+    check(blocked.find("a bestmove ") != std::string::npos && blocked.find("b bestmove ") != std::string::npos &&
+          blocked.find("b readyok") != std::string::npos, "one session waiting for a worker shouldn't block the others");
+    check(blocked.find("????") == std::string::npos, "a search that waited for a worker should still have a move");
+
+    // sessions have no threads of their own: with a thousand of them searching, the host still only has its
+    // workers, the writer and the batcher
+    std::string many_commands;
+    const int many = 1000;
+    for (int i = 0; i < many; ++i) {
+        const std::string tag = "s" + std::to_string(i) + " ";
+        many_commands += tag + "setoption name LeafEval value StaticEval\n" + tag + "position startpos\n" + tag +
+                         "go nodes 20\n";
+    }
+    ThreadCountingInput many_in(many_commands);
+    std::istream many_stream(&many_in);
+    std::ostringstream many_out;
+    const int threads_before = thread_count();
+    config.workers = 2;
+    uci::host_loop(many_stream, many_out, config);
+    if (threads_before > 0) {
+        check(many_in.threads_at_end > 0 && many_in.threads_at_end <= threads_before + config.workers + 4,
+              "the number of threads shouldn't grow with the sessions (" + std::to_string(many_in.threads_at_end) + ")");
+    }
+    size_t many_bestmoves = 0;
+    for (size_t at = many_out.str().find(" bestmove "); at != std::string::npos; at = many_out.str().find(" bestmove ", at + 1)) {
+        ++many_bestmoves;
+    }
+    check(many_bestmoves == many, "every session should get its bestmove");
+
+    // sessions with LeafEval NN share one network and its batcher
+    uci::SharedResources shared(2, 1);
+    nn::NetworkShape shape;
+    shape.num_blocks = 1;
+    shape.num_filters = 16;
+    shared.network.init_random(shape, 3);
+    Output first_out, second_out;
+    {
+        uci::Engine first(first_out.fn(), &shared), second(second_out.fn(), &shared);
+        check(first.get_options().find("WeightsFile") == nullptr, "a session shouldn't have its own network");
+        for (uci::Engine* engine : {&first, &second}) {
+            engine->set_option("LeafEval", "NN");
+            engine->set_position(core::Position());
+            uci::SearchRequest request;
+            request.limits.nodes = 200;
+            engine->go(request);
+        }
+        first.wait();
+        second.wait();
+    }
+    check(first_out.count_bestmoves() == 1 && second_out.count_bestmoves() == 1, "both sessions should finish");
+    check(shared.eval_queue.evaluations() >= 400, "both sessions' leaves should go through the shared batcher");
+    check(first_out.has_line_containing("info string evalcache hits") && !first_out.has_line_containing(" lookups 0 ") &&
+          !first_out.has_line_containing(" hashfull 0 "), "a session should report the shared evaluation cache");
+}
+
+void test_incremental_position() {
+    std::cout << "Running test_incremental_position..." << std::endl;
+    // after two unrelated commands each one extends the previous, so only its new moves are played
+    std::istringstream in("position fen 4k3/1P6/8/8/8/8/8/4K3 w - - 0 1 moves b7b8q\n"
+                          "position startpos moves e2e4\n"
+                          "position startpos moves f2f3\n"
+                          "position startpos moves f2f3 e7e5\n"
+                          "position startpos moves f2f3 e7e5 g2g4\n"
+                          "go movetime 2000\n");
+    std::ostringstream out;
+    uci::uci_loop(in, out);
+
+    const std::string output = out.str();
+    check(output.find("bestmove d8h4") != std::string::npos, "black should find the mate after f3 e5 g4");
+    check(output.find("illegal move") == std::string::npos, "every move should have been legal where it was played");
+}
+
+//--
+/* test_bench */
+//--
+// Every bench position has a legal move and doesn't leave the side that just moved in check, and two runs give
+// the same nodes and signature
+static void test_bench() {
+    core::MoveGenerator generator;
+    for (const std::string& fen : uci::bench_positions()) {
+        core::Position pos;
+        pos.set_from_fen(fen);
+        std::vector<core::Move> moves;
+        generator.generate_legal_moves(pos, moves);
+        check(!moves.empty(), "bench position has legal moves: " + fen);
+        check(!pos.is_king_in_check(1 - pos.get_side_to_move()), "bench position is legal: " + fen);
+    }
+
+    uci::BenchConfig config;
+    std::string error;
+    std::istringstream args("30 StaticEval");
+    check(uci::parse_bench_args(args, config, error) && config.nodes == 30, "bench arguments are read");
+    std::istringstream bad_args("0");
+    check(!uci::parse_bench_args(bad_args, config, error), "bench rejects a node count of 0");
+    config.nodes = 30;
+
+    Output output;
+    const uci::BenchResult first = uci::run_bench(config, output.fn());
+    const uci::BenchResult second = uci::run_bench(config, output.fn());
+    check(first.nodes > 0 && first.nodes <= 30 * uci::bench_positions().size(), "bench searches every position");
+    check(first.nodes == second.nodes && first.signature == second.signature, "bench signature is repeatable");
+    check(output.has_line_starting("Signature"), "bench prints its signature");
+}
+
+int main() {
+    core::Zobrist::initialize_keys();
+    core::initialize_attack_tables();
+
+    test_move_strings();
+    test_option_registry();
+    test_timed_search();
+    test_multipv_analysis();
+    test_stop_infinite();
+    test_ponderhit();
+    test_uci_session();
+    test_incremental_position();
+    test_host();
+    test_bench();
+
+    if (failures == 0) {
+        std::cout << "All UCI tests passed." << std::endl;
+        return 0;
+    }
+    std::cout << failures << " UCI test(s) failed." << std::endl;
+    return 1;
+}
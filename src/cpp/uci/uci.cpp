@@ -1 +1,321 @@
+#include "uci.hpp"
+#include "engine.hpp"
+#include "bench.hpp"
+#include "output_writer.hpp"
+#include "core/bitboard.hpp"
+#include "core/position.hpp"
 
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+// "e4" -> its square index, -1 if it isn't a square
+static int parse_square(char file, char rank) {
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return -1;
+    return (rank - '1') * 8 + (file - 'a');
+}
+
+// The king's move of a castle (e1g1, e1c1, e8g8, e8c8), if the side to move may castle that way
+static bool parse_castling(const core::Position& pos, int us, int from, int to, core::Move& move) {
+    const int home = (us == core::WHITE) ? core::E1 : core::E8;
+    if (from != home || (to != home + 2 && to != home - 2)) return false;
+
+    const bool kingside = to > from;
+    const int right = (us == core::WHITE) ? (kingside ? core::WK_CASTLE_FLAG : core::WQ_CASTLE_FLAG)
+                                          : (kingside ? core::BK_CASTLE_FLAG : core::BQ_CASTLE_FLAG);
+    if (!(pos.castling_rights & right)) return false;
+
+    // the squares between king and rook are empty, and the king doesn't start in, pass or land on an attacked square
+    const int them = 1 - us;
+    const int rook = kingside ? home + 3 : home - 4;
+    for (int sq = std::min(home, rook) + 1; sq < std::max(home, rook); ++sq) {
+        if (pos.get_piece_on_square(static_cast<core::square_e>(sq)) != core::EMPTY_MAILBOX_VAL) return false;
+    }
+    const int step = kingside ? 1 : -1;
+    for (int sq = home; sq != to + step; sq += step) {
+        if (pos.is_square_attacked(static_cast<core::square_e>(sq), them)) return false;
+    }
+    move = core::Move(static_cast<core::square_e>(from), static_cast<core::square_e>(to), core::P_KING, core::P_NONE,
+                      kingside ? core::CASTLING_KINGSIDE : core::CASTLING_QUEENSIDE);
+    return true;
+}
+
+//--
+/* parse_uci_move */
+//--
+// The move is built straight from the board: the pieces on from/to give the moved and captured piece,
+// the geometry of the move gives its flags, and one make_move tells whether it leaves our king in check
+bool parse_uci_move(const core::Position& pos, const std::string& uci_move, core::Move& move) {
+    if (uci_move.size() != 4 && uci_move.size() != 5) return false;
+    const int from = parse_square(uci_move[0], uci_move[1]);
+    const int to = parse_square(uci_move[2], uci_move[3]);
+    if (from < 0 || to < 0 || from == to) return false;
+
+    core::piece_type_e promotion = core::P_NONE;
+    if (uci_move.size() == 5) {
+        switch (uci_move[4]) {
+            case 'q': promotion = core::P_QUEEN; break;
+            case 'r': promotion = core::P_ROOK; break;
+            case 'b': promotion = core::P_BISHOP; break;
+            case 'n': promotion = core::P_KNIGHT; break;
+            default: return false;
+        }
+    }
+
+    const int us = pos.get_side_to_move();
+    const core::square_e from_sq = static_cast<core::square_e>(from);
+    const core::square_e to_sq = static_cast<core::square_e>(to);
+
+    const int from_val = pos.get_piece_on_square(from_sq);
+    if (from_val == core::EMPTY_MAILBOX_VAL || pos.get_color_from_mailbox_val(from_val) != us) return false;
+    const core::piece_type_e moved = pos.get_piece_type_from_mailbox_val(from_val);
+
+    const int to_val = pos.get_piece_on_square(to_sq);
+    if (to_val != core::EMPTY_MAILBOX_VAL && pos.get_color_from_mailbox_val(to_val) == us) return false;
+    const core::piece_type_e captured =
+        (to_val == core::EMPTY_MAILBOX_VAL) ? core::P_NONE : pos.get_piece_type_from_mailbox_val(to_val);
+
+    const core::bitboard_t occupied = pos.get_occupied_squares();
+    const core::bitboard_t to_bb = core::square_to_bitboard(to);
+    bool found = false;
+    switch (moved) {
+        case core::P_PAWN: {
+            const int forward = (us == core::WHITE) ? 8 : -8;
+            const int start_rank = (us == core::WHITE) ? core::RANK_2_IDX : core::RANK_7_IDX;
+            const int last_rank = (us == core::WHITE) ? core::RANK_8_IDX : core::RANK_1_IDX;
+            const int ep_rank = (us == core::WHITE) ? core::RANK_6_IDX : core::RANK_3_IDX;
+            const bool attacks_to = (core::pawn_attacks[us][from] & to_bb) != 0;
+
+            if (to_sq == pos.en_passant_square && attacks_to && core::get_rank_idx(to_sq) == ep_rank) {
+                if (promotion != core::P_NONE) return false;
+                move = core::Move(from_sq, to_sq, core::P_PAWN, core::P_PAWN,
+                                  core::EN_PASSANT_CAPTURE | core::CAPTURE);
+                found = true;
+                break;
+            }
+
+            const bool single_push = (to == from + forward) && captured == core::P_NONE;
+            const bool double_push = (to == from + 2 * forward) && core::get_rank_idx(from_sq) == start_rank &&
+                                     captured == core::P_NONE &&
+                                     pos.get_piece_on_square(static_cast<core::square_e>(from + forward)) == core::EMPTY_MAILBOX_VAL;
+            const bool capture = attacks_to && captured != core::P_NONE;
+            if (!single_push && !double_push && !capture) return false;
+
+            // a pawn reaching the last rank has to say what it becomes, and no other pawn move may
+            if ((core::get_rank_idx(to_sq) == last_rank) != (promotion != core::P_NONE)) return false;
+            if (promotion != core::P_NONE) {
+                move = core::Move::make_promotion(from_sq, to_sq, core::P_PAWN, promotion, capture, captured);
+            } else if (double_push) {
+                move = core::Move(from_sq, to_sq, core::P_PAWN, core::P_NONE, core::DOUBLE_PAWN_PUSH);
+            } else if (capture) {
+                move = core::Move::make_capture(from_sq, to_sq, core::P_PAWN, captured);
+            } else {
+                move = core::Move::make_normal(from_sq, to_sq, core::P_PAWN);
+            }
+            found = true;
+            break;
+        }
+        case core::P_KNIGHT: found = (core::knight_attacks[from] & to_bb) != 0; break;
+        case core::P_BISHOP: found = (core::get_bishop_slider_attacks(from_sq, occupied) & to_bb) != 0; break;
+        case core::P_ROOK: found = (core::get_rook_slider_attacks(from_sq, occupied) & to_bb) != 0; break;
+        case core::P_QUEEN: found = (core::get_queen_slider_attacks(from_sq, occupied) & to_bb) != 0; break;
+        case core::P_KING:
+            if (parse_castling(pos, us, from, to, move)) {
+                if (promotion != core::P_NONE) return false;
+                return true;    // parse_castling already checked every square the king crosses
+            }
+            found = (core::king_attacks[from] & to_bb) != 0;
+            break;
+        default: return false;
+    }
+    if (!found) return false;
+
+    if (moved != core::P_PAWN) {
+        if (promotion != core::P_NONE) return false;
+        move = (captured == core::P_NONE) ? core::Move::make_normal(from_sq, to_sq, moved)
+                                          : core::Move::make_capture(from_sq, to_sq, moved, captured);
+    }
+
+    core::Position after = pos;
+    after.make_move(move);
+    return !after.is_king_in_check(us);
+}
+
+static PositionCommand read_position_command(std::istringstream& iss) {
+    PositionCommand command;
+    std::string token;
+    iss >> token;
+
+    if (token == "startpos") {
+        command.start = token;
+        iss >> token;
+    }
+    else if (token == "fen") {
+        while (iss >> token && token != "moves") {
+            command.start += token + " ";
+        }
+    }
+
+    if (token == "moves") {
+        while (iss >> token) command.moves.push_back(token);
+    }
+    return command;
+}
+
+// Plays moves[first..] on pos, an illegal move is reported and skipped
+static void play_moves(core::Position& pos, const std::vector<std::string>& moves, size_t first, const OutputFn& output) {
+    for (size_t i = first; i < moves.size(); ++i) {
+        core::Move move;
+        if (parse_uci_move(pos, moves[i], move)) {
+            pos.make_move(move);
+        } else {
+            output("info string Error: GUI sent illegal move " + moves[i] + " for FEN " + pos.to_fen());
+        }
+    }
+}
+
+// "go [wtime <x>] [btime <x>] [winc <x>] [binc <x>] [movestogo <x>] [movetime <x>] [nodes <x>] [depth <x>]
+//     [mate <x>] [infinite] [ponder] [searchmoves <move> ...]"
+// Only the side to move's clock is kept. A go without any limit searches until stop, like go infinite
+// searchmoves takes every following token that is a legal move, illegal ones are reported and skipped
+static SearchRequest parse_go(std::istringstream& iss, const core::Position& pos, const OutputFn& output) {
+    SearchRequest request;
+    int time[2] = {-1, -1}, increment[2] = {0, 0};
+    bool reading_search_moves = false;
+
+    std::string go_token;
+    while (iss >> go_token) {
+        if (reading_search_moves) {
+            core::Move move;
+            if (parse_uci_move(pos, go_token, move)) {
+                request.limits.search_moves.push_back(move);
+                continue;
+            }
+            const bool looks_like_move = go_token.size() >= 4 && go_token[1] >= '1' && go_token[1] <= '8';
+            if (looks_like_move) {
+                output("info string Error: illegal search move " + go_token);
+                continue;
+            }
+            reading_search_moves = false;
+        }
+
+        if (go_token == "searchmoves") reading_search_moves = true;
+        else if (go_token == "nodes") iss >> request.limits.nodes;
+        else if (go_token == "depth") iss >> request.limits.depth;
+        else if (go_token == "mate") iss >> request.limits.mate;
+        else if (go_token == "wtime") iss >> time[core::WHITE];
+        else if (go_token == "btime") iss >> time[core::BLACK];
+        else if (go_token == "winc") iss >> increment[core::WHITE];
+        else if (go_token == "binc") iss >> increment[core::BLACK];
+        else if (go_token == "movestogo") iss >> request.clock.moves_to_go;
+        else if (go_token == "movetime") iss >> request.clock.move_time_ms;
+        else if (go_token == "infinite") request.limits.infinite = true;
+        else if (go_token == "ponder") request.ponder = true;
+    }
+
+    const int us = pos.get_side_to_move();
+    request.clock.time_left_ms = time[us];
+    request.clock.increment_ms = increment[us];
+    const engine::SearchLimits& limits = request.limits;
+    if (!request.clock.has_clock() && limits.nodes <= 0 && limits.depth <= 0 && limits.mate <= 0) {
+        request.limits.infinite = true;
+    }
+    return request;
+}
+
+//--
+/* Session::Session */
+//--
+Session::Session(OutputFn out, SharedResources* shared) : output(std::move(out)), engine(output, shared) {}
+
+//--
+/* Session::handle_command */
+//--
+bool Session::handle_command(const std::string& line) {
+    std::istringstream iss(line);
+    std::string token;
+    iss >> token;
+
+    if (token == "uci") {
+        engine.print_id_and_options();
+    }
+    else if (token == "setoption") {
+        // setoption name <name> value <value>
+        std::string name, value;
+        iss >> token; // "name"
+        while (iss >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+        std::getline(iss >> std::ws, value);
+        engine.set_option(name, value);
+    }
+    else if (token == "isready") {
+        output("readyok");
+    }
+    else if (token == "ucinewgame") {
+        engine.new_game();
+        last_position = PositionCommand();
+    }
+    else if (token == "position") {
+        PositionCommand command = read_position_command(iss);
+        core::Position pos;
+        size_t first_new_move = 0;
+        if (command.extends(last_position)) {
+            pos = engine.get_position();
+            first_new_move = last_position.moves.size();
+        } else if (command.start == "startpos") {
+            pos.set_from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        } else if (!command.start.empty()) {
+            pos.set_from_fen(command.start);
+        }
+        play_moves(pos, command.moves, first_new_move, output);
+        engine.set_position(pos);
+        last_position = std::move(command);
+    }
+    else if (token == "go") {
+        engine.go(parse_go(iss, engine.get_position(), output));
+    }
+    else if (token == "stop") {
+        engine.stop();
+    }
+    else if (token == "ponderhit") {
+        engine.ponderhit();
+    }
+    else if (token == "bench") {
+        // bench [nodes] [leafeval], on its own search: the engine's position, tree and options are untouched
+        BenchConfig config;
+        std::string error;
+        if (parse_bench_args(iss, config, error)) {
+            engine.stop();
+            engine.wait();
+            run_bench(config, output);
+        } else {
+            output("info string " + error);
+        }
+    }
+    else if (token == "quit") {
+        engine.stop();
+        return false;
+    }
+    return true;
+}
+
+//--
+/* uci_loop */
+//--
+void uci_loop(std::istream& in, std::ostream& out) {
+    // The reader, the search job and the search's info lines all write, the writer keeps the lines whole and in
+    // order, and writes them off those threads. It's declared before the session so it outlives its last bestmove
+    OutputWriter writer(out);
+    Session session([&writer](const std::string& line) { writer.write(line); });
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!session.handle_command(line)) break;
+    }
+    session.finish();
+}
+
+} // namespace uci
+} // namespace hyperion
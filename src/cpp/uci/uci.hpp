@@ -1 +1,65 @@
+#ifndef HYPERION_UCI_UCI_HPP
+#define HYPERION_UCI_UCI_HPP
 
+#include "core/move.hpp"
+#include "core/position.hpp"
+#include "engine.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+// Finds the legal move of pos that the UCI string stands for, false if there is none
+bool parse_uci_move(const core::Position& pos, const std::string& uci_move, core::Move& move);
+
+//--
+/* struct PositionCommand */
+//--
+// A "position [startpos | fen <fen>] [moves <m1> ...]" command, split into where the game starts and its moves
+// The last one is kept: during a game every command repeats the previous one plus a move or two, and only
+// those new moves have to be played
+struct PositionCommand {
+    std::string start; // "startpos" or the FEN, empty if the command had neither
+    std::vector<std::string> moves;
+
+    bool extends(const PositionCommand& previous) const {
+        return !start.empty() && start == previous.start && moves.size() >= previous.moves.size() &&
+               std::equal(previous.moves.begin(), previous.moves.end(), moves.begin());
+    }
+};
+
+//--
+/* class Session */
+//--
+// One UCI conversation: the engine, and the last position command so the next one only plays its new moves
+// uci_loop has one, a multi-session host (host.hpp) has one per game
+class Session {
+public:
+    explicit Session(OutputFn output, SharedResources* shared = nullptr);
+
+    // Handles one command line, false once it was "quit"
+    bool handle_command(const std::string& line);
+    // At the end of the input, see Engine::finish
+    void finish() { engine.finish(); }
+    Engine& get_engine() { return engine; }
+
+private:
+    OutputFn output;
+    Engine engine;
+    PositionCommand last_position;
+};
+
+// Runs the UCI protocol until "quit" or the end of the input
+// The calling thread is the reader: it only parses commands and hands them to the Engine, the search runs on
+// the Engine's worker pool, so stop/isready/ponderhit are answered while the engine is thinking
+void uci_loop(std::istream& in, std::ostream& out);
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_UCI_HPP
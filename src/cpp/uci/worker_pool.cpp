@@ -0,0 +1,53 @@
+#include "worker_pool.hpp"
+
+#include <algorithm>
+
+namespace hyperion {
+namespace uci {
+
+//--
+/* WorkerPool::WorkerPool */
+//--
+WorkerPool::WorkerPool(int thread_count) {
+    for (int i = 0; i < std::max(1, thread_count); ++i) threads.emplace_back(&WorkerPool::worker_main, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    has_jobs.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+//--
+/* WorkerPool::post */
+//--
+void WorkerPool::post(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    has_jobs.notify_one();
+}
+
+//--
+/* WorkerPool::worker_main */
+//--
+void WorkerPool::worker_main() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        has_jobs.wait(lock, [this] { return exiting || !jobs.empty(); });
+        if (jobs.empty()) return;
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
+
+} // namespace uci
+} // namespace hyperion
@@ -0,0 +1,45 @@
+#ifndef HYPERION_UCI_WORKER_POOL_HPP
+#define HYPERION_UCI_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hyperion {
+namespace uci {
+
+//--
+/* class WorkerPool */
+//--
+// A fixed set of threads running posted jobs in order. The engines' searches run on it: a single engine has a
+// pool of one, the sessions of a host (host.hpp) share one, so at most that many searches run at the same time
+// and the others wait for a thread
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads);
+    // Runs the jobs that are still queued, then joins the threads
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void post(std::function<void()> job);
+    int size() const { return static_cast<int>(threads.size()); }
+
+private:
+    std::mutex mutex;
+    std::condition_variable has_jobs;
+    std::deque<std::function<void()>> jobs;
+    bool exiting = false;
+    std::vector<std::thread> threads;
+
+    void worker_main();
+};
+
+} // namespace uci
+} // namespace hyperion
+
+#endif // HYPERION_UCI_WORKER_POOL_HPP
@@ -0,0 +1,212 @@
+# this will be used for the following:
+# - calibrating the INT8 inference path of the C++ engine (src/cpp/nn_inference/int8_kernels.hpp) on real positions
+#   sampled from the LMDB training shards
+# - reporting how close INT8 stays to FP32 (policy top-1 agreement and value MSE) on a separate sample
+# - writing the weight file with the calibration included (see export_weights.py for the format)
+#
+# the C++ int8 path quantizes the input of every 3x3 conv (entry conv + residual tower) to 0..127 with
+# scale = activation_range / 127, and the (BatchNorm folded) weights to -127..127 with one scale per output channel
+# the heads stay in float. the accuracy report emulates exactly that scheme in PyTorch ("fake quantization")
+#
+# usage (from the root hyperion directory):
+#   python -m hyperion_nn.training.calibrate_int8 --checkpoint path/to/checkpoint.pt --output path/to/weights.hnn
+#   (by default it samples from every .lmdb shard in PROCESSED_TRAINING_DATA_DIR)
+
+import argparse
+import copy
+import glob
+import logging
+import os
+import random
+
+import lmdb
+import torch
+
+import hyperion_nn.config as config
+import hyperion_nn.data_utils.fen_parser as fen_parser
+import hyperion_nn.training.export_weights as export_weights
+from hyperion_nn.models.resnet_cnn import HyperionNN
+
+logger = logging.getLogger(__name__)
+
+INT8_MAX_ACTIVATION = 127
+INT8_MAX_WEIGHT = 127
+
+
+def sample_positions(shard_paths: list[str], num_positions: int, seed: int) -> torch.Tensor:
+    """
+    Samples num_positions random positions (input planes only) spread over all the shards.
+    Reads the shards directly (same key/row format as ChessDataset), only the FEN of each row is needed.
+
+    Returns:
+        torch.Tensor: (num_positions, NUM_INPUT_PLANES, 8, 8)
+    """
+    rng = random.Random(seed)
+    envs = []
+    for path in shard_paths:
+        env = lmdb.open(path, readonly=True, lock=False, readahead=False, subdir=False)
+        with env.begin() as txn:
+            raw_len = txn.get(b"__len__")
+        if raw_len is None or int.from_bytes(raw_len, "little") == 0:
+            logger.warning(f"Skipping LMDB shard {path}, it is empty or missing the '__len__' entry.")
+            env.close()
+            continue
+        envs.append((env, int.from_bytes(raw_len, "little")))
+    if not envs:
+        raise RuntimeError("None of the LMDB shards have any positions")
+
+    planes = []
+    try:
+        while len(planes) < num_positions:
+            env, length = rng.choice(envs)
+            with env.begin() as txn:
+                raw_line = txn.get(f"{rng.randrange(length):010d}".encode("ascii"))
+            if raw_line is None:
+                continue
+            fen_str = raw_line.decode("utf-8").strip().split(",")[0]
+            planes.append(torch.from_numpy(fen_parser.fen_to_nn_input(fen_str)).float())
+    finally:
+        for env, _ in envs:
+            env.close()
+    return torch.stack(planes)
+
+
+def quantized_convs(model: HyperionNN) -> list[torch.nn.Conv2d]:
+    """The 3x3 convs the C++ int8 path quantizes, in the order of the activation ranges."""
+    convs = [model.entry_block[0]]
+    for block in model.residual_:
+        convs.extend([block.conv1, block.conv2])
+    return convs
+
+
+@torch.no_grad()
+def compute_activation_ranges(model: HyperionNN, positions: torch.Tensor, batch_size: int = 256) -> list[float]:
+    """
+    Runs the positions through the model and returns the largest input every quantized conv sees.
+    """
+    convs = quantized_convs(model)
+    ranges = [0.0] * len(convs)
+
+    def make_hook(idx):
+        def hook(module, inputs):
+            ranges[idx] = max(ranges[idx], inputs[0].max().item())
+        return hook
+
+    handles = [conv.register_forward_pre_hook(make_hook(i)) for i, conv in enumerate(convs)]
+    try:
+        for start in range(0, len(positions), batch_size):
+            model(positions[start:start + batch_size])
+    finally:
+        for handle in handles:
+            handle.remove()
+    return ranges
+
+
+def build_fake_quantized_model(model: HyperionNN, activation_ranges: list[float]) -> HyperionNN:
+    """
+    Returns a copy of the model that computes what the C++ int8 path computes: BatchNorm folded into the convs,
+    per output channel int8 weights and 7 bit unsigned inputs for every quantized conv.
+    """
+    quant_model = copy.deepcopy(model).eval()
+
+    def fold(conv, bn):
+        weight, bias = export_weights.fold_batchnorm(conv, bn)
+        conv.weight.data = torch.from_numpy(weight)
+        conv.bias.data = torch.from_numpy(bias)
+
+    fold(quant_model.entry_block[0], quant_model.entry_block[1])
+    quant_model.entry_block[1] = torch.nn.Identity()
+    for block in quant_model.residual_:
+        fold(block.conv1, block.bn1)
+        fold(block.conv2, block.bn2)
+        block.bn1 = torch.nn.Identity()
+        block.bn2 = torch.nn.Identity()
+
+    for conv, activation_range in zip(quantized_convs(quant_model), activation_ranges):
+        weight = conv.weight.data
+        w_scale = weight.abs().amax(dim=(1, 2, 3), keepdim=True) / INT8_MAX_WEIGHT
+        w_scale[w_scale == 0] = 1.0
+        conv.weight.data = torch.clamp(torch.round(weight / w_scale), -INT8_MAX_WEIGHT, INT8_MAX_WEIGHT) * w_scale
+
+        a_scale = activation_range / INT8_MAX_ACTIVATION if activation_range > 0 else 1.0
+
+        def quantize_input(module, inputs, a_scale=a_scale):
+            x = torch.clamp(torch.floor(inputs[0] / a_scale + 0.5), 0, INT8_MAX_ACTIVATION) * a_scale
+            return (x,)
+
+        conv.register_forward_pre_hook(quantize_input)
+
+    return quant_model
+
+
+@torch.no_grad()
+def accuracy_report(fp32_model: HyperionNN, int8_model: HyperionNN, positions: torch.Tensor,
+                    batch_size: int = 256) -> dict:
+    """
+    Compares the int8 model against the FP32 model.
+
+    Returns:
+        dict: policy_top1_agreement (fraction of positions with the same best move) and value_mse
+              (on the tanh'd value, like the engine sees it)
+    """
+    agree = 0
+    squared_error = 0.0
+    for start in range(0, len(positions), batch_size):
+        batch = positions[start:start + batch_size]
+        fp32_policy, fp32_value = fp32_model(batch)
+        int8_policy, int8_value = int8_model(batch)
+        agree += (fp32_policy.argmax(dim=1) == int8_policy.argmax(dim=1)).sum().item()
+        squared_error += ((torch.tanh(fp32_value) - torch.tanh(int8_value)) ** 2).sum().item()
+
+    return {
+        "policy_top1_agreement": agree / len(positions),
+        "value_mse": squared_error / len(positions),
+    }
+
+
+def main():
+    logging.basicConfig(level=logging.INFO, format="[%(levelname)-8s] %(message)s")
+    parser = argparse.ArgumentParser(description="Calibrate the INT8 inference path and export the weights with it.")
+    parser.add_argument("--checkpoint", type=str, default=None, help="checkpoint to export (default: newest in CHECKPOINT_DIR)")
+    parser.add_argument("--shards", type=str, nargs="*", default=None, help="LMDB shards to sample from (default: all in PROCESSED_TRAINING_DATA_DIR)")
+    parser.add_argument("--calibration-positions", type=int, default=4096, help="positions used to find the activation ranges")
+    parser.add_argument("--eval-positions", type=int, default=4096, help="separate positions used for the accuracy report")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--output", type=str, default=None, help="output .hnn file (default: MODELS_DIR/hyperion_<B>b_<F>f_int8.hnn)")
+    args = parser.parse_args()
+
+    checkpoint_path = args.checkpoint or export_weights._latest_checkpoint()
+    if checkpoint_path is None:
+        raise FileNotFoundError(f"No checkpoint given and none found in {config.PathsConfig.CHECKPOINT_DIR}")
+    shard_paths = args.shards or sorted(glob.glob(os.path.join(config.PathsConfig.PROCESSED_TRAINING_DATA_DIR, "*.lmdb")))
+    if not shard_paths:
+        raise FileNotFoundError(f"No LMDB shards given and none found in {config.PathsConfig.PROCESSED_TRAINING_DATA_DIR}")
+
+    output_path = args.output or os.path.join(
+        config.PathsConfig.MODELS_DIR,
+        f"hyperion_{config.ModelConfig.NUM_RESIDUAL_BLOCKS}b_{config.ModelConfig.NUM_FILTERS}f_int8.hnn")
+    os.makedirs(os.path.dirname(os.path.abspath(output_path)), exist_ok=True)
+
+    logger.info(f"Loading checkpoint {checkpoint_path}...")
+    model = export_weights.load_model_from_checkpoint(checkpoint_path)
+
+    logger.info(f"Sampling {args.calibration_positions} + {args.eval_positions} positions from {len(shard_paths)} shard(s)...")
+    positions = sample_positions(shard_paths, args.calibration_positions + args.eval_positions, args.seed)
+    calibration_set = positions[:args.calibration_positions]
+    eval_set = positions[args.calibration_positions:]
+
+    activation_ranges = compute_activation_ranges(model, calibration_set)
+    logger.info(f"Activation ranges: min {min(activation_ranges):.3f}, max {max(activation_ranges):.3f}")
+
+    int8_model = build_fake_quantized_model(model, activation_ranges)
+    report = accuracy_report(model, int8_model, eval_set)
+    logger.info(f"INT8 vs FP32 on {len(eval_set)} positions: "
+                f"policy top-1 agreement {report['policy_top1_agreement'] * 100:.2f}%, "
+                f"value MSE {report['value_mse']:.6f}")
+
+    size = export_weights.write_weight_file(model, output_path, activation_ranges)
+    logger.info(f"Wrote {size / (1024 * 1024):.1f} MB of weights (with INT8 calibration) to {output_path}")
+
+
+if __name__ == "__main__":
+    main()
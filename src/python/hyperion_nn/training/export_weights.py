@@ -0,0 +1,194 @@
+# this will be used for the following:
+# - exporting a trained HyperionNN checkpoint into the binary weight file that the C++ engine mmaps
+#   (see src/cpp/nn_inference/weights_file.hpp for the C++ side of the format)
+# - folding every BatchNorm layer into the conv before it, so the engine only ever sees conv + bias
+#
+# file layout (everything little-endian):
+#   - 64 byte header: magic, version, header size, shape (blocks, filters, input planes, policy size),
+#     body offset, body size in floats, flags
+#   - body: float32 tensors in this order, each one zero padded to a multiple of 16 floats (64 bytes):
+#       entry conv (w, b), for every block: conv1 (w, b), conv2 (w, b),
+#       policy conv (w, b), policy linear (w, b), value conv (w, b), value linear 1 (w, b), value linear 2 (w, b)
+#   the weights keep their PyTorch layouts ([out][in][kh][kw] and [out][in])
+#   - optional sections after the body, each one marked by a bit in the header flags:
+#       FLAG_HAS_ACTIVATION_RANGES: the INT8 calibration from calibrate_int8.py, the largest input of every 3x3 conv
+#       (entry conv, then conv1, conv2 of every block), padded like the tensors
+#
+# usage (from the root hyperion directory):
+#   python -m hyperion_nn.training.export_weights --checkpoint path/to/checkpoint.pt --output path/to/weights.hnn
+#   (without --checkpoint the newest checkpoint in CHECKPOINT_DIR is used, like train.py does)
+
+import argparse
+import glob
+import logging
+import os
+import struct
+
+import numpy as np
+import torch
+
+import hyperion_nn.config as config
+from hyperion_nn.models.resnet_cnn import HyperionNN
+
+logger = logging.getLogger(__name__)
+
+WEIGHT_FILE_MAGIC = b"HYPNNWTS"
+WEIGHT_FILE_VERSION = 1
+HEADER_SIZE = 64
+ALIGN_FLOATS = 16  # every tensor starts on a 64 byte boundary
+
+FLAG_HAS_ACTIVATION_RANGES = 1 << 0
+
+# magic, version, header_size, num_blocks, num_filters, input_planes, policy_size, body_offset, body_floats, flags
+HEADER_FORMAT = "<8sIIIIIIQQI"
+HEADER_FORMAT_SIZE = struct.calcsize(HEADER_FORMAT)
+
+
+def fold_batchnorm(conv: torch.nn.Conv2d, bn: torch.nn.BatchNorm2d) -> tuple[np.ndarray, np.ndarray]:
+    """
+    Folds an (eval mode) BatchNorm2d into the conv in front of it.
+
+    bn(conv(x)) = gamma * (W*x + b - mean) / sqrt(var + eps) + beta
+                = (W * scale) * x + ((b - mean) * scale + beta),   scale = gamma / sqrt(var + eps)
+
+    Returns:
+        tuple: (folded weights [out][in][kh][kw], folded bias [out]) as float32 numpy arrays
+    """
+    weight = conv.weight.detach().double()
+    bias = conv.bias.detach().double() if conv.bias is not None else torch.zeros(weight.shape[0], dtype=torch.float64)
+
+    scale = bn.weight.detach().double() / torch.sqrt(bn.running_var.detach().double() + bn.eps)
+    folded_weight = weight * scale.view(-1, 1, 1, 1)
+    folded_bias = (bias - bn.running_mean.detach().double()) * scale + bn.bias.detach().double()
+
+    return folded_weight.float().numpy(), folded_bias.float().numpy()
+
+
+def _plain(layer) -> tuple[np.ndarray, np.ndarray]:
+    """Weights and bias of a conv/linear layer that has no BatchNorm after it."""
+    return layer.weight.detach().float().numpy(), layer.bias.detach().float().numpy()
+
+
+def collect_tensors(model: HyperionNN) -> list[np.ndarray]:
+    """
+    Returns the (folded) tensors of the model in the order the C++ engine expects them.
+    """
+    tensors = []
+
+    def add(pair):
+        tensors.extend(pair)
+
+    add(fold_batchnorm(model.entry_block[0], model.entry_block[1]))
+    for block in model.residual_:
+        add(fold_batchnorm(block.conv1, block.bn1))
+        add(fold_batchnorm(block.conv2, block.bn2))
+
+    add(_plain(model.policy_head[0]))   # 1x1 conv (the policy head has no batch norm)
+    add(_plain(model.policy_head[3]))   # linear 128 -> policy size
+
+    add(fold_batchnorm(model.value_head[0], model.value_head[1]))
+    add(_plain(model.value_head[4]))    # linear 64 -> 256
+    add(_plain(model.value_head[6]))    # linear 256 -> 1
+
+    return tensors
+
+
+def build_header(body_floats: int, flags: int = 0) -> bytes:
+    """Packs the 64 byte file header (shape values come from ModelConfig)."""
+    header = struct.pack(HEADER_FORMAT,
+                         WEIGHT_FILE_MAGIC,
+                         WEIGHT_FILE_VERSION,
+                         HEADER_SIZE,
+                         config.ModelConfig.NUM_RESIDUAL_BLOCKS,
+                         config.ModelConfig.NUM_FILTERS,
+                         config.ModelConfig.NUM_INPUT_PLANES,
+                         config.ModelConfig.POLICY_HEAD_SIZE,
+                         HEADER_SIZE,      # the body starts right after the header
+                         body_floats,
+                         flags)
+    return header + b"\x00" * (HEADER_SIZE - HEADER_FORMAT_SIZE)
+
+
+def _append_padded(body: bytearray, tensor) -> None:
+    flat = np.ascontiguousarray(tensor, dtype="<f4").ravel()
+    padding = (-flat.size) % ALIGN_FLOATS
+    body += flat.tobytes()
+    body += b"\x00" * (padding * 4)
+
+
+def write_weight_file(model: HyperionNN, output_path: str, activation_ranges=None) -> int:
+    """
+    Writes the model into the binary weight file format.
+
+    Args:
+        activation_ranges: optional INT8 calibration (1 + 2 * NUM_RESIDUAL_BLOCKS floats, see calibrate_int8.py)
+
+    Returns:
+        int: the number of bytes written
+    """
+    model.eval()
+    tensors = collect_tensors(model)
+
+    body = bytearray()
+    for tensor in tensors:
+        _append_padded(body, tensor)
+    body_floats = len(body) // 4
+
+    flags = 0
+    if activation_ranges is not None:
+        expected = 1 + 2 * config.ModelConfig.NUM_RESIDUAL_BLOCKS
+        if len(activation_ranges) != expected:
+            raise ValueError(f"Expected {expected} activation ranges, got {len(activation_ranges)}")
+        _append_padded(body, np.asarray(activation_ranges, dtype=np.float32))
+        flags |= FLAG_HAS_ACTIVATION_RANGES
+
+    header = build_header(body_floats, flags)
+    with open(output_path, "wb") as f:
+        f.write(header)
+        f.write(body)
+
+    return len(header) + len(body)
+
+
+def load_model_from_checkpoint(checkpoint_path: str) -> HyperionNN:
+    """Loads a training checkpoint (as saved by train.py) into a HyperionNN built from ModelConfig."""
+    checkpoint = torch.load(checkpoint_path, map_location="cpu", weights_only=True)
+    state_dict = checkpoint.get("model_state_dict", checkpoint)
+    # checkpoints saved from a torch.compile()'d model prefix every key with "_orig_mod."
+    state_dict = {key.replace("_orig_mod.", "", 1): value for key, value in state_dict.items()}
+
+    model = HyperionNN()
+    model.load_state_dict(state_dict)  # strict, so a ModelConfig/checkpoint mismatch fails loudly here
+    model.eval()
+    return model
+
+
+def _latest_checkpoint() -> str | None:
+    checkpoints = glob.glob(os.path.join(config.PathsConfig.CHECKPOINT_DIR, "checkpoint_step_*.pt"))
+    return max(checkpoints, key=os.path.getctime) if checkpoints else None
+
+
+def main():
+    logging.basicConfig(level=logging.INFO, format="[%(levelname)-8s] %(message)s")
+    parser = argparse.ArgumentParser(description="Export a HyperionNN checkpoint to the C++ engine weight format.")
+    parser.add_argument("--checkpoint", type=str, default=None, help="checkpoint to export (default: newest in CHECKPOINT_DIR)")
+    parser.add_argument("--output", type=str, default=None, help="output .hnn file (default: MODELS_DIR/hyperion_<B>b_<F>f.hnn)")
+    args = parser.parse_args()
+
+    checkpoint_path = args.checkpoint or _latest_checkpoint()
+    if checkpoint_path is None:
+        raise FileNotFoundError(f"No checkpoint given and none found in {config.PathsConfig.CHECKPOINT_DIR}")
+
+    output_path = args.output or os.path.join(
+        config.PathsConfig.MODELS_DIR,
+        f"hyperion_{config.ModelConfig.NUM_RESIDUAL_BLOCKS}b_{config.ModelConfig.NUM_FILTERS}f.hnn")
+    os.makedirs(os.path.dirname(os.path.abspath(output_path)), exist_ok=True)
+
+    logger.info(f"Loading checkpoint {checkpoint_path}...")
+    model = load_model_from_checkpoint(checkpoint_path)
+    size = write_weight_file(model, output_path)
+    logger.info(f"Wrote {size / (1024 * 1024):.1f} MB of weights to {output_path}")
+
+
+if __name__ == "__main__":
+    main()
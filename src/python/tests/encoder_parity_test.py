@@ -0,0 +1,60 @@
+import os
+import pathlib
+import subprocess
+
+import numpy as np
+import pytest
+
+import hyperion_nn.data_utils.fen_parser as fp
+
+# the C++ encoder (src/cpp/nn_inference/encoder.cpp) has to give the network exactly the same input as
+# fen_parser, so this compares the bytes of both for a handful of positions
+# needs the TestEncoder executable, set HYPERION_TEST_ENCODER to its path if it isn't in one of the build folders
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parents[3]
+
+
+def find_test_encoder():
+    candidates = []
+    if os.environ.get("HYPERION_TEST_ENCODER"):
+        candidates.append(pathlib.Path(os.environ["HYPERION_TEST_ENCODER"]))
+    for build_dir in ("build", "_gate_build"):
+        candidates.append(REPO_ROOT / build_dir / "bin" / "TestEncoder")
+        candidates.append(REPO_ROOT / build_dir / "bin" / "TestEncoder.exe")
+    for path in candidates:
+        if path.is_file():
+            return path
+    return None
+
+
+TEST_ENCODER = find_test_encoder()
+
+PARITY_FENS = [
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq e6 0 2",
+    "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/8/8/8/8/8/8/R3K2R b Kq - 33 71",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 99 150",
+    "8/8/8/8/8/8/6k1/4K2R w K - 100 200",
+    "4k3/8/8/8/8/8/8/4K3 b - - 250 400",
+]
+
+
+# ! --- Pytest Test Functions ---
+
+@pytest.mark.skipif(TEST_ENCODER is None, reason="TestEncoder has not been built")
+@pytest.mark.parametrize("fen", PARITY_FENS)
+def test_cpp_encoder_matches_fen_parser(fen):
+    """The C++ planes must be byte for byte the float32 planes of fen_to_nn_input."""
+    result = subprocess.run([str(TEST_ENCODER), "--dump", fen], capture_output=True, text=True, check=True)
+    cpp_bytes = bytes.fromhex(result.stdout.strip())
+
+    expected = fp.fen_to_nn_input(fen)
+    assert expected.dtype == np.float32
+    assert len(cpp_bytes) == expected.nbytes
+
+    if cpp_bytes != expected.tobytes():
+        cpp_planes = np.frombuffer(cpp_bytes, dtype=np.float32).reshape(expected.shape)
+        differing = sorted(set(np.argwhere(cpp_planes != expected)[:, 0].tolist()))
+        pytest.fail(f"C++ encoder differs from fen_parser on planes {differing} for {fen}")
@@ -0,0 +1,100 @@
+import struct
+
+import numpy as np
+import pytest
+import torch
+
+import hyperion_nn.config as config
+import hyperion_nn.training.export_weights as ew
+from hyperion_nn.models.resnet_cnn import HyperionNN
+
+
+def randomize_batchnorm(model):
+    """Gives every BatchNorm non trivial running stats, so folding actually has something to do."""
+    torch.manual_seed(0)
+    for module in model.modules():
+        if isinstance(module, torch.nn.BatchNorm2d):
+            module.running_mean.uniform_(-0.5, 0.5)
+            module.running_var.uniform_(0.5, 2.0)
+            module.weight.data.uniform_(0.5, 1.5)
+            module.bias.data.uniform_(-0.2, 0.2)
+    model.eval()
+
+
+# ! --- Pytest Test Functions ---
+
+def test_fold_batchnorm_matches_conv_plus_bn():
+    """conv -> bn in eval mode must give the same output as the folded conv."""
+    torch.manual_seed(1)
+    conv = torch.nn.Conv2d(4, 6, kernel_size=3, padding="same")
+    bn = torch.nn.BatchNorm2d(6)
+    bn.running_mean.uniform_(-1, 1)
+    bn.running_var.uniform_(0.5, 2.0)
+    bn.eval()
+
+    x = torch.randn(2, 4, 8, 8)
+    expected = bn(conv(x))
+
+    weight, bias = ew.fold_batchnorm(conv, bn)
+    folded = torch.nn.functional.conv2d(x, torch.from_numpy(weight), torch.from_numpy(bias), padding=1)
+
+    assert torch.allclose(expected, folded, atol=1e-5)
+
+
+def test_tensor_order_and_count():
+    """Two tensors (weights, bias) per layer: entry, 2 per block, 2 policy layers, 3 value layers."""
+    model = HyperionNN()
+    randomize_batchnorm(model)
+    tensors = ew.collect_tensors(model)
+
+    assert len(tensors) == 2 * (1 + 2 * config.ModelConfig.NUM_RESIDUAL_BLOCKS + 2 + 3)
+    assert tensors[0].shape == (config.ModelConfig.NUM_FILTERS, config.ModelConfig.NUM_INPUT_PLANES, 3, 3)
+    assert tensors[-2].shape == (1, 256)  # value linear 2
+
+
+def test_written_file_header_and_size(tmp_path):
+    model = HyperionNN()
+    randomize_batchnorm(model)
+    output_path = tmp_path / "weights.hnn"
+    size = ew.write_weight_file(model, str(output_path))
+
+    data = output_path.read_bytes()
+    assert len(data) == size
+    assert len(data) % 64 == 0
+
+    fields = struct.unpack_from(ew.HEADER_FORMAT, data)
+    magic, version, header_size, blocks, filters, planes, policy, body_offset, body_floats, flags = fields
+    assert magic == ew.WEIGHT_FILE_MAGIC
+    assert version == ew.WEIGHT_FILE_VERSION
+    assert header_size == ew.HEADER_SIZE == body_offset
+    assert (blocks, filters, planes, policy) == (config.ModelConfig.NUM_RESIDUAL_BLOCKS,
+                                                 config.ModelConfig.NUM_FILTERS,
+                                                 config.ModelConfig.NUM_INPUT_PLANES,
+                                                 config.ModelConfig.POLICY_HEAD_SIZE)
+    assert body_offset + body_floats * 4 == len(data)
+    assert flags == 0
+
+    # the first tensor is the folded entry conv
+    expected_entry, _ = ew.fold_batchnorm(model.entry_block[0], model.entry_block[1])
+    entry = np.frombuffer(data, dtype="<f4", count=expected_entry.size, offset=body_offset)
+    assert np.array_equal(entry, expected_entry.ravel())
+
+
+def test_activation_ranges_section(tmp_path):
+    """The INT8 calibration goes right after the body and sets its header flag."""
+    model = HyperionNN()
+    randomize_batchnorm(model)
+    ranges = [float(i + 1) for i in range(1 + 2 * config.ModelConfig.NUM_RESIDUAL_BLOCKS)]
+    output_path = tmp_path / "weights_int8.hnn"
+    ew.write_weight_file(model, str(output_path), activation_ranges=ranges)
+
+    data = output_path.read_bytes()
+    fields = struct.unpack_from(ew.HEADER_FORMAT, data)
+    body_offset, body_floats, flags = fields[7], fields[8], fields[9]
+    assert flags & ew.FLAG_HAS_ACTIVATION_RANGES
+
+    stored = np.frombuffer(data, dtype="<f4", count=len(ranges), offset=body_offset + body_floats * 4)
+    assert np.array_equal(stored, np.asarray(ranges, dtype=np.float32))
+
+    with pytest.raises(ValueError):
+        ew.write_weight_file(model, str(output_path), activation_ranges=ranges[:-1])
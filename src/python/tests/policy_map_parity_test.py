@@ -0,0 +1,55 @@
+import os
+import pathlib
+import subprocess
+
+import pytest
+
+import hyperion_nn.data_utils.move_encoder as me
+
+# the C++ policy map (src/cpp/nn_inference/policy_map.hpp) has to read the network's policy output the same way
+# move_encoder wrote the training targets, so this compares both for every legal move of a few positions
+# needs the TestPolicyMap executable, set HYPERION_TEST_POLICY_MAP to its path if it isn't in one of the build folders
+
+REPO_ROOT = pathlib.Path(__file__).resolve().parents[3]
+
+
+def find_test_policy_map():
+    candidates = []
+    if os.environ.get("HYPERION_TEST_POLICY_MAP"):
+        candidates.append(pathlib.Path(os.environ["HYPERION_TEST_POLICY_MAP"]))
+    for build_dir in ("build", "_gate_build"):
+        candidates.append(REPO_ROOT / build_dir / "bin" / "TestPolicyMap")
+        candidates.append(REPO_ROOT / build_dir / "bin" / "TestPolicyMap.exe")
+    for path in candidates:
+        if path.is_file():
+            return path
+    return None
+
+
+TEST_POLICY_MAP = find_test_policy_map()
+
+PARITY_FENS = [
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N w - - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    "7Q/8/8/3q4/8/8/8/k1K5 b - - 0 1",
+]
+
+
+# ! --- Pytest Test Functions ---
+
+@pytest.mark.skipif(TEST_POLICY_MAP is None, reason="TestPolicyMap has not been built")
+@pytest.mark.parametrize("fen", PARITY_FENS)
+def test_cpp_policy_index_matches_move_encoder(fen):
+    """Every legal move must get the same policy index in C++ as from uci_to_policy_index."""
+    result = subprocess.run([str(TEST_POLICY_MAP), "--dump", fen], capture_output=True, text=True, check=True)
+    lines = result.stdout.split()
+    assert len(lines) % 3 == 0 and lines, f"unexpected output for {fen}"
+
+    is_white_turn = fen.split(" ")[1] == "w"
+    for uci, piece, cpp_index in zip(lines[0::3], lines[1::3], lines[2::3]):
+        expected = me.uci_to_policy_index(uci, piece, is_white_turn)
+        assert int(cpp_index) == expected, f"{uci} in {fen}: C++ gives {cpp_index}, move_encoder gives {expected}"